@@ -0,0 +1,174 @@
+/* atdump.c
+ *
+ * This program reads an address trace, made by "nachos -at <file>"
+ * (see atrace.h), and writes it out as text, one reference a line:
+ *
+ *	the default is "<kind> <space> <address> <size>", where the kind
+ *	is I for an instruction fetch, R for a load, and W for a store
+ *
+ *	with -d, it is "<label> <address>", with the labels (0 read, 1
+ *	write, 2 instruction fetch) of the "din" format that the Dinero
+ *	cache simulator, and many others, take as input
+ *
+ *	with -s, only a summary is printed: how many references of each
+ *	kind, how many address spaces, and how many distinct instruction
+ *	and data words and pages were touched
+ *
+ * With -n, it stops after that many references.
+ *
+ * Usage: atdump [-d | -s] [-n <references>] <trace file>
+ *
+ * Copyright (c) 1992-1993 The Regents of the University of California.
+ * All rights reserved.  See copyright.h for copyright notice and limitation
+ * of liability and disclaimer of warranty provisions.
+ */
+
+#define MAIN
+#include "copyright.h"
+#undef MAIN
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "atread.h"
+
+#define SummaryPageSize	128	/* PageSize in ../machine/machine.h */
+#define MaxSpaces	256	/* address space numbers kept in the summary */
+#define MaxTracked	(1 << 20)	/* words tracked in the summary,
+					 * per address space and kind */
+
+/* Distinct -- a set of word numbers, as a bitmap grown as needed */
+
+typedef struct distinct {
+    unsigned char *bits;
+    int size;			/* words it covers */
+    int count;			/* of them, set */
+} Distinct;
+
+/* Mark -- add "word" to "set" */
+
+static void
+Mark(Distinct *set, unsigned int word)
+{
+    int newSize;
+
+    if (word >= MaxTracked)
+	return;
+    if ((int) word >= set->size) {
+	newSize = (set->size > 0) ? set->size : 1024;
+	while (newSize <= (int) word)
+	    newSize *= 2;
+	set->bits = (unsigned char *) realloc(set->bits, newSize / 8);
+	if (set->bits == NULL) {
+	    fprintf(stderr, "Out of memory\n");
+	    exit(1);
+	}
+	memset(set->bits + set->size / 8, 0, (newSize - set->size) / 8);
+	set->size = newSize;
+    }
+    if (!(set->bits[word / 8] & (1 << (word % 8)))) {
+	set->bits[word / 8] |= 1 << (word % 8);
+	set->count++;
+    }
+}
+
+/* CountPages -- how many pages hold at least one word in "set" */
+
+static int
+CountPages(Distinct *set)
+{
+    int wordsPerPage = SummaryPageSize / 4, pages = 0, i, j;
+
+    for (i = 0; i < set->size; i += wordsPerPage)
+	for (j = i; (j < i + wordsPerPage) && (j < set->size); j++)
+	    if (set->bits[j / 8] & (1 << (j % 8))) {
+		pages++;
+		break;
+	    }
+    return pages;
+}
+
+/* Summarize -- print the summary of (up to "max" references of) a trace */
+
+static void
+Summarize(ATReader *reader, int max)
+{
+    static Distinct code[MaxSpaces], data[MaxSpaces];
+    int numKind[3], spaceSeen[MaxSpaces], numSpaces = 0;
+    int codeWords = 0, dataWords = 0, codePages = 0, dataPages = 0;
+    int numRefs, first = -1, last = 0, s;
+    ATRef ref;
+
+    memset(numKind, 0, sizeof(numKind));
+    memset(spaceSeen, 0, sizeof(spaceSeen));
+    for (numRefs = 0; ((max < 0) || (numRefs < max)) && ATNext(reader, &ref);
+								numRefs++) {
+	s = ref.space % MaxSpaces;
+	if (!spaceSeen[s]) {
+	    spaceSeen[s] = 1;
+	    numSpaces++;
+	}
+	numKind[ref.kind]++;
+	if (ref.kind == AT_FETCH)
+	    Mark(&code[s], (unsigned) ref.addr / 4);
+	else
+	    Mark(&data[s], (unsigned) ref.addr / 4);
+	if (first < 0)
+	    first = ref.when;
+	last = ref.when;
+    }
+    for (s = 0; s < MaxSpaces; s++) {
+	codeWords += code[s].count;
+	dataWords += data[s].count;
+	codePages += CountPages(&code[s]);
+	dataPages += CountPages(&data[s]);
+    }
+    printf("%d references: %d fetches, %d loads, %d stores\n", numRefs,
+	numKind[AT_FETCH], numKind[AT_LOAD], numKind[AT_STORE]);
+    printf("%d address spaces, %d chunks, ticks %d to %d\n", numSpaces,
+	reader->numChunks, (first < 0) ? 0 : first, last);
+    printf("distinct words: %d code, %d data; pages (%d bytes): "
+	"%d code, %d data\n", codeWords, dataWords, SummaryPageSize,
+	codePages, dataPages);
+}
+
+int
+main(int argc, char **argv)
+{
+    ATReader reader;
+    ATRef ref;
+    int din = 0, summary = 0, max = -1, n;
+    static char kindChar[] = "IRW";
+    static int dinLabel[] = { 2, 0, 1 };
+
+    for (argc--, argv++; (argc > 1) && (argv[0][0] == '-'); argc--, argv++)
+	if (!strcmp(argv[0], "-d"))
+	    din = 1;
+	else if (!strcmp(argv[0], "-s"))
+	    summary = 1;
+	else if (!strcmp(argv[0], "-n") && (argc > 2)) {
+	    max = atoi(argv[1]);
+	    argc--, argv++;
+	} else
+	    break;
+    if ((argc != 1) || (din && summary)) {
+	fprintf(stderr, "Usage: atdump [-d | -s] [-n <references>] "
+	    "<trace file>\n");
+	exit(1);
+    }
+    if (ATOpen(&reader, argv[0]) != 0)
+	exit(1);
+
+    if (summary)
+	Summarize(&reader, max);
+    else
+	for (n = 0; ((max < 0) || (n < max)) && ATNext(&reader, &ref); n++)
+	    if (din)
+		printf("%d %x\n", dinLabel[ref.kind], ref.addr);
+	    else
+		printf("%c %d 0x%08x %d\n", kindChar[ref.kind], ref.space,
+		    ref.addr, ref.size);
+    ATClose(&reader);
+    exit(0);
+}
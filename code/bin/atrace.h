@@ -0,0 +1,60 @@
+/* atrace.h
+ *     Data structures defining the format of an address trace, as
+ *     written by "nachos -at <file>" (see ../machine/addrtrace.h) and
+ *     read back by the routines in atread.c.
+ *
+ *     A trace is a header followed by chunks.  Each chunk is an
+ *     ATraceChunk followed by "size" bytes holding "count" records,
+ *     one per reference to user memory, in the order they were made.
+ *     A record is a number in the variable-length form below, whose
+ *     low two bits say what kind of reference it is:
+ *
+ *	AT_FETCH: the rest is how far the PC is from just after the last
+ *	instruction fetched, so straight-line code takes one byte a fetch
+ *
+ *	AT_LOAD, AT_STORE: the next two bits are log2 of the size (1, 2
+ *	or 4 bytes), and the rest is how far the address is from the
+ *	last load or store
+ *
+ *	AT_SPACE: the rest is the number of the address space making the
+ *	references that follow (see AddrSpace::Id)
+ *
+ *     Distances are signed, and folded into unsigned numbers by
+ *     ATZIGZAG (0, -1, 1, -2, ... become 0, 1, 2, 3, ...).  A number is
+ *     written 7 bits at a time, low bits first, with the top bit of
+ *     each byte set if more follow.
+ *
+ *     Every chunk starts from scratch -- as if the last PC were -4, the
+ *     last load or store were at 0, and with an AT_SPACE record first
+ *     -- so a chunk can be decoded without the ones before it.  Words
+ *     in the header and chunk headers are in the byte order of the host
+ *     that made the trace.
+ */
+
+#define ATRACEMAGIC	0xadd7ace	/* magic number denoting a Nachos
+					 * address trace
+					 */
+
+#define ATChunkSize	65536		/* most bytes of records in a chunk */
+
+/* kinds of record */
+#define AT_FETCH	0
+#define AT_LOAD		1
+#define AT_STORE	2
+#define AT_SPACE	3
+
+#define ATZIGZAG(d)	((((unsigned) (d)) << 1) ^ (unsigned) ((d) < 0 ? -1 : 0))
+#define ATUNZIGZAG(u)	((int) (((u) >> 1) ^ -(int) ((u) & 1)))
+
+#define ATMaxRecord	6		/* most bytes one record takes */
+
+typedef struct aTraceHeader {
+   int magic;			/* should be ATRACEMAGIC */
+   int chunkSize;		/* most bytes of records in a chunk */
+} ATraceHeader;
+
+typedef struct aTraceChunk {
+   int size;			/* bytes of records that follow */
+   int count;			/* records in them */
+   int when;			/* simulated time of the first */
+} ATraceChunk;
@@ -0,0 +1,130 @@
+/* atread.c
+ *
+ * Routines to read back an address trace, made by "nachos -at <file>".
+ * See atread.h for how to use them, and atrace.h for the format.
+ *
+ * Copyright (c) 1992-1993 The Regents of the University of California.
+ * All rights reserved.  See copyright.h for copyright notice and limitation
+ * of liability and disclaimer of warranty provisions.
+ */
+
+#include <stdlib.h>
+
+#include "atread.h"
+
+/* ATOpen -- open a trace, and check its header */
+
+int
+ATOpen(ATReader *reader, char *fileName)
+{
+    ATraceHeader header;
+
+    reader->name = fileName;
+    reader->chunk = NULL;
+    reader->file = fopen(fileName, "rb");
+    if (reader->file == NULL) {
+	perror(fileName);
+	return -1;
+    }
+    if ((fread((char *) &header, sizeof(header), 1, reader->file) != 1)
+	    || (header.magic != ATRACEMAGIC) || (header.chunkSize <= 0)) {
+	fprintf(stderr, "%s: not a Nachos address trace\n", fileName);
+	fclose(reader->file);
+	return -1;
+    }
+    reader->chunk = (unsigned char *) malloc(header.chunkSize);
+    if (reader->chunk == NULL) {
+	fprintf(stderr, "Out of memory\n");
+	fclose(reader->file);
+	return -1;
+    }
+    reader->chunkSize = header.chunkSize;
+    reader->size = reader->pos = reader->left = 0;
+    reader->numChunks = 0;
+    return 0;
+}
+
+/* NextChunk -- read in the next chunk; returns 0 at the end */
+
+static int
+NextChunk(ATReader *reader)
+{
+    ATraceChunk header;
+
+    do {
+	if (fread((char *) &header, sizeof(header), 1, reader->file) != 1)
+	    return 0;
+	if ((header.size < 0) || (header.size > reader->chunkSize)
+		|| (header.count < 0) || (fread((char *) reader->chunk, 1,
+			    header.size, reader->file) != (size_t) header.size)) {
+	    fprintf(stderr, "%s: chunk %d is damaged; stopping there\n",
+		reader->name, reader->numChunks);
+	    return 0;
+	}
+	reader->numChunks++;
+    } while (header.count == 0);
+    reader->size = header.size;
+    reader->pos = 0;
+    reader->left = header.count;
+    reader->when = header.when;
+    reader->space = 0;
+    reader->lastPC = -4;
+    reader->lastData = 0;
+    return 1;
+}
+
+/* ATNext -- decode the next fetch, load or store */
+
+int
+ATNext(ATReader *reader, ATRef *ref)
+{
+    unsigned long long value;
+    int shift, kind;
+
+    for (;;) {
+	if ((reader->left == 0) && !NextChunk(reader))
+	    return 0;
+	value = 0;
+	shift = 0;
+	do {
+	    if ((reader->pos >= reader->size) || (shift > 63)) {
+		fprintf(stderr, "%s: chunk %d is damaged; stopping there\n",
+		    reader->name, reader->numChunks - 1);
+		reader->left = 0;
+		return 0;
+	    }
+	    value |= (unsigned long long) (reader->chunk[reader->pos] & 0x7f)
+								<< shift;
+	    shift += 7;
+	} while (reader->chunk[reader->pos++] & 0x80);
+	reader->left--;
+
+	kind = value & 0x3;
+	if (kind == AT_SPACE) {
+	    reader->space = (int) (value >> 2);
+	    continue;
+	}
+	ref->kind = kind;
+	ref->space = reader->space;
+	ref->when = reader->when;
+	if (kind == AT_FETCH) {
+	    ref->addr = reader->lastPC + 4 + ATUNZIGZAG((unsigned) (value >> 2));
+	    ref->size = 4;
+	    reader->lastPC = ref->addr;
+	} else {
+	    ref->addr = reader->lastData + ATUNZIGZAG((unsigned) (value >> 4));
+	    ref->size = 1 << ((value >> 2) & 0x3);
+	    reader->lastData = ref->addr;
+	}
+	return 1;
+    }
+}
+
+/* ATClose -- done with the trace */
+
+void
+ATClose(ATReader *reader)
+{
+    fclose(reader->file);
+    free(reader->chunk);
+}
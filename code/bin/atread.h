@@ -0,0 +1,49 @@
+/* atread.h
+ *     Routines to read back an address trace made by "nachos -at <file>"
+ *     (see atrace.h), one reference at a time, without holding more
+ *     than one chunk of it in memory.
+ *
+ *     For example:
+ *
+ *	ATReader reader;
+ *	ATRef ref;
+ *
+ *	if (ATOpen(&reader, "trace") != 0)
+ *	    ... complain ...
+ *	while (ATNext(&reader, &ref))
+ *	    ... use ref.kind, ref.addr, ref.size, ref.space ...
+ *	ATClose(&reader);
+ */
+
+#include <stdio.h>
+
+#include "atrace.h"
+
+typedef struct aTRef {
+   int kind;			/* AT_FETCH, AT_LOAD or AT_STORE */
+   int addr;			/* virtual address */
+   int size;			/* bytes: 4 for a fetch */
+   int space;			/* number of the address space */
+   int when;			/* simulated time of the start of its chunk */
+} ATRef;
+
+typedef struct aTReader {
+   FILE *file;
+   char *name;			/* for messages */
+   unsigned char *chunk;	/* the chunk being read */
+   int chunkSize;		/* room in it */
+   int size;			/* bytes in it */
+   int pos;			/* next byte to decode */
+   int left;			/* records in it not yet decoded */
+   int when;			/* its time */
+   int space, lastPC, lastData;	/* decoding state */
+   int numChunks;		/* chunks read so far */
+} ATReader;
+
+/* open "fileName"; returns 0, or -1 (after saying why) if it's no good */
+extern int ATOpen(ATReader *reader, char *fileName);
+
+/* decode the next reference; returns 0 at the end of the trace */
+extern int ATNext(ATReader *reader, ATRef *ref);
+
+extern void ATClose(ATReader *reader);
@@ -47,3 +47,52 @@ struct scnhdr {
         long            s_flags;        /* flags */
       };
  
+
+/* The symbolic header, at f_symptr, and the external symbols it points
+ * to; we only use the externals, to make a NOFF symbol table.
+ */
+
+typedef struct {
+        short   magic;          /* to verify validity of the table      */
+        short   vstamp;         /* version stamp                        */
+        long    ilineMax;       /* number of line number entries        */
+        long    cbLine;         /* number of bytes for line number entries */
+        long    cbLineOffset;   /* offset to start of line number entries */
+        long    idnMax;         /* max index into dense number table    */
+        long    cbDnOffset;     /* offset to start dense number table   */
+        long    ipdMax;         /* number of procedures                 */
+        long    cbPdOffset;     /* offset to procedure descriptor table */
+        long    isymMax;        /* number of local symbols              */
+        long    cbSymOffset;    /* offset to start of local symbols     */
+        long    ioptMax;        /* max index into optimization entries  */
+        long    cbOptOffset;    /* offset to optimization table         */
+        long    iauxMax;        /* number of auxiliary symbols          */
+        long    cbAuxOffset;    /* offset to the auxiliary symbols      */
+        long    issMax;         /* max index into local strings         */
+        long    cbSsOffset;     /* offset to local strings              */
+        long    issExtMax;      /* max index into external strings      */
+        long    cbSsExtOffset;  /* offset to external strings           */
+        long    ifdMax;         /* number of file descriptors           */
+        long    cbFdOffset;     /* offset to file descriptor table      */
+        long    crfd;           /* number of relative file descriptors  */
+        long    cbRfdOffset;    /* offset to relative file descriptors  */
+        long    iextMax;        /* max index into external symbols      */
+        long    cbExtOffset;    /* offset to start of external symbols  */
+      } HDRR;
+
+#define magicSym        0x7009
+
+typedef struct {
+        unsigned short  flags;  /* jmptbl, cobol_main, weakext          */
+        short   ifd;            /* where the iss and index fields point */
+        long    iss;            /* index into external strings          */
+        long    value;          /* value of the symbol                  */
+        unsigned long   bits;   /* symbol type (low 6 bits), storage
+                                 * class (next 5), and index            */
+      } EXTR;
+
+#define EXTR_SC(e)      (((e).bits >> 6) & 0x1f)
+
+#define scNil           0
+#define scText          1       /* text symbol                          */
+#define scUndefined     6       /* who knows?                           */
@@ -15,6 +15,14 @@
  *	.data	-- initialized data
  *	.bss/.sbss -- uninitialized data (should be zero'd on program startup)
  *
+ * Each segment is written at the same offset within a page of the NOFF
+ * file as it has within a page of memory, with its flags (read-only,
+ * executable, zero-filled) in the header, so that the kernel can load
+ * it a page at a time, and map code read-only (see noff.h).  For the
+ * code to get pages of its own, the data has to start on a new page,
+ * which ../test/script sees to.  With -s, the external symbols are
+ * copied into a symbol table at the end of the NOFF file.
+ *
  * Copyright (c) 1992-1993 The Regents of the University of California.
  * All rights reserved.  See copyright.h for copyright notice and limitation 
  * of liability and disclaimer of warranty provisions.
@@ -29,6 +37,7 @@
 #include <fcntl.h>
 #include <limits.h>
 #include <stdio.h>
+#include <string.h>
 
 #include "coff.h"
 #include "noff.h"
@@ -65,6 +74,7 @@ ShortToHost(unsigned short shortword) {
 }
 
 #define ReadStruct(f,s) 	Read(f,(char *)&s,sizeof(s))
+#define divRoundUp(n,s)		(((n) / (s)) + ((((n) % (s)) > 0) ? 1 : 0))
 
 extern char *malloc();
 char *noffFileName = NULL;
@@ -89,17 +99,144 @@ void Write(int fd, char *buf, int nBytes)
     }
 }
 
+/* Where each segment is in the COFF file, while we lay out the NOFF file */
+
+typedef struct {
+    int virtualAddr, size, inCoffAddr, flags;
+} CoffSegment;
+
+/* Zero "nBytes" of the NOFF file, from the current offset */
+void Zero(int fd, int nBytes)
+{
+    char zeros[NoffPageSize];
+
+    memset(zeros, 0, sizeof(zeros));
+    while (nBytes > 0) {
+	Write(fd, zeros, (nBytes < NoffPageSize) ? nBytes : NoffPageSize);
+	nBytes -= NoffPageSize;
+    }
+}
+
+/* Copy a segment from the COFF file into the NOFF file, at the same
+ * offset within a page as it will have in memory.  If it starts in
+ * the page the previous segment ended in, it goes into that page of
+ * the file too.  Either way, the rest of its last page is zeroed
+ * (the next segment may overwrite some of it).
+ */
+void CopySegment(int fdIn, int fdOut, CoffSegment *from, Segment *to,
+	Segment *previous, int *inNoffFile)
+{
+    char *buffer;
+    int end;
+
+    to->virtualAddr = from->virtualAddr;
+    to->size = from->size;
+    if ((previous != NULL) && (previous->size > 0) && (from->virtualAddr
+		/ NoffPageSize == (previous->virtualAddr + previous->size - 1)
+		/ NoffPageSize))
+	to->inFileAddr = previous->inFileAddr + from->virtualAddr
+	    - previous->virtualAddr;
+    else
+	to->inFileAddr = divRoundUp(*inNoffFile, NoffPageSize) * NoffPageSize
+	    + from->virtualAddr % NoffPageSize;
+    if (from->flags & NOFF_ZERO)
+	return;
+    lseek(fdIn, from->inCoffAddr, 0);
+    buffer = malloc(from->size);
+    Read(fdIn, buffer, from->size);
+    lseek(fdOut, to->inFileAddr, 0);
+    Write(fdOut, buffer, from->size);
+    free(buffer);
+    end = to->inFileAddr + to->size;
+    Zero(fdOut, divRoundUp(end, NoffPageSize) * NoffPageSize - end);
+    *inNoffFile = divRoundUp(end, NoffPageSize) * NoffPageSize;
+}
+
+/* Make a NOFF symbol table from the COFF file's external symbols, and
+ * put it at the end of the NOFF file.
+ */
+void CopySymbols(int fdIn, int fdOut, struct filehdr *fileh, Segment *symbols,
+	int inNoffFile)
+{
+    HDRR symh;
+    EXTR *ext;
+    NoffSymbol *sym;
+    char *strings, *names;
+    int i, numSyms, nameSize, sc;
+
+    symbols->virtualAddr = 0;
+    symbols->inFileAddr = inNoffFile;
+    symbols->size = 0;
+    if (fileh->f_symptr == 0) {
+	fprintf(stderr, "No symbol table\n");
+	return;
+    }
+    lseek(fdIn, WordToHost(fileh->f_symptr), 0);
+    ReadStruct(fdIn, symh);
+    symh.magic = ShortToHost(symh.magic);
+    symh.issExtMax = WordToHost(symh.issExtMax);
+    symh.cbSsExtOffset = WordToHost(symh.cbSsExtOffset);
+    symh.iextMax = WordToHost(symh.iextMax);
+    symh.cbExtOffset = WordToHost(symh.cbExtOffset);
+    if (symh.magic != magicSym) {
+	fprintf(stderr, "Unknown symbol table format\n");
+	return;
+    }
+    ext = (EXTR *) malloc(symh.iextMax * sizeof(EXTR));
+    strings = malloc(symh.issExtMax + 1);
+    lseek(fdIn, symh.cbExtOffset, 0);
+    Read(fdIn, (char *) ext, symh.iextMax * sizeof(EXTR));
+    for (i = 0; i < symh.iextMax; i++) {
+	ext[i].iss = WordToHost(ext[i].iss);
+	ext[i].value = WordToHost(ext[i].value);
+	ext[i].bits = WordToHost(ext[i].bits);
+    }
+    lseek(fdIn, symh.cbSsExtOffset, 0);
+    Read(fdIn, strings, symh.issExtMax);
+    strings[symh.issExtMax] = '\0';
+
+    sym = (NoffSymbol *) malloc(symh.iextMax * sizeof(NoffSymbol));
+    names = malloc(symh.issExtMax + 1);
+    for (i = numSyms = nameSize = 0; i < symh.iextMax; i++) {
+	sc = EXTR_SC(ext[i]);
+	if ((sc == scNil) || (sc == scUndefined)
+			|| (ext[i].iss < 0) || (ext[i].iss >= symh.issExtMax))
+	    continue;
+	sym[numSyms].value = ext[i].value;
+	sym[numSyms].type = (sc == scText) ? NOFF_SYM_TEXT : NOFF_SYM_DATA;
+	sym[numSyms++].name = nameSize;
+	strcpy(&names[nameSize], &strings[ext[i].iss]);
+	nameSize += strlen(&strings[ext[i].iss]) + 1;
+    }
+    lseek(fdOut, inNoffFile, 0);
+    Write(fdOut, (char *) &numSyms, sizeof(int));
+    Write(fdOut, (char *) sym, numSyms * sizeof(NoffSymbol));
+    Write(fdOut, names, nameSize);
+    symbols->size = sizeof(int) + numSyms * sizeof(NoffSymbol) + nameSize;
+    printf("%d symbols\n", numSyms);
+    free(ext);
+    free(strings);
+    free(sym);
+    free(names);
+}
+
 main (int argc, char **argv)
 {
-    int fdIn, fdOut, numsections, i, inNoffFile;
+    int fdIn, fdOut, numsections, i, inNoffFile, withSymbols = 0;
     struct filehdr fileh;
     struct aouthdr systemh;
     struct scnhdr *sections;
-    char *buffer;
+    CoffSegment code, initData, uninitData;
     NoffHeader noffH;
+    NoffExtension noffX;
 
-    if (argc < 2) {
-	fprintf(stderr, "Usage: %s <coffFileName> <noffFileName>\n", argv[0]);
+    if ((argc > 1) && !strcmp(argv[1], "-s")) {
+	withSymbols = 1;
+	argc--, argv++;
+    }
+    if (argc < 3) {
+	fprintf(stderr, "Usage: %s [-s] <coffFileName> <noffFileName>\n",
+		argv[0]);
 	exit(1);
     }
     
@@ -112,7 +249,7 @@ main (int argc, char **argv)
 
 /* open the NOFF file (output) */
     fdOut = open(argv[2], O_WRONLY|O_CREAT|O_TRUNC , 0666);
-    if (fdIn == -1) {
+    if (fdOut == -1) {
 	perror(argv[2]);
 	exit(1);
     }
@@ -149,17 +286,14 @@ main (int argc, char **argv)
      sections[i].s_scnptr = WordToHost(sections[i].s_scnptr);
    }
 
- /* initialize the NOFF header, in case not all the segments are defined
-  * in the COFF file
+ /* find the segments, in case not all of them are defined in the
+  * COFF file
   */
-    noffH.noffMagic = NOFFMAGIC;
-    noffH.code.size = 0;
-    noffH.initData.size = 0;
-    noffH.uninitData.size = 0;
-
- /* Copy the segments in */
-    inNoffFile = sizeof(NoffHeader);
-    lseek(fdOut, inNoffFile, 0);
+    code.size = initData.size = uninitData.size = 0;
+    code.virtualAddr = initData.virtualAddr = uninitData.virtualAddr = 0;
+    code.flags = NOFF_READ | NOFF_EXEC;
+    initData.flags = NOFF_READ | NOFF_WRITE;
+    uninitData.flags = NOFF_READ | NOFF_WRITE | NOFF_ZERO;
     printf("Loading %d sections:\n", numsections);
     for (i = 0; i < numsections; i++) {
 	printf("\t\"%s\", filepos 0x%x, mempos 0x%x, size 0x%x\n",
@@ -168,49 +302,39 @@ main (int argc, char **argv)
 	if (sections[i].s_size == 0) {
 		/* do nothing! */	
 	} else if (!strcmp(sections[i].s_name, ".text")) {
-	    noffH.code.virtualAddr = sections[i].s_paddr;
-	    noffH.code.inFileAddr = inNoffFile;
-	    noffH.code.size = sections[i].s_size;
-    	    lseek(fdIn, sections[i].s_scnptr, 0);
-    	    buffer = malloc(sections[i].s_size);
-    	    Read(fdIn, buffer, sections[i].s_size);
-    	    Write(fdOut, buffer, sections[i].s_size);
-    	    free(buffer);
-	    inNoffFile += sections[i].s_size;
+	    code.virtualAddr = sections[i].s_paddr;
+	    code.inCoffAddr = sections[i].s_scnptr;
+	    code.size = sections[i].s_size;
  	} else if (!strcmp(sections[i].s_name, ".data")
 	  		|| !strcmp(sections[i].s_name, ".rdata")) {
   	    /* need to check if we have both .data and .rdata 
 	     *  -- make sure one or the other is empty! */ 
-	    if (noffH.initData.size != 0) {
+	    if (initData.size != 0) {
 	        fprintf(stderr, "Can't handle both data and rdata\n");
 	        unlink(noffFileName);
 	        exit(1);
 	    }
-	    noffH.initData.virtualAddr = sections[i].s_paddr;
-	    noffH.initData.inFileAddr = inNoffFile;
-	    noffH.initData.size = sections[i].s_size;
-    	    lseek(fdIn, sections[i].s_scnptr, 0);
-    	    buffer = malloc(sections[i].s_size);
-    	    Read(fdIn, buffer, sections[i].s_size);
-    	    Write(fdOut, buffer, sections[i].s_size);
-    	    free(buffer);
-	    inNoffFile += sections[i].s_size;
+	    initData.virtualAddr = sections[i].s_paddr;
+	    initData.inCoffAddr = sections[i].s_scnptr;
+	    initData.size = sections[i].s_size;
+	    if (!strcmp(sections[i].s_name, ".rdata"))
+		initData.flags = NOFF_READ;
 	} else if (!strcmp(sections[i].s_name, ".bss") ||
 			!strcmp(sections[i].s_name, ".sbss")) {
   	    /* need to check if we have both .bss and .sbss -- make sure they 
 	     * are contiguous
 	     */
-	    if (noffH.uninitData.size != 0) {
-	        if (sections[i].s_paddr == (noffH.uninitData.virtualAddr +
-	        				noffH.uninitData.size)) {
+	    if (uninitData.size != 0) {
+	        if (sections[i].s_paddr != (uninitData.virtualAddr +
+	        				uninitData.size)) {
 		    fprintf(stderr, "Can't handle both bss and sbss\n");
 		    unlink(noffFileName);
 		    exit(1);
 		}
-	        noffH.uninitData.size += sections[i].s_size;
+	        uninitData.size += sections[i].s_size;
 	    } else {
-	        noffH.uninitData.virtualAddr = sections[i].s_paddr;
-	        noffH.uninitData.size = sections[i].s_size;
+	        uninitData.virtualAddr = sections[i].s_paddr;
+	        uninitData.size = sections[i].s_size;
 	    }
 	    /* we don't need to copy the uninitialized data! */
 	} else {
@@ -219,8 +343,36 @@ main (int argc, char **argv)
 	    exit(1);
 	}
     }
+    if ((code.size > 0) && (initData.size > 0) && (initData.flags & NOFF_WRITE)
+		&& ((code.virtualAddr + code.size - 1) / NoffPageSize
+			== initData.virtualAddr / NoffPageSize))
+	printf("Code shares a page with data, which can't be read-only\n");
+
+ /* Copy the segments in, each starting on a new page of the file, unless
+  * it starts in the same page of memory as the one before
+  */
+    noffH.noffMagic = NOFFPAGEDMAGIC;
+    noffX.pageSize = NoffPageSize;
+    noffX.codeFlags = code.flags;
+    noffX.initDataFlags = initData.flags;
+    noffX.uninitDataFlags = uninitData.flags;
+    inNoffFile = sizeof(NoffHeader) + sizeof(NoffExtension);
+    CopySegment(fdIn, fdOut, &code, &noffH.code, NULL, &inNoffFile);
+    CopySegment(fdIn, fdOut, &initData, &noffH.initData, &noffH.code,
+		&inNoffFile);
+    CopySegment(fdIn, fdOut, &uninitData, &noffH.uninitData,
+		(initData.size > 0) ? &noffH.initData : &noffH.code,
+		&inNoffFile);
+    if (withSymbols)
+	CopySymbols(fdIn, fdOut, &fileh, &noffX.symbols, inNoffFile);
+    else {
+	noffX.symbols.virtualAddr = noffX.symbols.inFileAddr = 0;
+	noffX.symbols.size = 0;
+    }
+
     lseek(fdOut, 0, 0);
     Write(fdOut, (char *)&noffH, sizeof(NoffHeader));
+    Write(fdOut, (char *)&noffX, sizeof(NoffExtension));
     close(fdIn);
     close(fdOut);
     exit(0);
@@ -0,0 +1,286 @@
+/* mkdisk.c
+ *
+ * This program builds a Nachos disk image, with a freshly formatted file
+ * system holding the given UNIX files, without running Nachos -- the
+ * same image that "nachos -f" followed by "nachos -cp <file> <name>"
+ * for each of them would leave behind, but made in one write instead
+ * of thousands of simulated disk requests.
+ *
+ * Each argument is a UNIX file, or a directory whose files (in order of
+ * name, leaving out those whose names start with ".") are all copied.
+ * A file keeps its UNIX name, without the directory.  The Nachos file
+ * system has a single directory, so directories within directories are
+ * skipped, with a warning; and it is small, so a file name longer than
+ * FileNameMaxLen, a file bigger than MaxFileSize, more than NumDirEntries
+ * files, or more data than the disk holds, is an error, and no image is
+ * written.
+ *
+ * The constants and layouts here must match those in ../machine/disk.h,
+ * ../machine/disk.cc, ../filesys/filehdr.h, ../filesys/directory.h,
+ * ../filesys/freemap.h and ../filesys/filesys.cc.  Sectors are allocated just as the kernel's
+ * FileSystem::Create does, first free sector first.  Like the kernel, we
+ * write words in the byte order of this host.
+ *
+ * Usage: mkdisk [-o <disk image>] [-v] <file or directory> ...
+ *
+ * Copyright (c) 1992-1993 The Regents of the University of California.
+ * All rights reserved.  See copyright.h for copyright notice and limitation
+ * of liability and disclaimer of warranty provisions.
+ */
+
+#define MAIN
+#include "copyright.h"
+#undef MAIN
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <dirent.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+
+/* from ../machine/disk.h and disk.cc */
+#define SectorSize	128
+#define NumSectors	(32 * 32)
+#define MagicNumber	0x456789ab
+#define MagicSize	sizeof(int)
+#define DiskSize	(MagicSize + (NumSectors * SectorSize))
+
+/* from ../filesys/filehdr.h, directory.h and filesys.cc */
+#define NumDirect	((SectorSize - 2 * sizeof(int)) / sizeof(int))
+#define MaxFileSize	(NumDirect * SectorSize)
+#define FileNameMaxLen	9
+#define FreeMapSector	0
+#define DirectorySector	1
+#define FreeMapFileSize	(NumSectors / 8 + NumSectors)	/* see freemap.h */
+#define NumDirEntries	10
+#define DirectoryFileSize (sizeof(DiskDirEntry) * NumDirEntries)
+
+#define divRoundUp(n,s)	(((n) / (s)) + ((((n) % (s)) > 0) ? 1 : 0))
+
+typedef struct diskFileHeader {	/* class FileHeader */
+    int numBytes;
+    int numSectors;
+    int dataSectors[NumDirect];
+} DiskFileHeader;
+
+typedef struct diskDirEntry {	/* class DirectoryEntry */
+    char inUse;			/* a C++ bool */
+    int sector;
+    char name[FileNameMaxLen + 1];
+} DiskDirEntry;
+
+static char image[DiskSize];	/* the whole disk, magic number and all */
+static unsigned int freeMap[FreeMapFileSize / sizeof(int)];
+				/* class FreeMap: the bitmap, then counts
+				 * of sharers, all zero */
+static DiskDirEntry directory[NumDirEntries];
+static int numFiles, numBytes, verbose;
+
+#define Sector(s)	(image + MagicSize + (s) * SectorSize)
+
+static void
+Fail(char *what, char *name)
+{
+    fprintf(stderr, "mkdisk: %s: %s; no disk image written\n", name, what);
+    exit(1);
+}
+
+/* FindSector -- allocate the first free sector, as BitMap::Find does */
+
+static int
+FindSector()
+{
+    int i;
+
+    for (i = 0; i < NumSectors; i++)
+	if (!(freeMap[i / 32] & (1 << (i % 32)))) {
+	    freeMap[i / 32] |= 1 << (i % 32);
+	    return i;
+	}
+    return -1;
+}
+
+static int
+NumClear()
+{
+    int i, n = 0;
+
+    for (i = 0; i < NumSectors; i++)
+	if (!(freeMap[i / 32] & (1 << (i % 32))))
+	    n++;
+    return n;
+}
+
+/* Allocate -- FileHeader::Allocate; returns 0 if the disk is too full */
+
+static int
+Allocate(DiskFileHeader *hdr, int fileSize)
+{
+    int i;
+
+    memset((char *) hdr, 0, sizeof(DiskFileHeader));
+    hdr->numBytes = fileSize;
+    hdr->numSectors = divRoundUp(fileSize, SectorSize);
+    if (NumClear() < hdr->numSectors)
+	return 0;
+    for (i = 0; i < hdr->numSectors; i++)
+	hdr->dataSectors[i] = FindSector();
+    return 1;
+}
+
+/* WriteData -- store "size" bytes as the contents of the file "hdr" */
+
+static void
+WriteData(DiskFileHeader *hdr, char *data, int size)
+{
+    int i, n;
+
+    for (i = 0; i < hdr->numSectors; i++) {
+	n = (size - i * SectorSize < SectorSize) ? size - i * SectorSize
+						 : SectorSize;
+	memcpy(Sector(hdr->dataSectors[i]), data + i * SectorSize, n);
+    }
+}
+
+/* AddFile -- copy the UNIX file "path" in, as FileSystem::Create would */
+
+static void
+AddFile(char *path, char *name)
+{
+    static char data[MaxFileSize + 1];
+    DiskFileHeader hdr;
+    FILE *fp;
+    int size, sector, i;
+
+    if (strlen(name) > FileNameMaxLen)
+	Fail("name is too long for Nachos", path);
+    for (i = 0; i < NumDirEntries; i++)
+	if (directory[i].inUse && !strcmp(directory[i].name, name))
+	    Fail("there is already a file of that name", path);
+    if ((fp = fopen(path, "rb")) == NULL)
+	Fail("couldn't open it", path);
+    size = fread(data, 1, sizeof(data), fp);
+    fclose(fp);
+    if (size > (int) MaxFileSize)
+	Fail("too big for a Nachos file", path);
+
+    sector = FindSector();
+    for (i = 0; (i < NumDirEntries) && directory[i].inUse; i++)
+	;
+    if ((sector == -1) || (i == NumDirEntries))
+	Fail("the Nachos directory is full", path);
+    directory[i].inUse = 1;
+    directory[i].sector = sector;
+    strncpy(directory[i].name, name, FileNameMaxLen);
+    if (!Allocate(&hdr, size))
+	Fail("out of space on the Nachos disk", path);
+    WriteData(&hdr, data, size);
+    memcpy(Sector(sector), (char *) &hdr, sizeof(hdr));
+
+    numFiles++;
+    numBytes += size;
+    if (verbose)
+	printf("%-*s %5d bytes, header in sector %d, from %s\n",
+	    FileNameMaxLen, name, size, sector, path);
+}
+
+static int
+CompareNames(const void *a, const void *b)
+{
+    return strcmp(*(char * const *) a, *(char * const *) b);
+}
+
+/* AddDirectory -- copy in each file in the UNIX directory "path" */
+
+static void
+AddDirectory(char *path)
+{
+    DIR *dir = opendir(path);
+    struct dirent *entry;
+    struct stat info;
+    char **names = NULL, full[1024];
+    int numNames = 0, i;
+
+    if (dir == NULL)
+	Fail("couldn't read the directory", path);
+    while ((entry = readdir(dir)) != NULL) {
+	if (entry->d_name[0] == '.')
+	    continue;
+	names = (char **) realloc(names, (numNames + 1) * sizeof(char *));
+	if ((names == NULL)
+		|| ((names[numNames++] = strdup(entry->d_name)) == NULL))
+	    Fail("out of memory", path);
+    }
+    closedir(dir);
+    qsort(names, numNames, sizeof(char *), CompareNames);
+
+    for (i = 0; i < numNames; i++) {
+	snprintf(full, sizeof(full), "%s/%s", path, names[i]);
+	if (stat(full, &info) != 0)
+	    Fail("couldn't find it", full);
+	if (S_ISDIR(info.st_mode))
+	    fprintf(stderr, "mkdisk: %s: skipping directory (the Nachos file "
+		"system has only one)\n", full);
+	else
+	    AddFile(full, names[i]);
+	free(names[i]);
+    }
+    free(names);
+}
+
+int
+main(int argc, char **argv)
+{
+    DiskFileHeader mapHdr, dirHdr;
+    struct stat info;
+    char *imageName = "DISK", *name;
+    FILE *fp;
+    int i;
+
+    for (argc--, argv++; (argc > 0) && (argv[0][0] == '-'); argc--, argv++)
+	if (!strcmp(argv[0], "-v"))
+	    verbose = 1;
+	else if (!strcmp(argv[0], "-o") && (argc > 1)) {
+	    imageName = argv[1];
+	    argc--, argv++;
+	} else
+	    break;
+    if ((argc < 1) || (argv[0][0] == '-')) {
+	fprintf(stderr, "Usage: mkdisk [-o <disk image>] [-v] "
+	    "<file or directory> ...\n");
+	exit(1);
+    }
+
+    /* format, as in FileSystem::FileSystem */
+    *(int *) image = MagicNumber;
+    freeMap[FreeMapSector / 32] |= 1 << (FreeMapSector % 32);
+    freeMap[DirectorySector / 32] |= 1 << (DirectorySector % 32);
+    if (!Allocate(&mapHdr, FreeMapFileSize)
+	    || !Allocate(&dirHdr, DirectoryFileSize))
+	Fail("disk too small for a file system", imageName);
+
+    for (i = 0; i < argc; i++) {
+	if (stat(argv[i], &info) != 0)
+	    Fail("couldn't find it", argv[i]);
+	if (S_ISDIR(info.st_mode))
+	    AddDirectory(argv[i]);
+	else {
+	    name = strrchr(argv[i], '/');
+	    AddFile(argv[i], (name == NULL) ? argv[i] : name + 1);
+	}
+    }
+
+    memcpy(Sector(FreeMapSector), (char *) &mapHdr, sizeof(mapHdr));
+    memcpy(Sector(DirectorySector), (char *) &dirHdr, sizeof(dirHdr));
+    WriteData(&mapHdr, (char *) freeMap, FreeMapFileSize);
+    WriteData(&dirHdr, (char *) directory, DirectoryFileSize);
+
+    if (((fp = fopen(imageName, "wb")) == NULL)
+	    || (fwrite(image, 1, DiskSize, fp) != DiskSize)
+	    || (fclose(fp) != 0))
+	Fail("couldn't write the disk image", imageName);
+    printf("%s: %d files, %d bytes, %d of %d sectors free\n", imageName,
+	numFiles, numBytes, NumClear(), NumSectors);
+    exit(0);
+}
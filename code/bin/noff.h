@@ -1,14 +1,37 @@
-/* noff.h 
+/* noff.h
  *     Data structures defining the Nachos Object Code Format
  *
  *     Basically, we only know about three types of segments:
  *	code (read-only), initialized data, and unitialized data
+ *
+ *     A file with the magic number NOFFPAGEDMAGIC (which is what
+ *     coff2noff makes) has, after the NoffHeader, a NoffExtension
+ *     saying how each segment may be used, and each segment sits in
+ *     the file at the same offset within a page as it has in memory,
+ *     with the rest of its pages zero -- so the kernel can read each
+ *     page of the program straight from the file, and map the pages
+ *     that hold nothing but code read-only.  It may also carry a
+ *     table of the program's symbols, which isn't loaded.
  */
 
-#define NOFFMAGIC	0xbadfad 	/* magic number denoting Nachos 
-					 * object code file 
+#define NOFFMAGIC	0xbadfad 	/* magic number denoting Nachos
+					 * object code file
+					 */
+#define NOFFPAGEDMAGIC	0xbadfae	/* the same, with page-aligned
+					 * segments and a NoffExtension
+					 */
+
+#define NoffPageSize	128		/* page size the segments are
+					 * aligned for; must match
+					 * PageSize in ../machine/machine.h
 					 */
 
+/* how a segment may be used */
+#define NOFF_READ	0x1
+#define NOFF_WRITE	0x2
+#define NOFF_EXEC	0x4
+#define NOFF_ZERO	0x8		/* not in the file: fill with zeros */
+
 typedef struct segment {
   int virtualAddr;		/* location of segment in virt addr space */
   int inFileAddr;		/* location of segment in this file */
@@ -16,10 +39,33 @@ typedef struct segment {
 } Segment;
 
 typedef struct noffHeader {
-   int noffMagic;		/* should be NOFFMAGIC */
-   Segment code;		/* executable code segment */ 
+   int noffMagic;		/* should be NOFFMAGIC or NOFFPAGEDMAGIC */
+   Segment code;		/* executable code segment */
    Segment initData;		/* initialized data segment */
    Segment uninitData;		/* uninitialized data segment --
-				 * should be zero'ed before use 
+				 * should be zero'ed before use
 				 */
 } NoffHeader;
+
+typedef struct noffExtension {
+   int pageSize;		/* should be NoffPageSize */
+   int codeFlags;		/* NOFF_READ, ... for each segment */
+   int initDataFlags;
+   int uninitDataFlags;
+   Segment symbols;		/* symbol table (size 0 if there is none);
+				 * virtualAddr is unused
+				 */
+} NoffExtension;
+
+/* The symbol table is a count of symbols, that many NoffSymbols, and
+ * then their names, each ending in a null byte.
+ */
+
+#define NOFF_SYM_TEXT	1		/* a procedure, or a code label */
+#define NOFF_SYM_DATA	2		/* a variable, or a data label */
+
+typedef struct noffSymbol {
+   int value;			/* its address */
+   int type;			/* NOFF_SYM_TEXT or NOFF_SYM_DATA */
+   int name;			/* offset of its name, from the first */
+} NoffSymbol;
@@ -0,0 +1,416 @@
+/* pfanalyze.c
+ *
+ * This program reads a page reference trace, made by "nachos -pt <file>"
+ * (see pftrace.h), and prints what it says about the program's use of
+ * memory:
+ *
+ *	how many faults FIFO, LRU, clock and OPT page replacement would
+ *	take with 1, 2, ... page frames -- one global pool of frames,
+ *	shared by every address space in the trace, and starting empty
+ *
+ *	the distribution of reuse distances: for each reference, how many
+ *	other pages were touched since the last reference to its page
+ *	(LRU faults exactly on those at least as far as it has frames)
+ *
+ *	the average working-set size -- pages touched in the last "w"
+ *	references -- for windows of 1, 2, 4, ... references
+ *
+ *	the working set over time: pages touched, and faults taken by the
+ *	run itself, in each interval of the trace
+ *
+ * A "reference" here is a record in the trace, a run of references to
+ * one page.  Failed translations are counted, and shown in the working
+ * set over time, but left out of the rest: each is made again, and
+ * recorded again, once its fault has been handled.
+ *
+ * Usage: pfanalyze [-f <most frames>] [-i <interval ticks>] <trace file>
+ *
+ * Copyright (c) 1992-1993 The Regents of the University of California.
+ * All rights reserved.  See copyright.h for copyright notice and limitation
+ * of liability and disclaimer of warranty provisions.
+ */
+
+#define MAIN
+#include "copyright.h"
+#undef MAIN
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "pftrace.h"
+
+#define DefaultMaxFrames	64	/* frame counts to simulate */
+#define NumIntervals		20	/* rows in the timeline, by default */
+
+static PFTraceRecord *trace;	/* the records, faults left out */
+static int numRefs;
+static int *faultWhen;		/* when each fault was */
+static int numFaults;
+static int *ref;		/* each one's page, numbered from 0 */
+static int *pageKey;		/* and each page's space and number */
+static int numPages;
+
+static void *
+Allocate(int size)
+{
+    void *p = malloc(size > 0 ? size : 1);
+
+    if (p == NULL) {
+	fprintf(stderr, "Out of memory\n");
+	exit(1);
+    }
+    return p;
+}
+
+static int
+CompareInts(const void *a, const void *b)
+{
+    int x = *(const int *) a, y = *(const int *) b;
+
+    return (x < y) ? -1 : (x > y);
+}
+
+/* ReadTrace -- read the trace into memory, and number its pages */
+
+static void
+ReadTrace(char *fileName)
+{
+    FILE *file = fopen(fileName, "rb");
+    PFTraceHeader header;
+    PFTraceRecord record;
+    int size = 1024, faultSize = 1024, numRecords = 0, numWrites = 0;
+    int i, j, *keys, *found;
+
+    if (file == NULL) {
+	fprintf(stderr, "Unable to open trace file %s\n", fileName);
+	exit(1);
+    }
+    if ((fread((char *) &header, sizeof(header), 1, file) != 1)
+		|| (header.magic != PFTRACEMAGIC)) {
+	fprintf(stderr, "%s is not a Nachos page trace\n", fileName);
+	exit(1);
+    }
+    trace = (PFTraceRecord *) Allocate(size * sizeof(PFTraceRecord));
+    faultWhen = (int *) Allocate(faultSize * sizeof(int));
+    while (fread((char *) &record, sizeof(record), 1, file) == 1) {
+	numRecords++;
+	if (record.flags & PFTRACE_FAULT) {
+	    if (numFaults == faultSize) {
+		faultSize *= 2;
+		faultWhen = (int *) realloc(faultWhen, faultSize * sizeof(int));
+		if (faultWhen == NULL) {
+		    fprintf(stderr, "Out of memory\n");
+		    exit(1);
+		}
+	    }
+	    faultWhen[numFaults++] = record.when;
+	    continue;
+	}
+	if (record.flags & PFTRACE_WRITE)
+	    numWrites++;
+	if (numRefs == size) {
+	    size *= 2;
+	    trace = (PFTraceRecord *) realloc(trace,
+					size * sizeof(PFTraceRecord));
+	    if (trace == NULL) {
+		fprintf(stderr, "Out of memory\n");
+		exit(1);
+	    }
+	}
+	trace[numRefs++] = record;
+    }
+    fclose(file);
+
+    /* number the distinct pages, in order of space, then page */
+    keys = (int *) Allocate(numRefs * sizeof(int));
+    for (i = 0; i < numRefs; i++)
+	keys[i] = (trace[i].space << 16) | trace[i].page;
+    pageKey = (int *) Allocate(numRefs * sizeof(int));
+    memcpy(pageKey, keys, numRefs * sizeof(int));
+    qsort(pageKey, numRefs, sizeof(int), CompareInts);
+    for (i = j = 0; i < numRefs; i++)
+	if ((j == 0) || (pageKey[j - 1] != pageKey[i]))
+	    pageKey[j++] = pageKey[i];
+    numPages = j;
+    ref = (int *) Allocate(numRefs * sizeof(int));
+    for (i = 0; i < numRefs; i++) {
+	found = (int *) bsearch(&keys[i], pageKey, numPages, sizeof(int),
+				CompareInts);
+	ref[i] = found - pageKey;
+    }
+    free(keys);
+
+    printf("Trace: %d records, %d failed translations, %d references"
+	" (%d writing), %d pages, %d bytes each", numRecords, numFaults,
+	numRefs, numWrites, numPages, header.pageSize);
+    if (numRefs > 0)
+	printf(", ticks %d to %d", trace[0].when, trace[numRefs - 1].when);
+    printf("\n");
+}
+
+/* FIFOFaults, ClockFaults, OPTFaults -- simulate "frames" page frames */
+
+static int
+FIFOFaults(int frames, int *slot, int *where)
+{
+    int i, hand = 0, used = 0, faults = 0;
+
+    for (i = 0; i < numPages; i++)
+	where[i] = -1;
+    for (i = 0; i < numRefs; i++) {
+	if (where[ref[i]] >= 0)
+	    continue;
+	faults++;
+	if (used < frames)
+	    hand = used++;
+	else
+	    where[slot[hand]] = -1;
+	slot[hand] = ref[i];
+	where[ref[i]] = hand;
+	hand = (hand + 1) % frames;
+    }
+    return faults;
+}
+
+static int
+ClockFaults(int frames, int *slot, int *where, char *use)
+{
+    int i, hand = 0, used = 0, faults = 0;
+
+    for (i = 0; i < numPages; i++)
+	where[i] = -1;
+    for (i = 0; i < numRefs; i++) {
+	if (where[ref[i]] >= 0) {
+	    use[where[ref[i]]] = 1;
+	    continue;
+	}
+	faults++;
+	if (used < frames)
+	    hand = used++;
+	else {
+	    while (use[hand]) {		/* give it a second chance */
+		use[hand] = 0;
+		hand = (hand + 1) % frames;
+	    }
+	    where[slot[hand]] = -1;
+	}
+	slot[hand] = ref[i];
+	use[hand] = 1;
+	where[ref[i]] = hand;
+	hand = (hand + 1) % frames;
+    }
+    return faults;
+}
+
+static int
+OPTFaults(int frames, int *slot, int *where, int *next, int *nextUse)
+{
+    int i, j, victim, used = 0, faults = 0;
+
+    for (i = 0; i < numPages; i++)
+	where[i] = -1;
+    for (i = 0; i < numRefs; i++) {
+	if (where[ref[i]] < 0) {
+	    faults++;
+	    if (used < frames)
+		victim = used++;
+	    else {			/* the page used furthest ahead */
+		for (victim = 0, j = 1; j < frames; j++)
+		    if (nextUse[j] > nextUse[victim])
+			victim = j;
+		where[slot[victim]] = -1;
+	    }
+	    slot[victim] = ref[i];
+	    where[ref[i]] = victim;
+	}
+	nextUse[where[ref[i]]] = next[i];
+    }
+    return faults;
+}
+
+/* ReuseDistances -- find each reference's LRU stack distance, and
+ * count them: hist[d] references at distance d, hist[0] first touches
+ */
+
+static void
+ReuseDistances(int *hist)
+{
+    int *stack = (int *) Allocate(numPages * sizeof(int));
+    int i, depth = 0, d;
+
+    for (i = 0; i <= numPages; i++)
+	hist[i] = 0;
+    for (i = 0; i < numRefs; i++) {
+	for (d = 0; (d < depth) && (stack[d] != ref[i]); d++)
+	    ;
+	if (d == depth) {
+	    hist[0]++;
+	    depth++;
+	} else
+	    hist[d + 1]++;
+	for (; d > 0; d--)		/* move it to the top */
+	    stack[d] = stack[d - 1];
+	stack[0] = ref[i];
+    }
+    free(stack);
+}
+
+static void
+PrintFaults(int maxFrames, int *hist)
+{
+    int *slot = (int *) Allocate(maxFrames * sizeof(int));
+    int *where = (int *) Allocate(numPages * sizeof(int));
+    int *next = (int *) Allocate(numRefs * sizeof(int));
+    int *nextUse = (int *) Allocate(maxFrames * sizeof(int));
+    char *use = (char *) Allocate(maxFrames);
+    int frames, i, lru;
+
+    for (i = 0; i < numPages; i++)	/* when each reference's page */
+	where[i] = numRefs;		/* is next used */
+    for (i = numRefs - 1; i >= 0; i--) {
+	next[i] = where[ref[i]];
+	where[ref[i]] = i;
+    }
+
+    printf("\nFaults by number of page frames:\n");
+    printf("frames       FIFO        LRU      clock        OPT\n");
+    for (frames = 1; frames <= maxFrames; frames++) {
+	for (lru = hist[0], i = frames + 1; i <= numPages; i++)
+	    lru += hist[i];
+	printf("%6d %10d %10d %10d %10d\n", frames,
+	    FIFOFaults(frames, slot, where),
+	    lru,
+	    ClockFaults(frames, slot, where, use),
+	    OPTFaults(frames, slot, where, next, nextUse));
+    }
+    free(slot);
+    free(where);
+    free(next);
+    free(nextUse);
+    free(use);
+}
+
+static void
+PrintReuse(int *hist)
+{
+    int low, high, i, count, total = hist[0];
+
+    printf("\nReuse distances (pages touched in between, plus one):\n");
+    printf("  distance      count  cumulative\n");
+    printf("%10s %10d\n", "first", hist[0]);
+    for (low = 1; low <= numPages; low = high + 1) {
+	high = (low == 1) ? 1 : 2 * low - 1;
+	for (count = 0, i = low; (i <= high) && (i <= numPages); i++)
+	    count += hist[i];
+	total += count;
+	if (count > 0)
+	    printf("%4d-%-5d %10d %10.1f%%\n", low, high, count,
+		100.0 * total / numRefs);
+    }
+}
+
+/* PrintWorkingSets -- the average number of distinct pages in the last
+ * "window" references, for windows of 1, 2, 4, ..., references
+ */
+
+static void
+PrintWorkingSets()
+{
+    int *count = (int *) Allocate(numPages * sizeof(int));
+    int window, i, size;
+    double sum;
+
+    printf("\nAverage working set, by window:\n");
+    printf("    window   pages\n");
+    for (window = 1; ; window *= 2) {
+	for (i = 0; i < numPages; i++)
+	    count[i] = 0;
+	for (i = size = 0, sum = 0; i < numRefs; i++) {
+	    if (count[ref[i]]++ == 0)
+		size++;
+	    if ((i >= window) && (--count[ref[i - window]] == 0))
+		size--;
+	    sum += size;
+	}
+	printf("%10d %7.2f\n", window, (numRefs > 0) ? sum / numRefs : 0.0);
+	if (window >= numRefs)
+	    break;
+    }
+    free(count);
+}
+
+/* PrintTimeline -- the pages touched, and the faults taken, in each
+ * "interval" ticks
+ */
+
+static void
+PrintTimeline(int interval)
+{
+    char *seen = (char *) Allocate(numPages);
+    int i, f, first, last, start, refs, pages, faults;
+
+    if (numRefs + numFaults == 0)
+	return;
+    first = (numRefs > 0) ? trace[0].when : faultWhen[0];
+    last = (numRefs > 0) ? trace[numRefs - 1].when : faultWhen[numFaults - 1];
+    if ((numFaults > 0) && (faultWhen[0] < first))
+	first = faultWhen[0];
+    if ((numFaults > 0) && (faultWhen[numFaults - 1] > last))
+	last = faultWhen[numFaults - 1];
+    if (interval <= 0)
+	interval = (last - first) / NumIntervals + 1;
+    printf("\nWorking set over time, every %d ticks:\n", interval);
+    printf("     tick  references   pages  faults\n");
+    for (i = f = 0; (i < numRefs) || (f < numFaults); ) {
+	start = (i < numRefs) ? trace[i].when : faultWhen[f];
+	if ((f < numFaults) && (faultWhen[f] < start))
+	    start = faultWhen[f];
+	start -= start % interval;
+	memset(seen, 0, numPages);
+	for (refs = pages = 0; (i < numRefs)
+			&& (trace[i].when < start + interval); i++, refs++)
+	    if (!seen[ref[i]]) {
+		seen[ref[i]] = 1;
+		pages++;
+	    }
+	for (faults = 0; (f < numFaults)
+			&& (faultWhen[f] < start + interval); f++)
+	    faults++;
+	printf("%9d  %10d  %6d  %6d\n", start, refs, pages, faults);
+    }
+    free(seen);
+}
+
+int
+main(int argc, char **argv)
+{
+    int maxFrames = DefaultMaxFrames, interval = 0, *hist;
+
+    for (argc--, argv++; (argc > 1) && (argv[0][0] == '-'); argc -= 2,
+								argv += 2)
+	if (!strcmp(argv[0], "-f"))
+	    maxFrames = atoi(argv[1]);
+	else if (!strcmp(argv[0], "-i"))
+	    interval = atoi(argv[1]);
+	else
+	    break;
+    if ((argc != 1) || (maxFrames <= 0)) {
+	fprintf(stderr, "Usage: pfanalyze [-f <most frames>] "
+	    "[-i <interval ticks>] <trace file>\n");
+	exit(1);
+    }
+    ReadTrace(argv[0]);
+    if (maxFrames > numPages)
+	maxFrames = numPages;
+
+    hist = (int *) Allocate((numPages + 1) * sizeof(int));
+    ReuseDistances(hist);
+    if (maxFrames > 0)
+	PrintFaults(maxFrames, hist);
+    PrintReuse(hist);
+    PrintWorkingSets();
+    PrintTimeline(interval);
+    free(hist);
+    exit(0);
+}
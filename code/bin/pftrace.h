@@ -0,0 +1,36 @@
+/* pftrace.h
+ *     Data structures defining the format of a page reference trace,
+ *     as written by "nachos -pt <file>" (see ../machine/pagetrace.h)
+ *     and read back by pfanalyze.
+ *
+ *     A trace is a header followed by one record per run of references
+ *     to a page: consecutive references by the same address space to
+ *     the same virtual page make one record, stamped with the time of
+ *     the first of them.  (No page replacement policy can fault on any
+ *     reference in a run but the first, so nothing is lost for the
+ *     analysis.)  A reference whose translation failed -- a fault
+ *     taken by the run itself -- always gets a record of its own,
+ *     marked PFTRACE_FAULT; the reference is made again once the
+ *     fault has been handled, and recorded as usual.  Words are in the
+ *     byte order of the host that made the trace.
+ */
+
+#define PFTRACEMAGIC	0x9a9e7ace	/* magic number denoting a Nachos
+					 * page reference trace
+					 */
+
+#define PFTRACE_WRITE	0x1		/* some reference in the run wrote */
+#define PFTRACE_FAULT	0x2		/* the translation failed */
+
+typedef struct pfTraceHeader {
+   unsigned int magic;		/* should be PFTRACEMAGIC */
+   int pageSize;		/* bytes per virtual page */
+} PFTraceHeader;
+
+typedef struct pfTraceRecord {
+   int when;			/* simulated time of the reference */
+   unsigned short page;		/* virtual page number, mod 65536 */
+   unsigned char space;		/* address space number, mod 256
+				 * (see AddrSpace::Id) */
+   unsigned char flags;		/* PFTRACE_WRITE, PFTRACE_FAULT */
+} PFTraceRecord;
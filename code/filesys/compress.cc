@@ -0,0 +1,120 @@
+// compress.cc
+//	Routines to compress and decompress blocks of file data.  The
+//	format is described in compress.h.
+//
+// Copyright (c) 1992-1993 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#include "copyright.h"
+#include "compress.h"
+
+#define MinMatch	3		// shortest copy worth making
+#define MaxMatch	(MinMatch + 15)	// longest that fits in 4 bits
+#define MaxDistance	4095		// furthest back, in 12 bits
+#define HashSize	4096		// entries in the table of strings seen
+
+#define Hash(p)	((((p)[0] << 8) ^ ((p)[1] << 4) ^ (p)[2]) & (HashSize - 1))
+
+//----------------------------------------------------------------------
+// CompressBlock
+// 	Compress a block.  For each position, look up the last place
+//	the same three bytes (or ones that hash the same) were seen, and
+//	copy from there if they really do match; otherwise put out the
+//	byte as it is.
+//
+//	"from" -- the data to be compressed
+//	"size" -- how much of it
+//	"to" -- where to put the result
+//	"room" -- how big that is
+//----------------------------------------------------------------------
+
+int
+CompressBlock(char *from, int size, char *to, int room)
+{
+    unsigned char *in = (unsigned char *) from;
+    unsigned char *out = (unsigned char *) to;
+    int last[HashSize];			// where each hash was last seen
+    int pos = 0, used = 0, flagsAt = 0, item = 8;
+    int h, match, length, distance;
+
+    for (h = 0; h < HashSize; h++)
+	last[h] = -1;
+    while (pos < size) {
+	if (item == 8) {		// start a new group of eight
+	    if (used >= room)
+		return -1;
+	    flagsAt = used++;
+	    out[flagsAt] = 0;
+	    item = 0;
+	}
+	length = 0;
+	if (pos + MinMatch <= size) {
+	    h = Hash(in + pos);
+	    match = last[h];
+	    last[h] = pos;
+	    if ((match >= 0) && (pos - match <= MaxDistance))
+		while ((length < MaxMatch) && (pos + length < size)
+			&& (in[match + length] == in[pos + length]))
+		    length++;
+	}
+	if (length >= MinMatch) {
+	    if (used + 2 > room)
+		return -1;
+	    distance = pos - match;
+	    out[used++] = distance & 0xff;
+	    out[used++] = ((distance >> 8) & 0xf) | ((length - MinMatch) << 4);
+	    out[flagsAt] |= 1 << item;
+	    for (pos++, length--; length > 0; pos++, length--)
+		if (pos + MinMatch <= size)	// remember the strings in
+		    last[Hash(in + pos)] = pos;	// the copy, too
+	} else {
+	    if (used + 1 > room)
+		return -1;
+	    out[used++] = in[pos++];
+	}
+	item++;
+    }
+    return used;
+}
+
+//----------------------------------------------------------------------
+// DecompressBlock
+// 	Undo CompressBlock, checking that every copy stays within the
+//	data and the room we have.
+//
+//	"from" -- the compressed data
+//	"size" -- how much of it
+//	"to" -- where to put the result
+//	"room" -- how big that is
+//----------------------------------------------------------------------
+
+int
+DecompressBlock(char *from, int size, char *to, int room)
+{
+    unsigned char *in = (unsigned char *) from;
+    unsigned char *out = (unsigned char *) to;
+    int pos = 0, made = 0, item, flags, length, distance;
+
+    while (pos < size) {
+	flags = in[pos++];
+	for (item = 0; (item < 8) && (pos < size); item++)
+	    if (flags & (1 << item)) {
+		if (pos + 2 > size)
+		    return -1;
+		distance = in[pos] | ((in[pos + 1] & 0xf) << 8);
+		length = (in[pos + 1] >> 4) + MinMatch;
+		pos += 2;
+		if ((distance == 0) || (distance > made)
+			|| (made + length > room))
+		    return -1;
+		for (; length > 0; length--, made++)	// may overlap
+		    out[made] = out[made - distance];
+	    } else {
+		if (made >= room)
+		    return -1;
+		out[made++] = in[pos++];
+	    }
+    }
+    return made;
+}
@@ -0,0 +1,31 @@
+// compress.h
+//	Routines to compress and decompress blocks of file data, for
+//	compressed files (see filehdr.h).
+//
+//	The codec is a simple LZ77 -- a form of LZSS -- chosen to be fast
+//	rather than to squeeze out the last byte: each item is either a
+//	literal byte, or a copy of 3 to 18 bytes from up to 4095 bytes
+//	back, found by hashing the next three bytes.  Eight items are
+//	preceded by a byte of flags saying which are which; a copy takes
+//	two bytes, its distance back in the low 12 bits and its length
+//	less 3 in the high 4.  A block of C source shrinks by about a
+//	third; data that repeats itself, much more.
+//
+// Copyright (c) 1992-1993 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#ifndef COMPRESS_H
+#define COMPRESS_H
+
+#include "copyright.h"
+
+// Compress "size" bytes at "from" into "to"; return the size of the
+// result, or -1 if it would take more than "room" bytes.
+extern int CompressBlock(char *from, int size, char *to, int room);
+
+// Decompress "size" bytes at "from" into "to"; return the size of the
+// result, or -1 if it is damaged, or would take more than "room" bytes.
+extern int DecompressBlock(char *from, int size, char *to, int room);
+
+#endif // COMPRESS_H
@@ -0,0 +1,328 @@
+// disktrace.cc
+//	Routines to record the requests made of the disk, and to replay
+//	them, timing them again.
+//
+// Copyright (c) 1992-1993 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#include "copyright.h"
+#include "disktrace.h"
+#include "system.h"
+
+#define ReplayDiskName	"REPLAYDISK"	// the scratch disk replays use
+
+//----------------------------------------------------------------------
+// DiskTrace::DiskTrace
+// 	Create a trace file and write its header.
+//
+//	"fileName" -- UNIX file to hold the trace
+//----------------------------------------------------------------------
+
+DiskTrace::DiskTrace(char *fileName)
+{
+    DTraceHeader header;
+
+    name = fileName;
+    numRequests = numThreads = 0;
+    file = fopen(fileName, "wb");
+    if (file == NULL) {
+	printf("Disk trace: couldn't open trace file %s\n", fileName);
+	Abort();
+    }
+    header.magic = DTRACEMAGIC;
+    header.sectorSize = SectorSize;
+    header.numSectors = NumSectors;
+    fwrite((char *) &header, sizeof(header), 1, file);
+}
+
+DiskTrace::~DiskTrace()
+{
+    fclose(file);
+}
+
+//----------------------------------------------------------------------
+// DiskTrace::ThreadNumber
+// 	Return the number thread "t" goes by in the trace, giving it the
+//	next one if it hasn't used the disk before.  A thread made after
+//	another has finished may be given the same control block, and so
+//	the same number; as the first made all its requests before the
+//	second made any, a replay is none the worse for it.
+//----------------------------------------------------------------------
+
+int
+DiskTrace::ThreadNumber(Thread *t)
+{
+    int i;
+
+    for (i = 0; i < numThreads; i++)
+	if (threads[i] == t)
+	    return i;
+    if (numThreads == MaxTraceThreads)
+	return MaxTraceThreads - 1;
+    threads[numThreads] = t;
+    return numThreads++;
+}
+
+//----------------------------------------------------------------------
+// DiskTrace::Request
+// 	Record a request, which has just finished.
+//
+//	"thread" -- the thread that made it
+//	"sector" -- the sector read or written
+//	"writing" -- TRUE for a write
+//	"issued" -- when the request was made
+//	"started" -- when it was sent to the disk
+//----------------------------------------------------------------------
+
+void
+DiskTrace::Request(Thread *thread, int sector, bool writing, int issued,
+								int started)
+{
+    DTraceRecord record;
+
+    record.thread = ThreadNumber(thread);
+    record.sector = sector;
+    record.writing = writing ? 1 : 0;
+    record.issued = issued;
+    record.started = started;
+    record.done = stats->totalTicks;
+    fwrite((char *) &record, sizeof(record), 1, file);
+    numRequests++;
+}
+
+//----------------------------------------------------------------------
+// DiskTrace::Print
+// 	Print how many requests were traced.
+//----------------------------------------------------------------------
+
+void
+DiskTrace::Print()
+{
+    printf("Disk trace: %d requests, from %d threads, to %s\n",
+	numRequests, numThreads, name);
+}
+
+//----------------------------------------------------------------------
+// Replaying a trace.  Each thread in the trace is played by a task
+// of its own (see task.h), which makes its requests of replayDisk and
+// notes how long each took in "latencies".  A trace can have many
+// threads, and a task costs far less than a thread and its stack.
+//----------------------------------------------------------------------
+
+static DTraceRecord *records;		// the trace
+static int numRecords;
+static int *latencies;			// of each request, as replayed
+static int firstIssued;			// when the trace started
+static int replayStart;			// when the replay did
+static int replaySpeedup;
+static SynchDisk *replayDisk;
+static Semaphore *replayDone;		// V'ed as each thread finishes
+
+//----------------------------------------------------------------------
+// ReadTrace
+// 	Read the whole of the trace in "fileName" into "records".  Return
+//	FALSE if it can't be read, or wasn't made on a disk like ours.
+//----------------------------------------------------------------------
+
+static bool
+ReadTrace(char *fileName)
+{
+    DTraceHeader header;
+    DTraceRecord *bigger;
+    FILE *fp;
+    int room = 1024;
+
+    if ((fp = fopen(fileName, "rb")) == NULL) {
+	printf("Disk replay: couldn't open trace file %s\n", fileName);
+	return FALSE;
+    }
+    if ((fread((char *) &header, sizeof(header), 1, fp) != 1)
+		|| (header.magic != DTRACEMAGIC)
+		|| (header.sectorSize != SectorSize)
+		|| (header.numSectors > NumSectors)) {
+	printf("Disk replay: %s isn't a trace from a disk like this one\n",
+	    fileName);
+	fclose(fp);
+	return FALSE;
+    }
+    records = new DTraceRecord[room];
+    numRecords = 0;
+    while (fread((char *) &records[numRecords], sizeof(DTraceRecord), 1, fp)
+									== 1) {
+	if (++numRecords == room) {
+	    bigger = new DTraceRecord[room * 2];
+	    bcopy((char *) records, (char *) bigger,
+					room * sizeof(DTraceRecord));
+	    delete [] records;
+	    records = bigger;
+	    room *= 2;
+	}
+    }
+    fclose(fp);
+    return TRUE;
+}
+
+// The following class defines the task that plays one thread of the
+// trace.  Its Run() can only keep what it needs across a TASK_AWAIT
+// in the object itself, so that is where the run of requests it is
+// making lives.
+
+class ReplayTask : public Task {
+  public:
+    ReplayTask(int which);
+    TaskStatus Run();
+
+  private:
+    int thread;				// which thread of the trace we play
+    int i, j, n;			// the record we are at; the run
+    int run[MaxTransfer];		// of records being made, and the
+    DiskRequest *requests[MaxTransfer];	// requests making them
+    int issued;				// when they were made
+    char buffer[MaxTransfer * SectorSize];
+};
+
+ReplayTask::ReplayTask(int which) : Task("disk replay")
+{
+    thread = which;
+    bzero(buffer, MaxTransfer * SectorSize);
+}
+
+//----------------------------------------------------------------------
+// ReplayTask::Run
+// 	Make the requests of our thread in the trace, in order, each at
+//	its time (scaled by replaySpeedup) or as soon as the one before
+//	is done, whichever is later.  A run of reads or writes the thread
+//	made all at once (with ReadSectors or WriteSectors) is Submitted
+//	all at once again, and each counts as taking until the last is
+//	done.
+//----------------------------------------------------------------------
+
+TaskStatus
+ReplayTask::Run()
+{
+    IntStatus oldLevel;
+
+    TASK_BEGIN();
+    for (i = 0; i < numRecords; i++) {
+	if (records[i].thread != thread)
+	    continue;
+	for (n = 0, j = i; (j < numRecords) && (n < MaxTransfer); j++) {
+	    if (records[j].thread != thread)
+		continue;
+	    if ((records[j].issued != records[i].issued)
+			|| (records[j].writing != records[i].writing))
+		break;
+	    run[n++] = j;
+	}
+	if (replaySpeedup > 0)
+	    TASK_AWAIT(alarms->PauseUntil(replayStart
+		+ (records[i].issued - firstIssued) / replaySpeedup, this));
+	issued = stats->totalTicks;
+	oldLevel = interrupt->SetLevel(IntOff);	// all issued at the
+	for (j = 0; j < n; j++)			// same tick
+	    requests[j] = replayDisk->Submit(records[run[j]].sector,
+			&buffer[j * SectorSize], records[i].writing);
+	(void) interrupt->SetLevel(oldLevel);
+	for (j = 0; j < n; j++)
+	    TASK_AWAIT(replayDisk->Wait(requests[j], this));
+	for (j = 0; j < n; j++) {
+	    latencies[run[j]] = stats->totalTicks - issued;
+	    delete requests[j];
+	}
+	i = run[n - 1];
+    }
+    replayDone->V();
+    TASK_END();
+}
+
+//----------------------------------------------------------------------
+// ReportLatencies
+// 	Print, as one line of JSON, the number of requests, how long they
+//	took from the first being made to the last finishing, and their
+//	latencies (in ticks) at the 50th, 90th and 99th percentiles, at
+//	worst, and on average.  "latency" is sorted to find the
+//	percentiles.
+//
+//	"what" -- "traced" or "replayed"
+//	"latency" -- of each request
+//	"ticks" -- from the first request to the last
+//----------------------------------------------------------------------
+
+static void
+ReportLatencies(char *what, int *latency, int ticks)
+{
+    int i, j, l, reads = 0;
+    double total = 0;
+
+    for (i = 0; i < numRecords; i++) {
+	if (!records[i].writing)
+	    reads++;
+	total += latency[i];
+    }
+    for (i = 1; i < numRecords; i++) {		// insertion sort
+	l = latency[i];
+	for (j = i; (j > 0) && (latency[j - 1] > l); j--)
+	    latency[j] = latency[j - 1];
+	latency[j] = l;
+    }
+    printf("{\"replay\": \"%s\", \"speedup\": %d, \"requests\": %d, "
+	"\"reads\": %d, \"writes\": %d, \"ticks\": %d, ", what, replaySpeedup,
+	numRecords, reads, numRecords - reads, ticks);
+    if (numRecords > 0)
+	printf("\"p50\": %d, \"p90\": %d, \"p99\": %d, \"max\": %d, "
+	    "\"mean\": %d", latency[numRecords * 50 / 100],
+	    latency[numRecords * 90 / 100], latency[numRecords * 99 / 100],
+	    latency[numRecords - 1], (int) (total / numRecords));
+    printf("}\n");
+}
+
+//----------------------------------------------------------------------
+// DiskTraceReplay
+// 	Replay the trace in "fileName" on a scratch disk, ReplayDiskName,
+//	with a task for each thread in the trace, and print the
+//	latencies of its requests as traced and as replayed.
+//
+//	"fileName" -- the trace
+//	"speedup" -- how many times faster than traced to make requests,
+//		or 0 to make each as soon as the one before it is done
+//----------------------------------------------------------------------
+
+void
+DiskTraceReplay(char *fileName, int speedup)
+{
+    int *traced;
+    int i, numThreads = 0, lastDone = 0;
+
+    if (!ReadTrace(fileName))
+	return;
+    replaySpeedup = speedup;
+    traced = new int[numRecords];
+    latencies = new int[numRecords];
+    firstIssued = (numRecords > 0) ? records[0].issued : 0;
+    for (i = 0; i < numRecords; i++) {
+	traced[i] = records[i].done - records[i].issued;
+	latencies[i] = 0;
+	firstIssued = min(firstIssued, records[i].issued);
+	lastDone = max(lastDone, records[i].done);
+	numThreads = max(numThreads, records[i].thread + 1);
+    }
+    DEBUG('d', "Replaying %d disk requests, from %d threads\n", numRecords,
+	numThreads);
+
+    replayDisk = new SynchDisk(ReplayDiskName);
+    replayDone = new Semaphore("replay done", 0);
+    replayStart = stats->totalTicks;
+    for (i = 0; i < numThreads; i++)
+	(new ReplayTask(i))->Start();
+    for (i = 0; i < numThreads; i++)
+	replayDone->P();
+
+    ReportLatencies("traced", traced, lastDone - firstIssued);
+    ReportLatencies("replayed", latencies, stats->totalTicks - replayStart);
+    delete replayDone;
+    delete replayDisk;
+    delete [] latencies;
+    delete [] traced;
+    delete [] records;
+}
@@ -0,0 +1,86 @@
+// disktrace.h
+//	Data structures to record every request made of the disk, and
+//	to replay a recording.
+//
+//	With "nachos -dt <file>", each request made of the SynchDisk is
+//	written to a trace file: the thread that made it, the sector,
+//	whether it was a write, and three ticks -- when it was made,
+//	when it went to the disk (once the requests ahead of it were
+//	done), and when it finished.
+//
+//	"nachos -dtr <file> <speedup>" replays a trace against the disk
+//	and SynchDisk this Nachos was built with, on a scratch disk of its
+//	own (the UNIX file REPLAYDISK, which it leaves behind), so that the
+//	same requests can be timed under another disk model or another
+//	way of scheduling them.  Each thread in the trace gets a task of
+//	its own, making the same requests in the same order (a run it
+//	made all at once, with ReadSectors or WriteSectors, all at once
+//	again); a request is made "speedup" times sooner after the start
+//	than it was in the trace (but never before the thread's previous
+//	request is done), or, if "speedup" is 0, as soon as the previous
+//	one is done.  The latencies of the requests as traced, and as
+//	replayed, are printed as JSON.
+//
+// Copyright (c) 1992-1993 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#ifndef DISKTRACE_H
+#define DISKTRACE_H
+
+#include "copyright.h"
+#include "utility.h"
+
+class Thread;
+
+#define DTRACEMAGIC	0xd15c7ace	// first word of a disk trace
+#define MaxTraceThreads	64		// threads told apart in a trace
+
+// A disk trace is a DTraceHeader, followed by a DTraceRecord for each
+// request, in the order they finished.  Words are in the byte order of
+// the host that made the trace.
+
+typedef struct {
+    unsigned int magic;		// DTRACEMAGIC
+    int sectorSize;		// the disk the trace was made on
+    int numSectors;
+} DTraceHeader;
+
+typedef struct {
+    int thread;			// which thread made it, numbered from 0 in
+				// the order they first used the disk
+    int sector;
+    int writing;		// 1 for a write, 0 for a read
+    int issued;			// when the request was made,
+    int started;		// sent to the disk,
+    int done;			// and finished, in ticks
+} DTraceRecord;
+
+// The following class defines a disk trace, being recorded.
+
+class DiskTrace {
+  public:
+    DiskTrace(char *fileName);	// Start a trace in "fileName"
+    ~DiskTrace();		// Close it
+
+    void Request(Thread *thread, int sector, bool writing, int issued,
+		int started);	// Record a request, which has just finished
+
+    void Print();		// print how much was traced
+
+  private:
+    FILE *file;			// the trace file
+    char *name;			// its name, for messages
+    int numRequests;
+    Thread *threads[MaxTraceThreads];	// the threads seen so far; a
+    int numThreads;			// thread that isn't, after the
+					// table is full, counts as the last
+
+    int ThreadNumber(Thread *t);	// what to call "t" in the trace
+};
+
+// Replay the trace in "fileName", "speedup" times faster (0 for
+// as fast as the disk can go).
+extern void DiskTraceReplay(char *fileName, int speedup);
+
+#endif // DISKTRACE_H
@@ -26,6 +26,7 @@
 
 #include "system.h"
 #include "filehdr.h"
+#include "compress.h"
 
 //----------------------------------------------------------------------
 // FileHeader::Allocate
@@ -34,13 +35,26 @@
 //	Return FALSE if there are not enough free blocks to accomodate
 //	the new file.
 //
+//	A compressed file starts out all zeros, which takes no blocks;
+//	each block gets its sectors when it is written (see SetBlock).
+//	It still can't be bigger than the header could map uncompressed,
+//	since a block that doesn't compress is stored as is.
+//
 //	"freeMap" is the bit map of free disk sectors
 //	"fileSize" is the bit map of free disk sectors
+//	"compressed" is TRUE if the file's data is to be compressed
 //----------------------------------------------------------------------
 
 bool
-FileHeader::Allocate(BitMap *freeMap, int fileSize)
+FileHeader::Allocate(BitMap *freeMap, int fileSize, bool compressed)
 { 
+    if (compressed) {
+	if (fileSize > (int) MaxFileSize)
+	    return FALSE;		// too big to map
+	numBytes = fileSize | CompressedFile;
+	numSectors = 0;			// every block a hole
+	return TRUE;
+    }
     numBytes = fileSize;
     numSectors  = divRoundUp(fileSize, SectorSize);
     if (freeMap->NumClear() < numSectors)
@@ -54,17 +68,261 @@ FileHeader::Allocate(BitMap *freeMap, int fileSize)
 //----------------------------------------------------------------------
 // FileHeader::Deallocate
 // 	De-allocate all the space allocated for data blocks for this file.
+//	A block shared with a clone stays allocated for the clone.
 //
 //	"freeMap" is the bit map of free disk sectors
 //----------------------------------------------------------------------
 
 void 
-FileHeader::Deallocate(BitMap *freeMap)
+FileHeader::Deallocate(FreeMap *freeMap)
+{
+    int total = DataSectors();
+
+    for (int i = 0; i < total; i++)
+	if (dataSectors[i] & MayBeShared)
+	    freeMap->Release(dataSectors[i] & ~MayBeShared);
+	else {
+	    ASSERT(freeMap->Test((int) dataSectors[i]));  // ought to be marked!
+	    freeMap->Clear((int) dataSectors[i]);
+	}
+}
+
+//----------------------------------------------------------------------
+// FileHeader::Share
+// 	Count a new clone of this file as a user of each of its data
+//	blocks, and mark them all as shared.  The clone's header is then
+//	just a copy of this one.  Return FALSE, changing nothing, if some
+//	block is already shared by as many files as the free map can count.
+//
+//	"freeMap" is the bit map of free disk sectors
+//----------------------------------------------------------------------
+
+bool
+FileHeader::Share(FreeMap *freeMap)
+{
+    int total = DataSectors();
+    int i;
+
+    for (i = 0; i < total; i++)
+	if (!freeMap->Share(dataSectors[i] & ~MayBeShared)) {
+	    while (--i >= 0)
+		freeMap->Release(dataSectors[i] & ~MayBeShared);
+	    return FALSE;
+	}
+    for (i = 0; i < total; i++)
+	dataSectors[i] |= MayBeShared;
+    return TRUE;
+}
+
+//----------------------------------------------------------------------
+// FileHeader::MayShare
+// 	Return TRUE if the block holding the byte at "offset" might be
+//	shared with a clone of this file (or the file it is a clone of).
+//----------------------------------------------------------------------
+
+bool
+FileHeader::MayShare(int offset)
+{
+    ASSERT(!IsCompressed());
+    return (dataSectors[offset / SectorSize] & MayBeShared) != 0;
+}
+
+//----------------------------------------------------------------------
+// FileHeader::Unshare
+// 	Get ready to write to the block holding the byte at "offset": if
+//	another file is still using it, leave it to that file, and give
+//	this one a fresh block in its place.  The caller must then write
+//	the whole of the block, and write this header back to disk.
+//	Return FALSE if there is no free block.
+//
+//	"freeMap" is the bit map of free disk sectors
+//	"offset" is the location within the file of a byte in the block
+//----------------------------------------------------------------------
+
+bool
+FileHeader::Unshare(FreeMap *freeMap, int offset)
 {
-    for (int i = 0; i < numSectors; i++) {
-	ASSERT(freeMap->Test((int) dataSectors[i]));  // ought to be marked!
-	freeMap->Clear((int) dataSectors[i]);
+    int i = offset / SectorSize;
+    int sector = dataSectors[i] & ~MayBeShared;
+    int fresh;
+
+    ASSERT(!IsCompressed());
+    if (freeMap->IsShared(sector)) {
+	if ((fresh = freeMap->Find()) == -1)
+	    return FALSE;
+	freeMap->Release(sector);
+	sector = fresh;
     }
+    dataSectors[i] = sector;		// it's all ours now
+    return TRUE;
+}
+
+//----------------------------------------------------------------------
+// FileHeader::IsCompressed
+// 	Return TRUE if this is a compressed file.
+//----------------------------------------------------------------------
+
+bool
+FileHeader::IsCompressed()
+{
+    return (numBytes & CompressedFile) != 0;
+}
+
+//----------------------------------------------------------------------
+// FileHeader::BlockLength
+// 	Return the number of bytes in block "block" of a compressed file:
+//	BlockSize, except perhaps for the last one.
+//----------------------------------------------------------------------
+
+int
+FileHeader::BlockLength(int block)
+{
+    return min(BlockSize, FileLength() - block * BlockSize);
+}
+
+//----------------------------------------------------------------------
+// FileHeader::BlockSectors
+// 	Return the number of sectors holding block "block" of a
+//	compressed file, from the block map: 0 if it is all zeros, and
+//	divRoundUp(BlockLength(block), SectorSize) if it is stored as it
+//	is, rather than compressed.
+//----------------------------------------------------------------------
+
+int
+FileHeader::BlockSectors(int block)
+{
+    ASSERT(IsCompressed() && (block < MaxBlocks));
+    return (numSectors >> (block * BlockMapBits)) & ((1 << BlockMapBits) - 1);
+}
+
+//----------------------------------------------------------------------
+// FileHeader::BlockStart
+// 	Return where in dataSectors the sectors of block "block" start.
+//----------------------------------------------------------------------
+
+int
+FileHeader::BlockStart(int block)
+{
+    int start = 0;
+
+    for (int i = 0; i < block; i++)
+	start += BlockSectors(i);
+    return start;
+}
+
+//----------------------------------------------------------------------
+// FileHeader::BlockMayShare
+// 	Return TRUE if any of the sectors of block "block" might be
+//	shared with a clone of this file.
+//----------------------------------------------------------------------
+
+bool
+FileHeader::BlockMayShare(int block)
+{
+    int start = BlockStart(block);
+    int count = BlockSectors(block);
+
+    for (int i = start; i < start + count; i++)
+	if (dataSectors[i] & MayBeShared)
+	    return TRUE;
+    return FALSE;
+}
+
+//----------------------------------------------------------------------
+// FileHeader::SetBlock
+// 	Get ready to write block "block" of a compressed file, in "count"
+//	sectors: give up the sectors it has now (leaving any that are
+//	shared to the clones sharing them), and allocate "count" new ones.
+//	The caller must then write all of them, and write this header back
+//	to disk.  Return FALSE, changing nothing, if there isn't room.
+//
+//	"freeMap" is the bit map of free disk sectors
+//	"block" is the block about to be written
+//	"count" is how many sectors it will take; 0 if it is all zeros
+//----------------------------------------------------------------------
+
+bool
+FileHeader::SetBlock(FreeMap *freeMap, int block, int count)
+{
+    int start = BlockStart(block);
+    int old = BlockSectors(block);
+    int total = DataSectors();
+    int shift = block * BlockMapBits;
+    int i, sector, reclaimed = 0;
+
+    ASSERT((count >= 0)
+		&& (count <= divRoundUp(BlockLength(block), SectorSize)));
+    for (i = start; i < start + old; i++) {
+	sector = dataSectors[i] & ~MayBeShared;
+	if (!(dataSectors[i] & MayBeShared) || !freeMap->IsShared(sector))
+	    reclaimed++;
+    }
+    if (freeMap->NumClear() + reclaimed < count)
+	return FALSE;
+
+    for (i = start; i < start + old; i++)
+	if (dataSectors[i] & MayBeShared)
+	    freeMap->Release(dataSectors[i] & ~MayBeShared);
+	else
+	    freeMap->Clear(dataSectors[i]);
+    ASSERT(total - old + count <= (int) NumDirect);
+    if (count < old)			// move the later blocks' sectors
+	for (i = start + old; i < total; i++)
+	    dataSectors[i - old + count] = dataSectors[i];
+    else if (count > old)
+	for (i = total - 1; i >= start + old; i--)
+	    dataSectors[i - old + count] = dataSectors[i];
+    for (i = start; i < start + count; i++)
+	dataSectors[i] = freeMap->Find();
+    numSectors = (numSectors & ~(((1 << BlockMapBits) - 1) << shift))
+							| (count << shift);
+    return TRUE;
+}
+
+//----------------------------------------------------------------------
+// FileHeader::BlockToSector
+// 	Return the disk sector holding the "i"th sector of block "block"
+//	of a compressed file.
+//----------------------------------------------------------------------
+
+int
+FileHeader::BlockToSector(int block, int i)
+{
+    ASSERT(i < BlockSectors(block));
+    return dataSectors[BlockStart(block) + i] & ~MayBeShared;
+}
+
+//----------------------------------------------------------------------
+// FileHeader::ReadBlock
+// 	Read block "block" of a compressed file from disk, and decompress
+//	it into "into", which must have room for BlockSize bytes.
+//----------------------------------------------------------------------
+
+void
+FileHeader::ReadBlock(int block, char *into)
+{
+    int length = BlockLength(block);
+    int count = BlockSectors(block);
+    int sectors[BlockSize / SectorSize];
+    char *buf;
+    int i, size, numDecompressed;
+
+    if (count == 0) {			// a hole
+	bzero(into, length);
+	return;
+    }
+    for (i = 0; i < count; i++)
+	sectors[i] = BlockToSector(block, i);
+    if (count == divRoundUp(length, SectorSize)) {	// stored as it is
+	synchDisk->ReadSectors(count, sectors, into);
+	return;
+    }
+    buf = new char[count * SectorSize];
+    synchDisk->ReadSectors(count, sectors, buf);
+    size = (unsigned char) buf[0] | ((unsigned char) buf[1] << 8);
+    numDecompressed = DecompressBlock(&buf[2], size, into, length);
+    ASSERT(numDecompressed == length);
+    delete [] buf;
 }
 
 //----------------------------------------------------------------------
@@ -106,7 +364,8 @@ FileHeader::WriteBack(int sector)
 int
 FileHeader::ByteToSector(int offset)
 {
-    return(dataSectors[offset / SectorSize]);
+    ASSERT(!IsCompressed());
+    return(dataSectors[offset / SectorSize] & ~MayBeShared);
 }
 
 //----------------------------------------------------------------------
@@ -117,34 +376,81 @@ FileHeader::ByteToSector(int offset)
 int
 FileHeader::FileLength()
 {
-    return numBytes;
+    return numBytes & ~CompressedFile;
+}
+
+//----------------------------------------------------------------------
+// FileHeader::DataSectors
+// 	Return the number of sectors holding the file's data.
+//----------------------------------------------------------------------
+
+int
+FileHeader::DataSectors()
+{
+    int total = 0;
+
+    if (!IsCompressed())
+	return numSectors;
+    for (int i = 0; i < MaxBlocks; i++)
+	total += BlockSectors(i);
+    return total;
+}
+
+//----------------------------------------------------------------------
+// PrintData
+// 	Print "size" bytes of file data, on one line.
+//----------------------------------------------------------------------
+
+static void
+PrintData(char *data, int size)
+{
+    for (int j = 0; j < size; j++) {
+	if ('\040' <= data[j] && data[j] <= '\176')   // isprint(data[j])
+	    printf("%c", data[j]);
+	else
+	    printf("\\%x", (unsigned char)data[j]);
+    }
+    printf("\n"); 
 }
 
 //----------------------------------------------------------------------
 // FileHeader::Print
 // 	Print the contents of the file header, and the contents of all
-//	the data blocks pointed to by the file header.
+//	the data blocks pointed to by the file header.  A compressed
+//	file's contents are printed as they are, uncompressed.
 //----------------------------------------------------------------------
 
 void
 FileHeader::Print()
 {
-    int i, j, k;
-    char *data = new char[SectorSize];
+    int total = DataSectors(), length = FileLength();
+    int i;
+    char *data;
 
-    printf("FileHeader contents.  File size: %d.  File blocks:\n", numBytes);
-    for (i = 0; i < numSectors; i++)
-	printf("%d ", dataSectors[i]);
+    printf("FileHeader contents.  File size: %d%s.  File blocks:\n", length,
+	IsCompressed() ? ", compressed" : "");
+    for (i = 0; i < total; i++)
+	printf((dataSectors[i] & MayBeShared) ? "%d* " : "%d ",
+	    dataSectors[i] & ~MayBeShared);
+    if (IsCompressed()) {
+	printf("\nSectors in each block:\n");
+	for (i = 0; i < divRoundUp(length, BlockSize); i++)
+	    printf("%d ", BlockSectors(i));
+    }
     printf("\nFile contents:\n");
-    for (i = k = 0; i < numSectors; i++) {
-	synchDisk->ReadSector(dataSectors[i], data);
-        for (j = 0; (j < SectorSize) && (k < numBytes); j++, k++) {
-	    if ('\040' <= data[j] && data[j] <= '\176')   // isprint(data[j])
-		printf("%c", data[j]);
-            else
-		printf("\\%x", (unsigned char)data[j]);
+    if (IsCompressed()) {
+	data = new char[BlockSize];
+	for (i = 0; i < length; i += SectorSize) {
+	    if ((i % BlockSize) == 0)
+		ReadBlock(i / BlockSize, data);
+	    PrintData(&data[i % BlockSize], min(SectorSize, length - i));
+	}
+    } else {
+	data = new char[SectorSize];
+	for (i = 0; i < total; i++) {
+	    synchDisk->ReadSector(dataSectors[i] & ~MayBeShared, data);
+	    PrintData(data, min(SectorSize, length - i * SectorSize));
 	}
-        printf("\n"); 
     }
     delete [] data;
 }
@@ -15,11 +15,22 @@
 #define FILEHDR_H
 
 #include "disk.h"
-#include "bitmap.h"
+#include "freemap.h"
 
 #define NumDirect 	((SectorSize - 2 * sizeof(int)) / sizeof(int))
 #define MaxFileSize 	(NumDirect * SectorSize)
 
+#define MayBeShared	0x40000000	// set in a data sector number, if
+					// the sector may be shared with a
+					// clone of the file
+
+#define CompressedFile	0x40000000	// set in numBytes, if the file's
+					// data is compressed
+#define BlockSize	(8 * SectorSize)	// a compressed file's data is
+					// compressed this much at a time
+#define MaxBlocks	((int) divRoundUp(MaxFileSize, BlockSize))
+#define BlockMapBits	4		// bits per block in the block map
+
 // The following class defines the Nachos "file header" (in UNIX terms,  
 // the "i-node"), describing where on disk to find all of the data in the file.
 // The file header is organized as a simple table of pointers to
@@ -34,14 +45,46 @@
 // There is no constructor; rather the file header can be initialized
 // by allocating blocks for the file (if it is a new file), or by
 // reading it from disk.
+//
+// A clone of a file starts with a copy of its header, and the two share
+// all their data sectors, each marked MayBeShared in both headers.
+// Before either writes to one of them, Unshare gives it a sector of its
+// own (unless the other has already done so).
+//
+// A compressed file is divided into blocks of BlockSize bytes, each of
+// which is compressed separately (see compress.h) into as few sectors
+// as it will go.  In place of numSectors, its header keeps a block map:
+// for each block, in BlockMapBits bits, the number of sectors holding
+// it, or 0 if it is all zeros.  dataSectors lists the sectors of each
+// block in turn.  A block that doesn't compress by at least a sector is
+// stored as it is, in as many sectors as it would take uncompressed;
+// otherwise its first two bytes give the size it compresses to.
+// The length of a file, compressed or not, is still at most MaxFileSize.
 
 class FileHeader {
   public:
-    bool Allocate(BitMap *bitMap, int fileSize);// Initialize a file header, 
+    bool Allocate(BitMap *bitMap, int fileSize,
+		bool compressed = FALSE);	// Initialize a file header, 
 						//  including allocating space 
 						//  on disk for the file data
-    void Deallocate(BitMap *bitMap);  		// De-allocate this file's 
+    void Deallocate(FreeMap *freeMap);  	// De-allocate this file's 
 						//  data blocks
+    bool Share(FreeMap *freeMap);		// Share all the data blocks
+						//  with a clone of this file
+    bool MayShare(int offset);			// Is the block holding the
+						//  byte at "offset" shared?
+    bool Unshare(FreeMap *freeMap, int offset);	// Give this file a block
+						//  of its own there
+
+    bool IsCompressed();			// Is the data compressed?
+    int BlockLength(int block);			// Bytes in a block, and
+    int BlockSectors(int block);		//  sectors holding it now
+    bool BlockMayShare(int block);		// Might they be shared?
+    bool SetBlock(FreeMap *freeMap, int block, int count);
+						// Give a block "count" new
+						//  sectors of its own
+    int BlockToSector(int block, int i);	// Where its "i"th sector is
+    void ReadBlock(int block, char *into);	// Read and decompress it
 
     void FetchFrom(int sectorNumber); 	// Initialize file header from disk
     void WriteBack(int sectorNumber); 	// Write modifications to file header
@@ -53,14 +96,20 @@ class FileHeader {
 
     int FileLength();			// Return the length of the file 
 					// in bytes
+    int DataSectors();			// Return how many sectors hold
+					// its data
 
     void Print();			// Print the contents of the file.
 
   private:
     int numBytes;			// Number of bytes in the file
-    int numSectors;			// Number of data sectors in the file
+    int numSectors;			// Number of data sectors in the file,
+					// or for a compressed one, its
+					// block map
     int dataSectors[NumDirect];		// Disk sector numbers for each data 
 					// block in the file
+
+    int BlockStart(int block);		// Where its sectors are listed
 };
 
 #endif // FILEHDR_H
@@ -10,7 +10,8 @@
 //	   An entry in the file system directory
 //
 // 	The file system consists of several data structures:
-//	   A bitmap of free disk sectors (cf. bitmap.h)
+//	   A bitmap of free disk sectors, with a count of the files
+//		sharing each one (cf. freemap.h)
 //	   A directory of file names and file headers
 //
 //      Both the bitmap and the directory are represented as normal
@@ -46,7 +47,7 @@
 #include "copyright.h"
 
 #include "disk.h"
-#include "bitmap.h"
+#include "freemap.h"
 #include "directory.h"
 #include "filehdr.h"
 #include "filesys.h"
@@ -59,8 +60,9 @@
 
 // Initial file sizes for the bitmap and directory; until the file system
 // supports extensible files, the directory size sets the maximum number 
-// of files that can be loaded onto the disk.
-#define FreeMapFileSize 	(NumSectors / BitsInByte)
+// of files that can be loaded onto the disk.  The free map file holds
+// the bitmap, and then a byte per sector counting its extra sharers.
+#define FreeMapFileSize 	(NumSectors / BitsInByte + NumSectors)
 #define NumDirEntries 		10
 #define DirectoryFileSize 	(sizeof(DirectoryEntry) * NumDirEntries)
 
@@ -81,7 +83,7 @@ FileSystem::FileSystem(bool format)
 { 
     DEBUG('f', "Initializing the file system.\n");
     if (format) {
-        BitMap *freeMap = new BitMap(NumSectors);
+        FreeMap *freeMap = new FreeMap(NumSectors);
         Directory *directory = new Directory(NumDirEntries);
 	FileHeader *mapHdr = new FileHeader;
 	FileHeader *dirHdr = new FileHeader;
@@ -146,7 +148,9 @@ FileSystem::FileSystem(bool format)
 // FileSystem::Create
 // 	Create a file in the Nachos file system (similar to UNIX create).
 //	Since we can't increase the size of files dynamically, we have
-//	to give Create the initial size of the file.
+//	to give Create the initial size of the file.  A compressed file
+//	(see filehdr.h) starts out all zeros, and gets sectors for its
+//	data only as it is written.
 //
 //	The steps to create a file are:
 //	  Make sure the file doesn't already exist
@@ -169,18 +173,20 @@ FileSystem::FileSystem(bool format)
 //
 //	"name" -- name of file to be created
 //	"initialSize" -- size of file to be created
+//	"compressed" -- TRUE if its data is to be compressed
 //----------------------------------------------------------------------
 
 bool
-FileSystem::Create(char *name, int initialSize)
+FileSystem::Create(char *name, int initialSize, bool compressed)
 {
     Directory *directory;
-    BitMap *freeMap;
+    FreeMap *freeMap;
     FileHeader *hdr;
     int sector;
     bool success;
 
-    DEBUG('f', "Creating file %s, size %d\n", name, initialSize);
+    DEBUG('f', "Creating file %s, size %d%s\n", name, initialSize,
+	compressed ? ", compressed" : "");
 
     directory = new Directory(NumDirEntries);
     directory->FetchFrom(directoryFile);
@@ -188,7 +194,7 @@ FileSystem::Create(char *name, int initialSize)
     if (directory->Find(name) != -1)
       success = FALSE;			// file is already in directory
     else {	
-        freeMap = new BitMap(NumSectors);
+        freeMap = new FreeMap(NumSectors);
         freeMap->FetchFrom(freeMapFile);
         sector = freeMap->Find();	// find a sector to hold the file header
     	if (sector == -1) 		
@@ -197,7 +203,7 @@ FileSystem::Create(char *name, int initialSize)
             success = FALSE;	// no space in directory
 	else {
     	    hdr = new FileHeader;
-	    if (!hdr->Allocate(freeMap, initialSize))
+	    if (!hdr->Allocate(freeMap, initialSize, compressed))
             	success = FALSE;	// no space on disk for data
 	    else {	
 	    	success = TRUE;
@@ -240,6 +246,148 @@ FileSystem::Open(char *name)
     return openFile;				// return NULL if not found
 }
 
+//----------------------------------------------------------------------
+// FileSystem::Clone
+// 	Make the file "to" a copy of the file "from", without copying any
+//	data: the new file gets a header of its own, pointing at the same
+//	data blocks as the original, and the two share them until one or
+//	the other writes to each (see OpenFile::WriteAt).  So a clone
+//	costs a few sectors of file system metadata, however big the file.
+//
+//	As with Remove, there is no check that "from" isn't open; a file
+//	opened before it was cloned doesn't know its blocks are shared,
+//	and would write over the clone's data.
+//
+//	Return TRUE if everything goes ok, otherwise, return FALSE.
+//
+// 	Clone fails if:
+//		"from" isn't in the directory, or "to" is
+//	 	no free space for the new file header
+//	 	no free entry for the new file in the directory
+//		some block of "from" is already shared by too many clones
+//		the disk was formatted before the free map kept counts
+//
+//	"from" -- name of the file to be cloned
+//	"to" -- name of the new file
+//----------------------------------------------------------------------
+
+bool
+FileSystem::Clone(char *from, char *to)
+{
+    Directory *directory;
+    FreeMap *freeMap;
+    FileHeader *hdr;
+    int fromSector, sector;
+    bool success = FALSE;
+
+    DEBUG('f', "Cloning file %s to %s\n", from, to);
+
+    if (freeMapFile->Length() < FreeMapFileSize) {
+	DEBUG('f', "No sharing counts on this disk; it must be reformatted\n");
+	return FALSE;
+    }
+    directory = new Directory(NumDirEntries);
+    directory->FetchFrom(directoryFile);
+    fromSector = directory->Find(from);
+    if ((fromSector != -1) && (directory->Find(to) == -1)) {
+	freeMap = new FreeMap(NumSectors);
+	freeMap->FetchFrom(freeMapFile);
+	hdr = new FileHeader;
+	hdr->FetchFrom(fromSector);
+	sector = freeMap->Find();	// find a sector for the new header
+	if ((sector != -1) && directory->Add(to, sector)
+					&& hdr->Share(freeMap)) {
+	    success = TRUE;
+	    hdr->WriteBack(fromSector);	// the original shares them now too
+	    hdr->WriteBack(sector);
+	    directory->WriteBack(directoryFile);
+	    freeMap->WriteBack(freeMapFile);
+	}
+	delete hdr;
+	delete freeMap;
+    }
+    delete directory;
+    return success;
+}
+
+//----------------------------------------------------------------------
+// FileSystem::Unshare
+// 	Get the file with header "hdr" ready to write "numBytes" bytes at
+//	"position": give it a block of its own for each one in the range
+//	that it still shares with a clone.  The caller must then write all
+//	of those blocks.  Return FALSE, changing nothing, if there isn't
+//	room on the disk for them.
+//
+//	"hdr" -- the file's header, in memory
+//	"hdrSector" -- where it goes on disk
+//	"position", "numBytes" -- the range about to be written
+//----------------------------------------------------------------------
+
+bool
+FileSystem::Unshare(FileHeader *hdr, int hdrSector, int position,
+								int numBytes)
+{
+    FreeMap *freeMap = new FreeMap(NumSectors);
+    int first = divRoundDown(position, SectorSize);
+    int last = divRoundDown(position + numBytes - 1, SectorSize);
+    int i, needed = 0;
+    bool success = FALSE;
+
+    freeMap->FetchFrom(freeMapFile);
+    for (i = first; i <= last; i++)
+	if (hdr->MayShare(i * SectorSize)
+		&& freeMap->IsShared(hdr->ByteToSector(i * SectorSize)))
+	    needed++;
+    DEBUG('f', "Unsharing %d blocks, for header at %d\n", needed, hdrSector);
+    if (freeMap->NumClear() >= needed) {
+	success = TRUE;
+	for (i = first; i <= last; i++)
+	    if (hdr->MayShare(i * SectorSize))
+		ASSERT(hdr->Unshare(freeMap, i * SectorSize));
+	hdr->WriteBack(hdrSector);
+	freeMap->WriteBack(freeMapFile);
+    }
+    delete freeMap;
+    return success;
+}
+
+//----------------------------------------------------------------------
+// FileSystem::ReallocateBlock
+// 	Get block "block" of the compressed file with header "hdr" ready
+//	to be written, in "numSectors" sectors.  If it is already that
+//	size, in sectors no clone shares, it can be written where it is,
+//	and nothing needs to change on disk; otherwise it gets new sectors
+//	(see FileHeader::SetBlock), and the caller must write all of them.
+//	Return FALSE, changing nothing, if there isn't room on the disk.
+//
+//	"hdr" -- the file's header, in memory
+//	"hdrSector" -- where it goes on disk
+//	"block" -- the block about to be written
+//	"numSectors" -- how many sectors it will take
+//----------------------------------------------------------------------
+
+bool
+FileSystem::ReallocateBlock(FileHeader *hdr, int hdrSector, int block,
+								int numSectors)
+{
+    FreeMap *freeMap;
+    bool success;
+
+    if ((hdr->BlockSectors(block) == numSectors) && !hdr->BlockMayShare(block))
+	return TRUE;
+    DEBUG('f', "Block %d of header at %d now takes %d sectors, not %d\n",
+	block, hdrSector, numSectors, hdr->BlockSectors(block));
+    freeMap = new FreeMap(NumSectors);
+    freeMap->FetchFrom(freeMapFile);
+    success = hdr->SetBlock(freeMap, block, numSectors);
+    if (success) {
+	hdr->WriteBack(hdrSector);
+	freeMap->WriteBack(freeMapFile);
+    }
+    delete freeMap;
+    return success;
+}
+
 //----------------------------------------------------------------------
 // FileSystem::Remove
 // 	Delete a file from the file system.  This requires:
@@ -258,7 +406,7 @@ bool
 FileSystem::Remove(char *name)
 { 
     Directory *directory;
-    BitMap *freeMap;
+    FreeMap *freeMap;
     FileHeader *fileHdr;
     int sector;
     
@@ -272,7 +420,7 @@ FileSystem::Remove(char *name)
     fileHdr = new FileHeader;
     fileHdr->FetchFrom(sector);
 
-    freeMap = new BitMap(NumSectors);
+    freeMap = new FreeMap(NumSectors);
     freeMap->FetchFrom(freeMapFile);
 
     fileHdr->Deallocate(freeMap);  		// remove data blocks
@@ -317,7 +465,7 @@ FileSystem::Print()
 {
     FileHeader *bitHdr = new FileHeader;
     FileHeader *dirHdr = new FileHeader;
-    BitMap *freeMap = new BitMap(NumSectors);
+    FreeMap *freeMap = new FreeMap(NumSectors);
     Directory *directory = new Directory(NumDirEntries);
 
     printf("Bit map file header:\n");
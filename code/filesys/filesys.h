@@ -45,7 +45,7 @@ class FileSystem {
   public:
     FileSystem(bool format) {}
 
-    bool Create(char *name, int initialSize) { 
+    bool Create(char *name, int initialSize, bool compressed = FALSE) { 
 	int fileDescriptor = OpenForWrite(name);
 
 	if (fileDescriptor == -1) return FALSE;
@@ -65,6 +65,8 @@ class FileSystem {
 };
 
 #else // FILESYS
+class FileHeader;
+
 class FileSystem {
   public:
     FileSystem(bool format);		// Initialize the file system.
@@ -74,13 +76,23 @@ class FileSystem {
 					// the disk, so initialize the directory
     					// and the bitmap of free blocks.
 
-    bool Create(char *name, int initialSize);  	
-					// Create a file (UNIX creat)
+    bool Create(char *name, int initialSize, bool compressed = FALSE);
+					// Create a file (UNIX creat),
+					// perhaps a compressed one
 
     OpenFile* Open(char *name); 	// Open a file (UNIX open)
 
     bool Remove(char *name);  		// Delete a file (UNIX unlink)
 
+    bool Clone(char *from, char *to);	// Make "to" a copy of "from",
+					// sharing its data until written
+    bool Unshare(FileHeader *hdr, int hdrSector, int position,
+		int numBytes);		// Give a file blocks of its own,
+					// before writing to a range of it
+    bool ReallocateBlock(FileHeader *hdr, int hdrSector, int block,
+		int numSectors);	// Give a block of a compressed
+					// file new sectors to be written to
+
     void List();			// List all the files in the file system
 
     void Print();			// List all the files and their contents
@@ -0,0 +1,183 @@
+// freemap.cc
+//	Routines to manage the map of free disk sectors, and the count
+//	of files sharing each sector that is in use.
+//
+// Copyright (c) 1992-1993 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#include "copyright.h"
+#include "freemap.h"
+#include <strings.h>
+
+// The state of each sector's worth of counts
+enum { CountsUnread, CountsClean, CountsDirty };
+
+//----------------------------------------------------------------------
+// FreeMap::FreeMap
+// 	Initialize a free map with "nitems" sectors, all free and none
+//	shared.  Unless FetchFrom replaces them, the counts are written
+//	out by WriteBack, so a freshly formatted disk starts with none.
+//
+//	"nitems" is the number of sectors on the disk.
+//----------------------------------------------------------------------
+
+FreeMap::FreeMap(int nitems) : BitMap(nitems)
+{
+    numSectors = nitems;
+    countsOffset = divRoundUp(nitems, BitsInWord) * sizeof(unsigned int);
+    counts = new unsigned char[nitems];
+    bzero(counts, nitems);
+    numChunks = divRoundUp(nitems, SectorSize);
+    chunkState = new char[numChunks];
+    for (int i = 0; i < numChunks; i++)
+	chunkState[i] = CountsDirty;
+    mapFile = NULL;
+}
+
+FreeMap::~FreeMap()
+{
+    delete [] counts;
+    delete [] chunkState;
+}
+
+//----------------------------------------------------------------------
+// FreeMap::FetchFrom
+// 	Read the bitmap from the free map file, and remember where to
+//	find the counts, if we turn out to need them.
+//
+//	"file" is the free map file
+//----------------------------------------------------------------------
+
+void
+FreeMap::FetchFrom(OpenFile *file)
+{
+    BitMap::FetchFrom(file);
+    mapFile = file;
+    for (int i = 0; i < numChunks; i++)
+	chunkState[i] = CountsUnread;
+}
+
+//----------------------------------------------------------------------
+// FreeMap::FetchCounts
+// 	Read the sector's worth of counts holding the count for sector
+//	"which", the first time it is needed.  A free map file too short
+//	to hold them (from a disk formatted before there were clones) has
+//	no sharing in it.
+//----------------------------------------------------------------------
+
+void
+FreeMap::FetchCounts(int which)
+{
+    int chunk = which / SectorSize;
+    int start = chunk * SectorSize;
+
+    if (chunkState[chunk] != CountsUnread)
+	return;
+    bzero(counts + start, min(SectorSize, numSectors - start));
+    mapFile->ReadAt((char *) counts + start,
+	min(SectorSize, numSectors - start), countsOffset + start);
+    chunkState[chunk] = CountsClean;
+}
+
+//----------------------------------------------------------------------
+// FreeMap::CountChanged
+// 	Note that the count for sector "which" has to be written back.
+//----------------------------------------------------------------------
+
+void
+FreeMap::CountChanged(int which)
+{
+    chunkState[which / SectorSize] = CountsDirty;
+}
+
+//----------------------------------------------------------------------
+// FreeMap::WriteBack
+// 	Write the bitmap back to the free map file, and any counts that
+//	have changed.
+//
+//	"file" is the free map file
+//----------------------------------------------------------------------
+
+void
+FreeMap::WriteBack(OpenFile *file)
+{
+    int start;
+
+    BitMap::WriteBack(file);
+    for (int i = 0; i < numChunks; i++)
+	if (chunkState[i] == CountsDirty) {
+	    start = i * SectorSize;
+	    file->WriteAt((char *) counts + start,
+		min(SectorSize, numSectors - start), countsOffset + start);
+	    chunkState[i] = CountsClean;
+	}
+}
+
+//----------------------------------------------------------------------
+// FreeMap::Share
+// 	Note that another file is using sector "which", which must be in
+//	use already.  Return FALSE, changing nothing, if it already has
+//	as many sharers as we can count.
+//----------------------------------------------------------------------
+
+bool
+FreeMap::Share(int which)
+{
+    ASSERT(Test(which));
+    FetchCounts(which);
+    if (counts[which] == MaxShares)
+	return FALSE;
+    counts[which]++;
+    CountChanged(which);
+    return TRUE;
+}
+
+//----------------------------------------------------------------------
+// FreeMap::Release
+// 	Note that a file has stopped using sector "which"; if no file is
+//	using it any more, it is free.
+//----------------------------------------------------------------------
+
+void
+FreeMap::Release(int which)
+{
+    ASSERT(Test(which));		// ought to be marked!
+    FetchCounts(which);
+    if (counts[which] > 0) {
+	counts[which]--;
+	CountChanged(which);
+    } else
+	Clear(which);
+}
+
+//----------------------------------------------------------------------
+// FreeMap::IsShared
+// 	Return TRUE if more than one file is using sector "which".
+//----------------------------------------------------------------------
+
+bool
+FreeMap::IsShared(int which)
+{
+    FetchCounts(which);
+    return counts[which] > 0;
+}
+
+//----------------------------------------------------------------------
+// FreeMap::Print
+// 	Print the sectors in use, and then those that are shared, with
+//	how many files are using each.
+//----------------------------------------------------------------------
+
+void
+FreeMap::Print()
+{
+    BitMap::Print();
+    printf("Shared sectors:\n");
+    for (int i = 0; i < numSectors; i++) {
+	FetchCounts(i);
+	if (counts[i] > 0)
+	    printf("%d (%d files), ", i, counts[i] + 1);
+    }
+    printf("\n");
+}
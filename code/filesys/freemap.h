@@ -0,0 +1,63 @@
+// freemap.h
+//	Data structures for keeping track of which disk sectors are in
+//	use, and by how many files.
+//
+//	A sector is normally in use by one file, or free, which is all
+//	a bitmap can say.  But a clone of a file (see FileSystem::Clone)
+//	shares its data sectors with the original until one of them
+//	writes to each, so the free map also keeps, for every sector,
+//	how many files beyond the first are using it.  On disk, the
+//	counts follow the bitmap in the free map file, one byte per
+//	sector.
+//
+//	Most operations never touch a shared sector, so the counts are
+//	only read from disk when they are asked for, a sector's worth at
+//	a time, and only the sectors of them that changed are written back.
+//
+// Copyright (c) 1992-1993 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#ifndef FREEMAP_H
+#define FREEMAP_H
+
+#include "copyright.h"
+#include "bitmap.h"
+#include "disk.h"
+
+#define MaxShares	255	// most files beyond the first that can
+				// share a sector
+
+// The following class defines the map of free disk sectors: a bitmap,
+// with a count of sharers for each sector.
+
+class FreeMap : public BitMap {
+  public:
+    FreeMap(int nitems);	// Initialize a map of "nitems" free sectors
+    ~FreeMap();
+
+    bool Share(int which);	// One more file uses sector "which";
+				// FALSE if too many do already
+    void Release(int which);	// One fewer does; free it if none do
+    bool IsShared(int which);	// Is it used by more than one file?
+
+    void Print();		// Print which sectors are used, and shared
+
+    void FetchFrom(OpenFile *file); 	// fetch the bitmap from disk
+    void WriteBack(OpenFile *file); 	// write it, and any changed
+					// counts, back
+
+  private:
+    int numSectors;
+    int countsOffset;		// where the counts are in the file
+    unsigned char *counts;	// files beyond the first using each sector
+    int numChunks;		// sectors' worth of counts
+    char *chunkState;		// for each, CountsUnread, -Clean or -Dirty
+    OpenFile *mapFile;		// where to read them from
+
+    void FetchCounts(int which);	// read in the count for sector
+					// "which", if we haven't
+    void CountChanged(int which);	// it needs writing back
+};
+
+#endif // FREEMAP_H
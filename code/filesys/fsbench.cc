@@ -0,0 +1,776 @@
+// fsbench.cc
+//	A suite of benchmarks for the Nachos file system, to go further
+//	than PerformanceTest in fstest.cc:
+//
+//	   seqwrite, seqread -- sequential transfers, at several sizes
+//	   randwrite, randread -- transfers at random offsets
+//	   queuedread -- reads of random sectors, made straight of the
+//		SynchDisk with several in flight at once: each is
+//		Submitted with a callback, which times it, and WaitAny
+//		finds one that is done, to make the next in its place
+//	   create, stat, delete -- storms of small-file operations
+//	   dirscan -- lookups of names that aren't there, which have to
+//		read and search the whole directory
+//	   mixed -- several threads at once, reading and writing
+//		their own files at random
+//	   freshread, agedread -- a sequential read of a file made on an
+//		empty disk, and of one made once the disk has been aged
+//		by a long run of creates and deletes, leaving its free
+//		space fragmented
+//	   copy, clone -- duplicating a file by reading it and writing a
+//		new one, and by cloning it (FileSystem::Clone)
+//	   cowwrite -- writes to each sector of a clone, each of which
+//		first gives the clone a sector of its own
+//	   write, read, zwrite, zread -- writing and reading whole files,
+//		plain and compressed (see filehdr.h), a sector at a time:
+//		the C sources of the test programs, and the data that
+//		PerformanceTest writes
+//
+//	Each benchmark prints one line of JSON, starting with "{", with
+//	the number of operations it timed and the bytes they moved, the
+//	simulated time they took and the resulting throughput (a tick is
+//	a microsecond), the latency of an operation at the 50th, 90th
+//	and 99th percentiles and at worst (in ticks), the disk reads and
+//	writes, and the host time, in milliseconds.  The compression
+//	benchmarks also say which data they used, and how many sectors
+//	it took on disk.
+//
+//	Everything fits the file system as it comes: files no bigger
+//	than MaxFileSize, whose size is fixed when they are created, and
+//	no more than ten of them at once.  Each benchmark removes the
+//	files it makes.  Run the suite on a freshly formatted disk, with
+//	"nachos -f -bench".
+//
+// Copyright (c) 1992-1993 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#include "copyright.h"
+
+#include "utility.h"
+#include "filesys.h"
+#include "directory.h"
+#include "filehdr.h"
+#include "system.h"
+#include "synch.h"
+
+#define MaxOps		1024	// most operations one benchmark can time
+#define BenchFileSize	3072	// bytes in the files we read and write
+#define NumRandomOps	200	// transfers by randread and randwrite,
+				// and reads by queuedread
+#define QueueDepth	4	// reads queuedread keeps in flight
+#define StormFiles	8	// files created at once by the storms
+#define StormRounds	5
+#define SmallFileSize	256
+#define MixedThreads	4
+#define MixedOps	100	// transfers by each thread in mixed
+#define MixedTransfer	128
+#define AgingRounds	300	// creates and deletes to age the disk
+#define AgingFiles	8	// most of their files alive at once
+#define TextDir		"../test/"	// where the test programs are
+#define PerfContents	"1234567890"	// what PerformanceTest writes
+
+// The following class defines the measurements of one benchmark:
+// how long each of its operations took, and what the whole run cost.
+
+class Measurement {
+  public:
+    Measurement(const char *benchName, int transferSize);
+					// start measuring
+    ~Measurement();
+
+    int Start();			// an operation starts
+    void Done(int started, int numBytes);	// and is done
+    void Describe(char *dataName, int numSectors);
+					// note what data was used, and
+					// how much space it took
+    void Report();			// print the results, as JSON
+
+  private:
+    const char *name;
+    char *data;			// what data was used, or NULL
+    int sectors;		// and how many sectors it took
+    int transfer;		// bytes per operation; 0 if not a transfer
+    int *latencies;		// of each operation, in ticks
+    int numOps;
+    int bytes;			// moved by all the operations
+    int inProgress;		// operations started and not yet done
+    int ticks;			// time with some operation in progress
+    int diskReads;		// and what the disk did in that time
+    int diskWrites;
+    int busyTicks;		// the state of things when inProgress
+    int busyReads;		// last went from 0 to 1
+    int busyWrites;
+    int startHost;
+};
+
+//----------------------------------------------------------------------
+// Measurement::Measurement
+// 	Start measuring a benchmark.
+//
+//	"benchName" -- what to call it in the results
+//	"transferSize" -- how many bytes each operation moves, or 0
+//----------------------------------------------------------------------
+
+Measurement::Measurement(const char *benchName, int transferSize)
+{
+    name = benchName;
+    data = NULL;
+    transfer = transferSize;
+    latencies = new int[MaxOps];
+    numOps = bytes = inProgress = 0;
+    ticks = diskReads = diskWrites = 0;
+    startHost = HostMilliseconds();
+}
+
+Measurement::~Measurement()
+{
+    delete [] latencies;
+}
+
+//----------------------------------------------------------------------
+// Measurement::Start
+// 	Note that an operation is starting, and return the time, to be
+//	passed to Done when it finishes.  Only time spent on the
+//	benchmark's own operations counts towards its totals, so several
+//	benchmarks can take turns, or threads can run operations at once.
+//----------------------------------------------------------------------
+
+int
+Measurement::Start()
+{
+    if (inProgress++ == 0) {
+	busyTicks = stats->totalTicks;
+	busyReads = stats->numDiskReads;
+	busyWrites = stats->numDiskWrites;
+    }
+    return stats->totalTicks;
+}
+
+//----------------------------------------------------------------------
+// Measurement::Done
+// 	Record an operation that has finished.
+//
+//	"started" -- what Start returned when it started
+//	"numBytes" -- how many bytes it moved
+//----------------------------------------------------------------------
+
+void
+Measurement::Done(int started, int numBytes)
+{
+    ASSERT((numOps < MaxOps) && (inProgress > 0));
+    latencies[numOps++] = stats->totalTicks - started;
+    bytes += numBytes;
+    if (--inProgress == 0) {
+	ticks += stats->totalTicks - busyTicks;
+	diskReads += stats->numDiskReads - busyReads;
+	diskWrites += stats->numDiskWrites - busyWrites;
+    }
+}
+
+//----------------------------------------------------------------------
+// Measurement::Describe
+// 	Note the data the benchmark used, and how many sectors it took
+//	on disk, to go in the results.
+//
+//	"dataName" -- what to call the data
+//	"numSectors" -- how many sectors it took
+//----------------------------------------------------------------------
+
+void
+Measurement::Describe(char *dataName, int numSectors)
+{
+    data = dataName;
+    sectors = numSectors;
+}
+
+//----------------------------------------------------------------------
+// Measurement::Report
+// 	Print what we measured as one line of JSON.  The latencies are
+//	sorted to find the percentiles.
+//----------------------------------------------------------------------
+
+void
+Measurement::Report()
+{
+    int i, j, latency;
+
+    for (i = 1; i < numOps; i++) {		// insertion sort
+	latency = latencies[i];
+	for (j = i; (j > 0) && (latencies[j - 1] > latency); j--)
+	    latencies[j] = latencies[j - 1];
+	latencies[j] = latency;
+    }
+
+    printf("{\"bench\": \"%s\", \"transfer\": %d, \"ops\": %d, \"bytes\": %d, "
+	"\"ticks\": %d, \"bytesPerSec\": %d, ", name, transfer, numOps, bytes,
+	ticks, (ticks > 0) ? (int) (bytes * 1000000.0 / ticks) : 0);
+    if (data != NULL)
+	printf("\"data\": \"%s\", \"sectors\": %d, ", data, sectors);
+    if (numOps > 0)
+	printf("\"p50\": %d, \"p90\": %d, \"p99\": %d, \"max\": %d, ",
+	    latencies[numOps * 50 / 100], latencies[numOps * 90 / 100],
+	    latencies[numOps * 99 / 100], latencies[numOps - 1]);
+    printf("\"diskReads\": %d, \"diskWrites\": %d, \"hostMs\": %d}\n",
+	diskReads, diskWrites, HostMilliseconds() - startHost);
+}
+
+//----------------------------------------------------------------------
+// MakeFile
+// 	Create a file and fill it, in one transfer.  Return it, open,
+//	or NULL if it couldn't be created.
+//----------------------------------------------------------------------
+
+static OpenFile *
+MakeFile(char *name, int size)
+{
+    OpenFile *file;
+    char *data;
+    int i;
+
+    if (!fileSystem->Create(name, size)
+		|| ((file = fileSystem->Open(name)) == NULL)) {
+	printf("Benchmark: can't create %s\n", name);
+	return NULL;
+    }
+    data = new char[size];
+    for (i = 0; i < size; i++)
+	data[i] = 'a' + i % 26;
+    file->WriteAt(data, size, 0);
+    delete [] data;
+    return file;
+}
+
+//----------------------------------------------------------------------
+// SequentialBench
+// 	Write a file from beginning to end, then read it back, "transfer"
+//	bytes at a time.
+//----------------------------------------------------------------------
+
+static void
+SequentialBench(int transfer)
+{
+    char *buffer = new char[transfer];
+    OpenFile *file;
+    int i, started;
+
+    if ((file = MakeFile("seqfile", BenchFileSize)) == NULL)
+	return;
+    bzero(buffer, transfer);
+
+    Measurement *writes = new Measurement("seqwrite", transfer);
+    for (i = 0; i < BenchFileSize; i += transfer) {
+	started = writes->Start();
+	writes->Done(started, file->Write(buffer, transfer));
+    }
+    writes->Report();
+    delete writes;
+
+    file->Seek(0);
+    Measurement *reads = new Measurement("seqread", transfer);
+    for (i = 0; i < BenchFileSize; i += transfer) {
+	started = reads->Start();
+	reads->Done(started, file->Read(buffer, transfer));
+    }
+    reads->Report();
+    delete reads;
+
+    delete file;
+    fileSystem->Remove("seqfile");
+    delete [] buffer;
+}
+
+//----------------------------------------------------------------------
+// RandomBench
+// 	Write, then read, "transfer" bytes at a time at random (aligned)
+//	offsets in a file.
+//----------------------------------------------------------------------
+
+static void
+RandomBench(int transfer)
+{
+    char *buffer = new char[transfer];
+    OpenFile *file;
+    int i, started;
+
+    if ((file = MakeFile("randfile", BenchFileSize)) == NULL)
+	return;
+    bzero(buffer, transfer);
+
+    Measurement *writes = new Measurement("randwrite", transfer);
+    for (i = 0; i < NumRandomOps; i++) {
+	started = writes->Start();
+	writes->Done(started, file->WriteAt(buffer, transfer,
+		(Random() % (BenchFileSize / transfer)) * transfer));
+    }
+    writes->Report();
+    delete writes;
+
+    Measurement *reads = new Measurement("randread", transfer);
+    for (i = 0; i < NumRandomOps; i++) {
+	started = reads->Start();
+	reads->Done(started, file->ReadAt(buffer, transfer,
+		(Random() % (BenchFileSize / transfer)) * transfer));
+    }
+    reads->Report();
+    delete reads;
+
+    delete file;
+    fileSystem->Remove("randfile");
+    delete [] buffer;
+}
+
+//----------------------------------------------------------------------
+// QueuedBench
+// 	Read NumRandomOps random sectors, keeping QueueDepth requests in
+//	flight.  Each request's callback, run from the disk interrupt
+//	handler, records how long it took; we wait for any one to be
+//	done, and make another in its place.
+//----------------------------------------------------------------------
+
+static Measurement *queued;		// what QueuedBench is measuring
+static int queuedStarted[QueueDepth];	// when each slot's read was made
+
+static void
+QueuedDone(int slot)
+{
+    queued->Done(queuedStarted[slot], SectorSize);
+}
+
+static DiskRequest *
+QueuedRead(int slot, char *buffers)
+{
+    queuedStarted[slot] = queued->Start();
+    return synchDisk->Submit(Random() % NumSectors,
+		&buffers[slot * SectorSize], FALSE, QueuedDone, slot);
+}
+
+static void
+QueuedBench()
+{
+    DiskRequest *requests[QueueDepth];
+    char *buffers = new char[QueueDepth * SectorSize];
+    int slot, made;
+
+    queued = new Measurement("queuedread", SectorSize);
+    for (slot = 0; slot < QueueDepth; slot++)
+	requests[slot] = QueuedRead(slot, buffers);
+    for (made = QueueDepth; made < NumRandomOps; made++) {
+	slot = synchDisk->WaitAny(requests, QueueDepth);
+	delete requests[slot];
+	requests[slot] = QueuedRead(slot, buffers);
+    }
+    synchDisk->WaitAll(requests, QueueDepth);
+    for (slot = 0; slot < QueueDepth; slot++)
+	delete requests[slot];
+    queued->Report();			// one op for each callback
+    delete queued;
+    delete [] buffers;
+}
+
+//----------------------------------------------------------------------
+// StormBench
+// 	Over and over, create a batch of small files, look each one up
+//	and find its length (our "stat"), look up names that aren't
+//	there, and delete the files.
+//----------------------------------------------------------------------
+
+static void
+StormBench()
+{
+    Measurement *creates = new Measurement("create", 0);
+    Measurement *stat = new Measurement("stat", 0);
+    Measurement *scans = new Measurement("dirscan", 0);
+    Measurement *deletes = new Measurement("delete", 0);
+    OpenFile *file;
+    char name[FileNameMaxLen + 1];
+    int round, i, started, failed = 0;
+
+    for (round = 0; round < StormRounds; round++) {
+	for (i = 0; i < StormFiles; i++) {
+	    sprintf(name, "small%d", i);
+	    started = creates->Start();
+	    if (!fileSystem->Create(name, SmallFileSize))
+		failed++;
+	    creates->Done(started, 0);
+	}
+	for (i = 0; i < StormFiles; i++) {
+	    sprintf(name, "small%d", i);
+	    started = stat->Start();
+	    if ((file = fileSystem->Open(name)) == NULL)
+		failed++;
+	    else if (file->Length() != SmallFileSize)
+		failed++;
+	    delete file;
+	    stat->Done(started, 0);
+	}
+	for (i = 0; i < StormFiles; i++) {
+	    sprintf(name, "none%d", i);
+	    started = scans->Start();
+	    if ((file = fileSystem->Open(name)) != NULL) {
+		failed++;
+		delete file;
+	    }
+	    scans->Done(started, 0);
+	}
+	for (i = 0; i < StormFiles; i++) {
+	    sprintf(name, "small%d", i);
+	    started = deletes->Start();
+	    if (!fileSystem->Remove(name))
+		failed++;
+	    deletes->Done(started, 0);
+	}
+    }
+    if (failed > 0)
+	printf("Benchmark: %d small-file operations failed\n", failed);
+
+    creates->Report();
+    stat->Report();
+    scans->Report();
+    deletes->Report();
+    delete creates;
+    delete stat;
+    delete scans;
+    delete deletes;
+}
+
+//----------------------------------------------------------------------
+// MixedBench
+// 	Several threads at once, each reading (70% of the time) and
+//	writing (30%) its own file at random offsets, so that their
+//	requests queue up at the disk.
+//----------------------------------------------------------------------
+
+static Measurement *mixed;	// shared by the threads
+static OpenFile *mixedFiles[MixedThreads];
+static Semaphore *mixedDone;
+
+static void
+MixedWorker(int which)
+{
+    char buffer[MixedTransfer];
+    OpenFile *file = mixedFiles[which];
+    int i, offset, started;
+
+    for (i = 0; i < MixedOps; i++) {
+	offset = (Random() % (BenchFileSize / MixedTransfer)) * MixedTransfer;
+	started = mixed->Start();
+	if ((Random() % 10) < 7)
+	    mixed->Done(started, file->ReadAt(buffer, MixedTransfer, offset));
+	else
+	    mixed->Done(started, file->WriteAt(buffer, MixedTransfer, offset));
+    }
+    mixedDone->V();
+}
+
+static void
+MixedBench()
+{
+    char name[FileNameMaxLen + 1];
+    Thread *thread;
+    int i;
+
+    for (i = 0; i < MixedThreads; i++) {
+	sprintf(name, "mixed%d", i);
+	if ((mixedFiles[i] = MakeFile(name, BenchFileSize)) == NULL)
+	    return;
+    }
+    mixedDone = new Semaphore("mixed done", 0);
+
+    mixed = new Measurement("mixed", MixedTransfer);
+    for (i = 0; i < MixedThreads; i++) {
+	thread = new Thread("mixed worker");
+	thread->Fork(MixedWorker, i);
+    }
+    for (i = 0; i < MixedThreads; i++)
+	mixedDone->P();
+    mixed->Report();
+    delete mixed;
+
+    delete mixedDone;
+    for (i = 0; i < MixedThreads; i++) {
+	delete mixedFiles[i];
+	sprintf(name, "mixed%d", i);
+	fileSystem->Remove(name);
+    }
+}
+
+//----------------------------------------------------------------------
+// ReadWhole
+// 	Time a sequential read of the file "name", in sectors.
+//----------------------------------------------------------------------
+
+static void
+ReadWhole(char *benchName, char *name)
+{
+    char buffer[SectorSize];
+    OpenFile *file;
+    int i, started;
+
+    if ((file = MakeFile(name, BenchFileSize)) == NULL)
+	return;
+    Measurement *reads = new Measurement(benchName, SectorSize);
+    for (i = 0; i < BenchFileSize; i += SectorSize) {
+	started = reads->Start();
+	reads->Done(started, file->Read(buffer, SectorSize));
+    }
+    reads->Report();
+    delete reads;
+    delete file;
+    fileSystem->Remove(name);
+}
+
+//----------------------------------------------------------------------
+// AgingBench
+// 	Read a file made on an empty disk; then age the disk with a long
+//	run of creates and deletes of small files of random sizes, which
+//	leaves holes all through its free space, and read a file made
+//	then.  Sectors are handed out lowest first, so the second file
+//	is scattered among the holes.
+//----------------------------------------------------------------------
+
+static void
+AgingBench()
+{
+    bool alive[AgingFiles];
+    char name[FileNameMaxLen + 1];
+    int round, i, numAlive = 0;
+
+    ReadWhole("freshread", "fresh");
+
+    for (i = 0; i < AgingFiles; i++)
+	alive[i] = FALSE;
+    for (round = 0; round < AgingRounds; round++) {
+	i = Random() % AgingFiles;
+	sprintf(name, "age%d", i);
+	if (!alive[i]) {
+	    alive[i] = fileSystem->Create(name,
+				(1 + Random() % 8) * SectorSize);
+	    if (alive[i])
+		numAlive++;
+	} else if ((numAlive == AgingFiles) || (Random() % 2)) {
+	    alive[i] = !fileSystem->Remove(name);
+	    if (!alive[i])
+		numAlive--;
+	}
+    }
+
+    ReadWhole("agedread", "aged");
+
+    for (i = 0; i < AgingFiles; i++)
+	if (alive[i]) {
+	    sprintf(name, "age%d", i);
+	    fileSystem->Remove(name);
+	}
+}
+
+//----------------------------------------------------------------------
+// CloneBench
+// 	Duplicate a file twice: once the old way, by reading it all and
+//	writing it to a new file, and once by cloning it; then overwrite
+//	the clone a sector at a time, which is when its data gets copied.
+//----------------------------------------------------------------------
+
+static void
+CloneBench()
+{
+    char *buffer = new char[BenchFileSize];
+    OpenFile *file, *copy;
+    int i, started;
+
+    if ((file = MakeFile("original", BenchFileSize)) == NULL)
+	return;
+
+    Measurement *copies = new Measurement("copy", BenchFileSize);
+    started = copies->Start();
+    file->ReadAt(buffer, BenchFileSize, 0);
+    if (fileSystem->Create("copy", BenchFileSize)
+		&& ((copy = fileSystem->Open("copy")) != NULL)) {
+	copies->Done(started, copy->WriteAt(buffer, BenchFileSize, 0));
+	delete copy;
+	copies->Report();
+    } else
+	printf("Benchmark: can't create copy\n");
+    delete copies;
+    delete file;			// it mustn't be open while cloned
+
+    Measurement *clones = new Measurement("clone", BenchFileSize);
+    started = clones->Start();
+    if (fileSystem->Clone("original", "clone")) {
+	clones->Done(started, BenchFileSize);
+	clones->Report();
+
+	copy = fileSystem->Open("clone");
+	bzero(buffer, SectorSize);
+	Measurement *writes = new Measurement("cowwrite", SectorSize);
+	for (i = 0; i < BenchFileSize; i += SectorSize) {
+	    started = writes->Start();
+	    writes->Done(started, copy->Write(buffer, SectorSize));
+	}
+	writes->Report();
+	delete writes;
+	delete copy;
+    } else
+	printf("Benchmark: can't clone original\n");
+    delete clones;
+
+    fileSystem->Remove("original");
+    fileSystem->Remove("copy");
+    fileSystem->Remove("clone");
+    delete [] buffer;
+}
+
+//----------------------------------------------------------------------
+// ReadUnixFile
+// 	Read up to MaxFileSize bytes of the UNIX file "name" into "into".
+//	Return how many, or -1 if it couldn't be opened.
+//----------------------------------------------------------------------
+
+static int
+ReadUnixFile(char *name, char *into)
+{
+    FILE *fp;
+    int size;
+
+    if ((fp = fopen(name, "r")) == NULL) {
+	printf("Benchmark: can't open %s\n", name);
+	return -1;
+    }
+    size = fread(into, sizeof(char), MaxFileSize, fp);
+    fclose(fp);
+    return size;
+}
+
+//----------------------------------------------------------------------
+// CompressionRun
+// 	Write each of the "numFiles" pieces of data in "contents" to a
+//	file of its own, plain or compressed, then read them all back and
+//	check them.  Each operation is a whole file, written or read a
+//	sector at a time, from opening it to closing it (which is when a
+//	compressed file's last block is written back).
+//
+//	"dataName" -- what to call the data
+//	"contents", "sizes" -- the data for each file
+//	"numFiles" -- how many there are
+//	"compressed" -- whether to compress them
+//----------------------------------------------------------------------
+
+static void
+CompressionRun(char *dataName, char **contents, int *sizes, int numFiles,
+							bool compressed)
+{
+    char buffer[SectorSize], name[FileNameMaxLen + 1];
+    OpenFile *file;
+    int i, j, started, n, numSectors = 0, failed = 0;
+
+    Measurement *writes = new Measurement(compressed ? "zwrite" : "write", 0);
+    for (i = 0; i < numFiles; i++) {
+	sprintf(name, "text%d", i);
+	started = writes->Start();
+	if (!fileSystem->Create(name, sizes[i], compressed)
+		|| ((file = fileSystem->Open(name)) == NULL)) {
+	    writes->Done(started, 0);
+	    failed++;
+	    continue;
+	}
+	for (j = n = 0; j < sizes[i]; j += SectorSize)
+	    n += file->Write(&contents[i][j], min(SectorSize, sizes[i] - j));
+	delete file;
+	writes->Done(started, n);
+    }
+
+    Measurement *reads = new Measurement(compressed ? "zread" : "read", 0);
+    for (i = 0; i < numFiles; i++) {
+	sprintf(name, "text%d", i);
+	started = reads->Start();
+	if ((file = fileSystem->Open(name)) == NULL) {
+	    reads->Done(started, 0);
+	    failed++;
+	    continue;
+	}
+	for (j = n = 0; j < sizes[i]; j += SectorSize) {
+	    n += file->Read(buffer, SectorSize);
+	    if (bcmp(buffer, &contents[i][j], min(SectorSize, sizes[i] - j)))
+		failed++;
+	}
+	numSectors += file->DataSectors();
+	delete file;
+	reads->Done(started, n);
+	fileSystem->Remove(name);
+    }
+    if (failed > 0)
+	printf("Benchmark: %d %s operations failed\n", failed, dataName);
+
+    writes->Describe(dataName, numSectors);
+    writes->Report();
+    reads->Describe(dataName, numSectors);
+    reads->Report();
+    delete writes;
+    delete reads;
+}
+
+//----------------------------------------------------------------------
+// CompressionBench
+// 	Measure what compressing files saves, in sectors, and what it
+//	costs, or saves, in throughput: first with the C sources of the
+//	test programs, a file each, and then with a file full of what
+//	PerformanceTest writes.
+//----------------------------------------------------------------------
+
+static char *textFiles[] = { "fileio.c", "halt.c", "hash.c", "matmult.c",
+	"procs.c", "shell.c", "sort.c", "start.c", "strings.c", "syscalls.c" };
+#define NumTextFiles	(int) (sizeof(textFiles) / sizeof(char *))
+
+static void
+CompressionBench()
+{
+    char *contents[NumTextFiles];
+    int sizes[NumTextFiles];
+    char path[100];
+    int i, numFiles = 0;
+
+    for (i = 0; i < NumTextFiles; i++) {
+	contents[numFiles] = new char[MaxFileSize];
+	sprintf(path, "%s%s", TextDir, textFiles[i]);
+	if ((sizes[numFiles] = ReadUnixFile(path, contents[numFiles])) > 0)
+	    numFiles++;
+	else
+	    delete [] contents[numFiles];
+    }
+    if (numFiles > 0) {
+	CompressionRun("text", contents, sizes, numFiles, FALSE);
+	CompressionRun("text", contents, sizes, numFiles, TRUE);
+    }
+    for (i = 0; i < numFiles; i++)
+	delete [] contents[i];
+
+    contents[0] = new char[MaxFileSize];
+    sizes[0] = MaxFileSize;
+    for (i = 0; i < sizes[0]; i++)
+	contents[0][i] = PerfContents[i % strlen(PerfContents)];
+    CompressionRun("perftest", contents, sizes, 1, FALSE);
+    CompressionRun("perftest", contents, sizes, 1, TRUE);
+    delete [] contents[0];
+}
+
+//----------------------------------------------------------------------
+// FileSystemBench
+// 	Run the whole suite.
+//----------------------------------------------------------------------
+
+void
+FileSystemBench()
+{
+    printf("Starting file system benchmarks:\n");
+    SequentialBench(16);
+    SequentialBench(SectorSize);
+    SequentialBench(1024);
+    RandomBench(16);
+    RandomBench(SectorSize);
+    QueuedBench();
+    StormBench();
+    MixedBench();
+    AgingBench();
+    CloneBench();
+    CompressionBench();
+}
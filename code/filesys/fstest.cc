@@ -2,7 +2,7 @@
 //	Simple test routines for the file system.  
 //
 //	We implement:
-//	   Copy -- copy a file from UNIX to Nachos
+//	   Copy -- copy a file from UNIX to Nachos, perhaps compressed
 //	   Print -- cat the contents of a Nachos file 
 //	   Perftest -- a stress test for the Nachos file system
 //		read and write a really large file in tiny chunks
@@ -25,11 +25,12 @@
 
 //----------------------------------------------------------------------
 // Copy
-// 	Copy the contents of the UNIX file "from" to the Nachos file "to"
+// 	Copy the contents of the UNIX file "from" to the Nachos file "to",
+//	compressing it if "compressed" is TRUE
 //----------------------------------------------------------------------
 
 void
-Copy(char *from, char *to)
+Copy(char *from, char *to, bool compressed)
 {
     FILE *fp;
     OpenFile* openFile;
@@ -49,7 +50,7 @@ Copy(char *from, char *to)
 
 // Create a Nachos file of the same length
     DEBUG('f', "Copying file %s, size %d, to file %s\n", from, fileLength, to);
-    if (!fileSystem->Create(to, fileLength)) {	 // Create Nachos file
+    if (!fileSystem->Create(to, fileLength, compressed)) { // Create Nachos file
 	printf("Copy: couldn't create output file %s\n", to);
 	fclose(fp);
 	return;
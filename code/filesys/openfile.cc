@@ -7,6 +7,13 @@
 //	Also as in UNIX, for convenience, we keep the file header in
 //	memory while the file is open.
 //
+//	A compressed file (see filehdr.h) is read and written a block at
+//	a time, through a cache of one block, uncompressed.  Writes are
+//	held there until another block is wanted, or the file is closed,
+//	so that a run of small writes compresses each block only once.
+//	As with everything else here, two OpenFiles for the same file
+//	don't know about each other's cached blocks.
+//
 // Copyright (c) 1992-1993 The Regents of the University of California.
 // All rights reserved.  See copyright.h for copyright notice and limitation 
 // of liability and disclaimer of warranty provisions.
@@ -15,10 +22,45 @@
 #include "filehdr.h"
 #include "openfile.h"
 #include "system.h"
+#include "slab.h"
+#include "compress.h"
 #ifdef HOST_SPARC
 #include <strings.h>
 #endif
 
+// Most reads and writes touch only one or two sectors, so the
+// temporary buffers for those come from a cache; bigger requests
+// still get their buffer from the host.
+#define SmallBufSectors	2
+
+static ObjectCache *sectorBufCache = NULL;
+
+//----------------------------------------------------------------------
+// AllocSectorBuf, FreeSectorBuf
+// 	Get and release a temporary buffer big enough to hold
+//	"numSectors" sectors.
+//----------------------------------------------------------------------
+
+static char *
+AllocSectorBuf(int numSectors)
+{
+    if (numSectors > SmallBufSectors)
+	return new char[numSectors * SectorSize];
+    if (sectorBufCache == NULL)
+	sectorBufCache = new ObjectCache("sector buffers", 
+					SmallBufSectors * SectorSize, 8);
+    return (char *) sectorBufCache->Alloc();
+}
+
+static void
+FreeSectorBuf(char *buf, int numSectors)
+{
+    if (numSectors > SmallBufSectors)
+	delete [] buf;
+    else
+	sectorBufCache->Free(buf);
+}
+
 //----------------------------------------------------------------------
 // OpenFile::OpenFile
 // 	Open a Nachos file for reading and writing.  Bring the file header
@@ -31,16 +73,28 @@ OpenFile::OpenFile(int sector)
 { 
     hdr = new FileHeader;
     hdr->FetchFrom(sector);
+    hdrSector = sector;
     seekPosition = 0;
+    blockCache = hdr->IsCompressed() ? new char[BlockSize] : NULL;
+    cachedBlock = -1;
+    cacheDirty = FALSE;
 }
 
 //----------------------------------------------------------------------
 // OpenFile::~OpenFile
 // 	Close a Nachos file, de-allocating any in-memory data structures.
+//	A block of a compressed file that has been written to, but not
+//	yet written back, is written back now.
 //----------------------------------------------------------------------
 
 OpenFile::~OpenFile()
 {
+    if (blockCache != NULL) {
+	if (!FlushBlock())
+	    printf("Close: out of disk space; lost writes to block %d of "
+		"the file whose header is at %d\n", cachedBlock, hdrSector);
+	delete [] blockCache;
+    }
     delete hdr;
 }
 
@@ -104,7 +158,9 @@ OpenFile::Write(char *into, int numBytes)
 //	   We must first read in any sectors that will be partially written,
 //	   so that we don't overwrite the unmodified portion.  We then copy
 //	   in the data that will be modified, and write back all the full
-//	   or partial sectors that are part of the request.
+//	   or partial sectors that are part of the request.  If the file
+//	   still shares any of those sectors with a clone, it gets new
+//	   ones of its own to write them to.
 //
 //	"into" -- the buffer to contain the data to be read from disk 
 //	"from" -- the buffer containing the data to be written to disk 
@@ -118,6 +174,7 @@ OpenFile::ReadAt(char *into, int numBytes, int position)
 {
     int fileLength = hdr->FileLength();
     int i, firstSector, lastSector, numSectors;
+    int sectors[NumDirect];
     char *buf;
 
     if ((numBytes <= 0) || (position >= fileLength))
@@ -126,20 +183,23 @@ OpenFile::ReadAt(char *into, int numBytes, int position)
 	numBytes = fileLength - position;
     DEBUG('f', "Reading %d bytes at %d, from file of length %d.\n", 	
 			numBytes, position, fileLength);
+    if (blockCache != NULL)
+	return ReadBlocks(into, numBytes, position);
 
     firstSector = divRoundDown(position, SectorSize);
     lastSector = divRoundDown(position + numBytes - 1, SectorSize);
     numSectors = 1 + lastSector - firstSector;
 
-    // read in all the full and partial sectors that we need
-    buf = new char[numSectors * SectorSize];
+    // read in all the full and partial sectors that we need, asking
+    // the disk for them all at once
+    buf = AllocSectorBuf(numSectors);
     for (i = firstSector; i <= lastSector; i++)	
-        synchDisk->ReadSector(hdr->ByteToSector(i * SectorSize), 
-					&buf[(i - firstSector) * SectorSize]);
+        sectors[i - firstSector] = hdr->ByteToSector(i * SectorSize);
+    synchDisk->ReadSectors(numSectors, sectors, buf);
 
     // copy the part we want
     bcopy(&buf[position - (firstSector * SectorSize)], into, numBytes);
-    delete [] buf;
+    FreeSectorBuf(buf, numSectors);
     return numBytes;
 }
 
@@ -148,6 +208,7 @@ OpenFile::WriteAt(char *from, int numBytes, int position)
 {
     int fileLength = hdr->FileLength();
     int i, firstSector, lastSector, numSectors;
+    int sectors[NumDirect];
     bool firstAligned, lastAligned;
     char *buf;
 
@@ -157,12 +218,14 @@ OpenFile::WriteAt(char *from, int numBytes, int position)
 	numBytes = fileLength - position;
     DEBUG('f', "Writing %d bytes at %d, from file of length %d.\n", 	
 			numBytes, position, fileLength);
+    if (blockCache != NULL)
+	return WriteBlocks(from, numBytes, position);
 
     firstSector = divRoundDown(position, SectorSize);
     lastSector = divRoundDown(position + numBytes - 1, SectorSize);
     numSectors = 1 + lastSector - firstSector;
 
-    buf = new char[numSectors * SectorSize];
+    buf = AllocSectorBuf(numSectors);
 
     firstAligned = (position == (firstSector * SectorSize));
     lastAligned = ((position + numBytes) == ((lastSector + 1) * SectorSize));
@@ -174,17 +237,149 @@ OpenFile::WriteAt(char *from, int numBytes, int position)
         ReadAt(&buf[(lastSector - firstSector) * SectorSize], 
 				SectorSize, lastSector * SectorSize);	
 
+// split off our own copy of any sectors shared with a clone
+    for (i = firstSector; i <= lastSector; i++)
+	if (hdr->MayShare(i * SectorSize))
+	    break;
+    if ((i <= lastSector)
+		&& !fileSystem->Unshare(hdr, hdrSector, position, numBytes)) {
+	FreeSectorBuf(buf, numSectors);
+	return 0;				// disk full
+    }
+
 // copy in the bytes we want to change 
     bcopy(from, &buf[position - (firstSector * SectorSize)], numBytes);
 
 // write modified sectors back
     for (i = firstSector; i <= lastSector; i++)	
-        synchDisk->WriteSector(hdr->ByteToSector(i * SectorSize), 
-					&buf[(i - firstSector) * SectorSize]);
-    delete [] buf;
+        sectors[i - firstSector] = hdr->ByteToSector(i * SectorSize);
+    synchDisk->WriteSectors(numSectors, sectors, buf);
+    FreeSectorBuf(buf, numSectors);
+    return numBytes;
+}
+
+//----------------------------------------------------------------------
+// OpenFile::ReadBlocks/WriteBlocks
+// 	ReadAt/WriteAt for a compressed file, once the request has been
+//	checked: copy the data out of, or into, each block it touches in
+//	turn, in blockCache.  Return the number of bytes read or written;
+//	fewer than asked for only if writing back an earlier block found
+//	the disk full.
+//
+//	"into" -- the buffer to contain the data read
+//	"from" -- the buffer containing the data to be written
+//	"numBytes" -- the number of bytes to transfer
+//	"position" -- the offset within the file of the first byte
+//----------------------------------------------------------------------
+
+int
+OpenFile::ReadBlocks(char *into, int numBytes, int position)
+{
+    int done, block, offset, n;
+
+    for (done = 0; done < numBytes; done += n) {
+	block = (position + done) / BlockSize;
+	offset = (position + done) % BlockSize;
+	n = min(numBytes - done, BlockSize - offset);
+	if (!FetchBlock(block, FALSE))
+	    return done;
+	bcopy(&blockCache[offset], &into[done], n);
+    }
+    return numBytes;
+}
+
+int
+OpenFile::WriteBlocks(char *from, int numBytes, int position)
+{
+    int done, block, offset, n;
+
+    for (done = 0; done < numBytes; done += n) {
+	block = (position + done) / BlockSize;
+	offset = (position + done) % BlockSize;
+	n = min(numBytes - done, BlockSize - offset);
+	if (!FetchBlock(block, n == hdr->BlockLength(block)))
+	    return done;
+	bcopy(&from[done], &blockCache[offset], n);
+	cacheDirty = TRUE;
+    }
     return numBytes;
 }
 
+//----------------------------------------------------------------------
+// OpenFile::FetchBlock
+// 	Make "block" the one in blockCache, writing back the one there
+//	first if it has been written to.  Return FALSE if that found the
+//	disk full, leaving it there.
+//
+//	"block" -- the block wanted
+//	"whole" -- TRUE if all of it is about to be written, so there is
+//		no need to read it
+//----------------------------------------------------------------------
+
+bool
+OpenFile::FetchBlock(int block, bool whole)
+{
+    if (block == cachedBlock)
+	return TRUE;
+    if (!FlushBlock())
+	return FALSE;
+    if (!whole)
+	hdr->ReadBlock(block, blockCache);
+    cachedBlock = block;
+    return TRUE;
+}
+
+//----------------------------------------------------------------------
+// OpenFile::FlushBlock
+// 	If the block in blockCache has been written to, compress it and
+//	write it back to disk: in no sectors at all if it is all zeros,
+//	compressed if that saves at least a sector, and otherwise as it
+//	is.  Return FALSE if the disk is too full for it.
+//----------------------------------------------------------------------
+
+bool
+OpenFile::FlushBlock()
+{
+    int length, raw, size, count, i;
+    int sectors[BlockSize / SectorSize];
+    char *buf;
+
+    if (!cacheDirty)
+	return TRUE;
+    length = hdr->BlockLength(cachedBlock);
+    raw = divRoundUp(length, SectorSize);
+    buf = AllocSectorBuf(raw);
+
+    for (i = 0; (i < length) && (blockCache[i] == 0); i++)
+	;
+    if (i == length)
+	count = 0;				// all zeros
+    else if ((raw > 1) && ((size = CompressBlock(blockCache, length, &buf[2],
+					(raw - 1) * SectorSize - 2)) != -1)) {
+	buf[0] = size & 0xff;
+	buf[1] = size >> 8;
+	count = divRoundUp(size + 2, SectorSize);
+    } else {
+	bcopy(blockCache, buf, length);		// doesn't compress
+	count = raw;
+    }
+    DEBUG('f', "Writing back block %d of header at %d, in %d sectors\n",
+	cachedBlock, hdrSector, count);
+
+    if (!fileSystem->ReallocateBlock(hdr, hdrSector, cachedBlock, count)) {
+	FreeSectorBuf(buf, raw);
+	return FALSE;				// disk full
+    }
+    if (count > 0) {
+	for (i = 0; i < count; i++)
+	    sectors[i] = hdr->BlockToSector(cachedBlock, i);
+	synchDisk->WriteSectors(count, sectors, buf);
+    }
+    FreeSectorBuf(buf, raw);
+    cacheDirty = FALSE;
+    return TRUE;
+}
+
 //----------------------------------------------------------------------
 // OpenFile::Length
 // 	Return the number of bytes in the file.
@@ -195,3 +390,16 @@ OpenFile::Length()
 { 
     return hdr->FileLength(); 
 }
+
+//----------------------------------------------------------------------
+// OpenFile::DataSectors
+// 	Return the number of sectors the file's data takes on disk.  For
+//	a compressed file, this counts blocks as they were when last
+//	written back.
+//----------------------------------------------------------------------
+
+int
+OpenFile::DataSectors()
+{
+    return hdr->DataSectors();
+}
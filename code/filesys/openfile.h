@@ -85,10 +85,24 @@ class OpenFile {
 					// file (this interface is simpler 
 					// than the UNIX idiom -- lseek to 
 					// end of file, tell, lseek back 
+    int DataSectors();			// Return how many sectors its
+					// data takes on disk
     
   private:
     FileHeader *hdr;			// Header for this file 
+    int hdrSector;			// Where it is on disk
     int seekPosition;			// Current position within the file
+
+    char *blockCache;			// For a compressed file, the block
+    int cachedBlock;			// last used, uncompressed (or -1),
+    bool cacheDirty;			// and whether it has been written to
+
+    int ReadBlocks(char *into, int numBytes, int position);
+    int WriteBlocks(char *from, int numBytes, int position);
+					// ReadAt/WriteAt, compressed
+    bool FetchBlock(int block, bool whole);
+					// Bring a block into blockCache
+    bool FlushBlock();			// Compress it, and write it back
 };
 
 #endif // FILESYS
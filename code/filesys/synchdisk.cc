@@ -5,10 +5,12 @@
 //	the disk providing a synchronous interface (requests wait until
 //	the request completes).
 //
-//	Use a semaphore to synchronize the interrupt handlers with the
-//	pending requests.  And, because the physical disk can only
-//	handle one operation at a time, use a lock to enforce mutual
-//	exclusion.
+//	Because the physical disk can only handle one operation at a
+//	time, requests wait their turn in a queue; the interrupt handler
+//	marks each one done as it finishes, starts the next, and wakes
+//	the thread waiting for it, if any.  As with Semaphore, the queue is protected
+//	by disabling interrupts.  A lock still keeps the synchronous
+//	requests of different threads from overlapping.
 //
 // Copyright (c) 1992-1993 The Regents of the University of California.
 // All rights reserved.  See copyright.h for copyright notice and limitation 
@@ -16,6 +18,10 @@
 
 #include "copyright.h"
 #include "synchdisk.h"
+#include "system.h"
+#include "slab.h"
+
+static ObjectCache *requestCache = NULL;	// where DiskRequests come from
 
 //----------------------------------------------------------------------
 // DiskRequestDone
@@ -38,12 +44,15 @@ DiskRequestDone (int arg)
 //
 //	"name" -- UNIX file name to be used as storage for the disk data
 //	   (usually, "DISK")
+//	"diskTrace" -- where to record each request, or NULL
 //----------------------------------------------------------------------
 
-SynchDisk::SynchDisk(char* name)
+SynchDisk::SynchDisk(char* name, DiskTrace *diskTrace)
 {
-    semaphore = new Semaphore("synch disk", 0);
+    trace = diskTrace;
     lock = new Lock("synch disk lock");
+    active = NULL;
+    queue = new IntrusiveList<DiskRequest, &DiskRequest::next>;
     disk = new Disk(name, DiskRequestDone, (int) this);
 }
 
@@ -55,9 +64,10 @@ SynchDisk::SynchDisk(char* name)
 
 SynchDisk::~SynchDisk()
 {
+    ASSERT((active == NULL) && queue->IsEmpty());
     delete disk;
     delete lock;
-    delete semaphore;
+    delete queue;
 }
 
 //----------------------------------------------------------------------
@@ -72,10 +82,7 @@ SynchDisk::~SynchDisk()
 void
 SynchDisk::ReadSector(int sectorNumber, char* data)
 {
-    lock->Acquire();			// only one disk I/O at a time
-    disk->ReadRequest(sectorNumber, data);
-    semaphore->P();			// wait for interrupt
-    lock->Release();
+    Transfer(1, &sectorNumber, data, FALSE);
 }
 
 //----------------------------------------------------------------------
@@ -90,20 +97,274 @@ SynchDisk::ReadSector(int sectorNumber, char* data)
 void
 SynchDisk::WriteSector(int sectorNumber, char* data)
 {
-    lock->Acquire();			// only one disk I/O at a time
-    disk->WriteRequest(sectorNumber, data);
-    semaphore->P();			// wait for interrupt
+    Transfer(1, &sectorNumber, data, TRUE);
+}
+
+//----------------------------------------------------------------------
+// SynchDisk::ReadSectors/WriteSectors
+// 	Read/write several disk sectors, to/from consecutive buffers,
+//	returning only once they have all been read or written.
+//
+//	"numSectors" -- how many sectors; at most MaxTransfer
+//	"sectorNumbers" -- which ones
+//	"data" -- the buffers, SectorSize bytes each
+//----------------------------------------------------------------------
+
+void
+SynchDisk::ReadSectors(int numSectors, int *sectorNumbers, char *data)
+{
+    Transfer(numSectors, sectorNumbers, data, FALSE);
+}
+
+void
+SynchDisk::WriteSectors(int numSectors, int *sectorNumbers, char *data)
+{
+    Transfer(numSectors, sectorNumbers, data, TRUE);
+}
+
+//----------------------------------------------------------------------
+// SynchDisk::Transfer
+// 	Queue requests to read or write each of the sectors, all at once,
+//	and wait until they are all done.
+//
+//	"numSectors" -- how many sectors; at most MaxTransfer
+//	"sectorNumbers" -- which ones
+//	"data" -- the buffers, SectorSize bytes each
+//	"writing" -- TRUE to write them
+//----------------------------------------------------------------------
+
+void
+SynchDisk::Transfer(int numSectors, int *sectorNumbers, char *data,
+								bool writing)
+{
+    DiskRequest *requests[MaxTransfer];
+    IntStatus oldLevel;
+    int i;
+
+    ASSERT((numSectors > 0) && (numSectors <= MaxTransfer));
+    lock->Acquire();			// only one synchronous transfer
+					// at a time
+    oldLevel = interrupt->SetLevel(IntOff);	// all issued at the
+    for (i = 0; i < numSectors; i++)		// same tick
+	requests[i] = Submit(sectorNumbers[i], &data[i * SectorSize], writing);
+    (void) interrupt->SetLevel(oldLevel);
+    WaitAll(requests, numSectors);
     lock->Release();
+    for (i = 0; i < numSectors; i++)
+	delete requests[i];
+}
+
+//----------------------------------------------------------------------
+// DiskRequest::DiskRequest
+// 	Initialize a request to read or write a disk sector.
+//
+//	"sectorNumber" -- the disk sector to read or write
+//	"buffer" -- where to put the sector, or where to get it from
+//	"write" -- TRUE to write it
+//	"func", "arg" -- call (*func)(arg) when it is done, unless NULL
+//----------------------------------------------------------------------
+
+DiskRequest::DiskRequest(int sectorNumber, char *buffer, bool write,
+					VoidFunctionPtr func, int arg)
+{
+    sector = sectorNumber;
+    data = buffer;
+    writing = write;
+    callback = func;
+    callArg = arg;
+    thread = currentThread;
+    issued = stats->totalTicks;
+    started = 0;
+    done = FALSE;
+    waiter = NULL;
+    task = NULL;
+    next = NULL;
+}
+
+//----------------------------------------------------------------------
+// DiskRequest::operator new, DiskRequest::operator delete
+// 	Get a request from the request cache, and put it back.
+//----------------------------------------------------------------------
+
+void *
+DiskRequest::operator new(size_t size)
+{
+    ASSERT(size == sizeof(DiskRequest));
+    if (requestCache == NULL)
+	requestCache = new ObjectCache("disk requests",
+						sizeof(DiskRequest), 32);
+    return requestCache->Alloc();
+}
+
+void
+DiskRequest::operator delete(void *p)
+{
+    requestCache->Free(p);
+}
+
+//----------------------------------------------------------------------
+// SynchDisk::Submit
+// 	Queue a request to read or write a disk sector, sending it to the
+//	disk if the disk isn't busy, and return it without waiting for it.
+//	The caller must delete it once it is done.  Can be called from an
+//	interrupt handler -- even a disk request's callback.
+//
+//	"sectorNumber" -- the disk sector to read or write
+//	"data" -- where to put the sector, or where to get it from; it
+//		must stay there until the request is done
+//	"writing" -- TRUE to write it
+//	"callback", "callArg" -- call (*callback)(callArg) from the disk
+//		interrupt handler when it is done, unless NULL
+//----------------------------------------------------------------------
+
+DiskRequest *
+SynchDisk::Submit(int sectorNumber, char *data, bool writing,
+				VoidFunctionPtr callback, int callArg)
+{
+    DiskRequest *request = new DiskRequest(sectorNumber, data, writing,
+						callback, callArg);
+    IntStatus oldLevel = interrupt->SetLevel(IntOff);
+
+    queue->Append(request);
+    if (active == NULL)
+	StartNext();
+    (void) interrupt->SetLevel(oldLevel);
+    return request;
+}
+
+//----------------------------------------------------------------------
+// SynchDisk::StartNext
+// 	Send the request at the head of the queue, if there is one, to
+//	the disk.  Called with interrupts disabled, when the disk is idle.
+//----------------------------------------------------------------------
+
+void
+SynchDisk::StartNext()
+{
+    ASSERT(active == NULL);
+    if ((active = queue->Remove()) == NULL)
+	return;
+    active->started = stats->totalTicks;
+    if (active->writing)
+	disk->WriteRequest(active->sector, active->data);
+    else
+	disk->ReadRequest(active->sector, active->data);
+}
+
+//----------------------------------------------------------------------
+// SynchDisk::Wait
+// 	Wait until "request" is done.
+//----------------------------------------------------------------------
+
+void
+SynchDisk::Wait(DiskRequest *request)
+{
+    IntStatus oldLevel = interrupt->SetLevel(IntOff);
+
+    while (!request->done) {
+	request->waiter = currentThread;
+	currentThread->Sleep();
+    }
+    (void) interrupt->SetLevel(oldLevel);
+}
+
+//----------------------------------------------------------------------
+// SynchDisk::Wait
+// 	Wait until "request" is done, on behalf of a stackless task,
+//	with TASK_AWAIT(disk->Wait(request, this)).  Return TRUE if it
+//	is done already; otherwise note the task, to be woken when it is
+//	done, and return FALSE.
+//----------------------------------------------------------------------
+
+bool
+SynchDisk::Wait(DiskRequest *request, Task *task)
+{
+    IntStatus oldLevel = interrupt->SetLevel(IntOff);
+    bool done = request->done;
+
+    if (!done)
+	request->task = task;
+    (void) interrupt->SetLevel(oldLevel);
+    return done;
+}
+
+//----------------------------------------------------------------------
+// SynchDisk::WaitAny
+// 	Wait until at least one of "requests" is done, and return the
+//	index of the first that is.  We wait on each of them, and the
+//	first to finish wakes us; we then stop waiting on the rest.
+//
+//	"requests" -- the requests to wait for
+//	"numRequests" -- how many there are
+//----------------------------------------------------------------------
+
+int
+SynchDisk::WaitAny(DiskRequest **requests, int numRequests)
+{
+    IntStatus oldLevel = interrupt->SetLevel(IntOff);
+    int i;
+
+    ASSERT(numRequests > 0);
+    for (;;) {
+	for (i = 0; i < numRequests; i++)
+	    if (requests[i]->done) {
+		(void) interrupt->SetLevel(oldLevel);
+		return i;
+	    }
+	for (i = 0; i < numRequests; i++)
+	    requests[i]->waiter = currentThread;
+	currentThread->Sleep();
+	for (i = 0; i < numRequests; i++)
+	    requests[i]->waiter = NULL;
+    }
+}
+
+//----------------------------------------------------------------------
+// SynchDisk::WaitAll
+// 	Wait until all of "requests" are done.
+//
+//	"requests" -- the requests to wait for
+//	"numRequests" -- how many there are
+//----------------------------------------------------------------------
+
+void
+SynchDisk::WaitAll(DiskRequest **requests, int numRequests)
+{
+    for (int i = 0; i < numRequests; i++)
+	Wait(requests[i]);
 }
 
 //----------------------------------------------------------------------
 // SynchDisk::RequestDone
-// 	Disk interrupt handler.  Wake up any thread waiting for the disk
-//	request to finish.
+// 	Disk interrupt handler.  The disk has finished the active request:
+//	record it, start the next one, call the request's callback, and
+//	wake the thread or task waiting for it.  A thread in WaitAny waits on
+//	several requests; if another of them has already woken it, it is
+//	no longer blocked, and is left alone.
 //----------------------------------------------------------------------
 
 void
 SynchDisk::RequestDone()
 { 
-    semaphore->V();
+    DiskRequest *request = active;
+    Thread *thread;
+    Task *task;
+
+    ASSERT(request != NULL);
+    if (trace != NULL)
+	trace->Request(request->thread, request->sector, request->writing,
+					request->issued, request->started);
+    request->done = TRUE;
+    active = NULL;
+    StartNext();			// keep the disk busy
+    thread = request->waiter;
+    task = request->task;
+    request->waiter = NULL;
+    request->task = NULL;
+    if (request->callback != NULL)
+	(*request->callback)(request->callArg);
+    if ((thread != NULL) && (thread->getStatus() == BLOCKED))
+	scheduler->ReadyToRun(thread);
+    if (task != NULL)
+	task->Wake();
 }
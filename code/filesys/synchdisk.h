@@ -13,6 +13,41 @@
 
 #include "disk.h"
 #include "synch.h"
+#include "disktrace.h"
+
+#define MaxTransfer	SectorsPerTrack	// most sectors ReadSectors and
+					// WriteSectors can take at once
+
+// The following class defines a request made of the disk with
+// SynchDisk::Submit, which is also the caller's handle on it: to ask
+// whether it is done, or wait until it is.  It belongs to the caller,
+// who must delete it once it is done -- and not before, while the disk
+// is still reading into or writing from "data".
+
+class DiskRequest {
+  public:
+    DiskRequest(int sectorNumber, char *buffer, bool write,
+		VoidFunctionPtr func, int arg);
+
+    bool IsDone() { return done; }	// Has it finished?
+
+    void *operator new(size_t size);	// requests come from a cache,
+    void operator delete(void *p);	// not straight from the host
+
+    int sector;				// the sector to read or write
+    char *data;				// where to put it, or get it from
+    bool writing;			// TRUE for a write
+    VoidFunctionPtr callback;		// called (with callArg) from the
+    int callArg;			// disk interrupt once it is done,
+					// unless NULL
+    Thread *thread;			// who made it, and when, and when
+    int issued;				// it went to the disk, for the
+    int started;			// trace
+    bool done;
+    Thread *waiter;			// the thread waiting for it, or NULL
+    Task *task;				// the task waiting for it, or NULL
+    DiskRequest *next;			// the next one waiting for the disk
+};
 
 // The following class defines a "synchronous" disk abstraction.
 // As with other I/O devices, the raw physical disk is an asynchronous device --
@@ -24,19 +59,57 @@
 // This class provides the abstraction that for any individual thread
 // making a request, it waits around until the operation finishes before
 // returning.
+//
+// Underneath, requests wait their turn for the disk in a queue, and the
+// disk interrupt starts the next as soon as one finishes.  (Threads
+// making synchronous requests also take turns through a lock, as they
+// always have, which lets a thread making a run of them keep the disk,
+// and its track buffer, to itself.)  ReadSectors and WriteSectors
+// queue several requests at once, so the disk goes straight from one
+// to the next without waiting for the thread to run again.  Kernel code
+// that has several independent requests to make can use that directly:
+// Submit them all at once, without waiting, and then wait for any or
+// all of them, or have each call a routine when it is done.  Callbacks
+// run in the disk interrupt handler, so, like a V on a Semaphore, they
+// must not block; WorkQueue::Submit is there for work that might.
+//
+// If it is given a DiskTrace, every request is recorded in it.
 class SynchDisk {
   public:
-    SynchDisk(char* name);    		// Initialize a synchronous disk,
+    SynchDisk(char* name, DiskTrace *diskTrace = NULL);
+    					// Initialize a synchronous disk,
 					// by initializing the raw Disk.
     ~SynchDisk();			// De-allocate the synch disk data
     
     void ReadSector(int sectorNumber, char* data);
     					// Read/write a disk sector, returning
     					// only once the data is actually read 
-					// or written.  These call
-    					// Disk::ReadRequest/WriteRequest and
-					// then wait until the request is done.
+					// or written.  These Submit a
+					// request and then wait until
+					// it is done.
     void WriteSector(int sectorNumber, char* data);
+    void ReadSectors(int numSectors, int *sectorNumbers, char *data);
+    void WriteSectors(int numSectors, int *sectorNumbers, char *data);
+					// Likewise, for up to MaxTransfer
+					// sectors, to or from consecutive
+					// buffers in "data"; the requests
+					// are all queued at once
+
+    DiskRequest *Submit(int sectorNumber, char *data, bool writing,
+		VoidFunctionPtr callback = NULL, int callArg = 0);
+					// Queue a request, and return
+					// without waiting for it
+    void Wait(DiskRequest *request);	// Wait until it is done
+    bool Wait(DiskRequest *request, Task *task);
+					// Wait on behalf of a stackless
+					// task (see task.h): TRUE if it is
+					// done, else the task is woken when
+					// it is
+    int WaitAny(DiskRequest **requests, int numRequests);
+					// Wait until one of them is done,
+					// and return which
+    void WaitAll(DiskRequest **requests, int numRequests);
+					// Wait until they all are
     
     void RequestDone();			// Called by the disk device interrupt
 					// handler, to signal that the
@@ -44,10 +117,17 @@ class SynchDisk {
 
   private:
     Disk *disk;		  		// Raw disk device
-    Semaphore *semaphore; 		// To synchronize requesting thread 
-					// with the interrupt handler
-    Lock *lock;		  		// Only one read/write request
-					// can be sent to the disk at a time
+    Lock *lock;		  		// Only one ReadSector/WriteSector
+					// at a time
+    DiskRequest *active;		// The request the disk is doing,
+					// or NULL
+    IntrusiveList<DiskRequest, &DiskRequest::next> *queue;
+					// Requests waiting their turn
+    DiskTrace *trace;			// Where to record requests, or NULL
+
+    void StartNext();			// Send the next request to the disk
+    void Transfer(int numSectors, int *sectorNumbers, char *data,
+		bool writing);		// Read or write sectors, and wait
 };
 
 #endif // SYNCHDISK_H
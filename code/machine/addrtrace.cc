@@ -0,0 +1,171 @@
+// addrtrace.cc
+//	Routines to record the addresses a user program uses, for cache
+//	and TLB studies.
+//
+//	Each record is the distance from the address before, in as few
+//	bytes as it fits in -- see ../bin/atrace.h.
+//
+// Copyright (c) 1992-1993 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#include "copyright.h"
+#include "addrtrace.h"
+#include "system.h"
+
+//----------------------------------------------------------------------
+// AddrTrace::AddrTrace
+// 	Create a trace file and write its header.
+//
+//	"fileName" -- UNIX file to hold the trace
+//----------------------------------------------------------------------
+
+AddrTrace::AddrTrace(char *fileName)
+{
+    ATraceHeader header;
+
+    name = fileName;
+    chunk = new unsigned char[ATChunkSize];
+    used = count = 0;
+    numFetches = numLoads = numStores = numChunks = 0;
+    numBytes = 0;
+    file = fopen(fileName, "wb");
+    if (file == NULL) {
+	printf("Address trace: couldn't open trace file %s\n", fileName);
+	Abort();
+    }
+    header.magic = ATRACEMAGIC;
+    header.chunkSize = ATChunkSize;
+    fwrite((char *) &header, sizeof(header), 1, file);
+}
+
+//----------------------------------------------------------------------
+// AddrTrace::~AddrTrace
+// 	Write out the last chunk, and close the trace.
+//----------------------------------------------------------------------
+
+AddrTrace::~AddrTrace()
+{
+    if (count > 0)
+	Flush();
+    fclose(file);
+    delete [] chunk;
+}
+
+//----------------------------------------------------------------------
+// AddrTrace::Flush
+// 	Append the chunk we have been collecting to the file, and start
+//	a new one.
+//----------------------------------------------------------------------
+
+void
+AddrTrace::Flush()
+{
+    ATraceChunk header;
+
+    header.size = used;
+    header.count = count;
+    header.when = when;
+    fwrite((char *) &header, sizeof(header), 1, file);
+    fwrite((char *) chunk, 1, used, file);
+    numChunks++;
+    numBytes += used;
+    used = count = 0;
+}
+
+//----------------------------------------------------------------------
+// AddrTrace::Begin
+// 	Get ready to append a reference by address space "newSpace":
+//	start a new chunk if this one can't hold it, and note a change
+//	of address space.
+//----------------------------------------------------------------------
+
+void
+AddrTrace::Begin(int newSpace)
+{
+    if (used + 2 * ATMaxRecord > ATChunkSize)
+	Flush();
+    if (count == 0) {			// every chunk starts afresh
+	when = stats->totalTicks;
+	lastPC = -4;
+	lastData = 0;
+    } else if (newSpace == space)
+	return;
+    space = newSpace;
+    Put(((unsigned long long) space << 2) | AT_SPACE);
+}
+
+//----------------------------------------------------------------------
+// AddrTrace::Put
+// 	Append one record to the chunk, seven bits to a byte.
+//----------------------------------------------------------------------
+
+void
+AddrTrace::Put(unsigned long long value)
+{
+    while (value >= 0x80) {
+	chunk[used++] = (value & 0x7f) | 0x80;
+	value >>= 7;
+    }
+    chunk[used++] = value;
+    count++;
+}
+
+//----------------------------------------------------------------------
+// AddrTrace::Fetch
+// 	Record the fetch of an instruction.
+//
+//	"space" -- the number of the address space doing it
+//	"pc" -- the address of the instruction
+//----------------------------------------------------------------------
+
+void
+AddrTrace::Fetch(int space, int pc)
+{
+    Begin(space);
+    Put(((unsigned long long) ATZIGZAG((int) (pc - (unsigned) lastPC - 4))
+								<< 2) | AT_FETCH);
+    lastPC = pc;
+    numFetches++;
+}
+
+//----------------------------------------------------------------------
+// AddrTrace::Access
+// 	Record a load or a store.
+//
+//	"space" -- the number of the address space doing it
+//	"virtAddr" -- the virtual address it touched
+//	"size" -- how many bytes, 1, 2 or 4
+//	"writing" -- TRUE for a store
+//----------------------------------------------------------------------
+
+void
+AddrTrace::Access(int space, int virtAddr, int size, bool writing)
+{
+    int log2Size = (size == 4) ? 2 : (size == 2) ? 1 : 0;
+
+    Begin(space);
+    Put(((unsigned long long) ATZIGZAG((int) (virtAddr - (unsigned) lastData))
+		<< 4) | (log2Size << 2) | (writing ? AT_STORE : AT_LOAD));
+    lastData = virtAddr;
+    if (writing)
+	numStores++;
+    else
+	numLoads++;
+}
+
+//----------------------------------------------------------------------
+// AddrTrace::Print
+// 	Print how many references were traced, and how small they got.
+//----------------------------------------------------------------------
+
+void
+AddrTrace::Print()
+{
+    double total = numBytes + used;
+    int numRefs = numFetches + numLoads + numStores;
+
+    printf("Address trace: %d fetches, %d loads, %d stores, in %.0f bytes "
+	"(%.2f per reference) to %s\n", numFetches, numLoads, numStores,
+	total, (numRefs > 0) ? total / numRefs : 0.0, name);
+}
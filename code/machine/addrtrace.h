@@ -0,0 +1,67 @@
+// addrtrace.h
+//	Data structures to record every address a user program uses.
+//
+//	With "nachos -at <file>", every instruction fetch, load and store
+//	a user program makes -- each address that Machine::ReadMem and
+//	Machine::WriteMem translate -- is written to a trace file, in
+//	order, for cache and TLB studies.  The format is defined in
+//	../bin/atrace.h; each address is stored as its distance from the
+//	one before, so a reference takes a byte or two, and
+//	../bin/atdump (or the routines in ../bin/atread.c) read it back.
+//
+//	References are collected into a chunk in memory, and the chunk
+//	is written out in one piece when it fills up.  (Nachos simulates
+//	everything in one UNIX process, so there is nothing to be gained
+//	by handing the writes to another thread; they are already done
+//	only once per 64KB.)  Translations that fail aren't recorded,
+//	but the reference is when the instruction is retried.
+//
+//	Copies made by the kernel, for system calls, don't go through
+//	ReadMem and WriteMem, so they aren't in the trace.
+//
+// Copyright (c) 1992-1993 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#ifndef ADDRTRACE_H
+#define ADDRTRACE_H
+
+#include "copyright.h"
+#include "utility.h"
+#include "atrace.h"
+
+// The following class defines an address trace, being recorded.
+
+class AddrTrace {
+  public:
+    AddrTrace(char *fileName);	// Start a trace in "fileName"
+    ~AddrTrace();		// Write out the last chunk, and close it
+
+    void Fetch(int space, int pc);
+				// Record an instruction fetch
+    void Access(int space, int virtAddr, int size, bool writing);
+				// Record a load or store of "size" bytes
+
+    void Print();		// print how much was traced
+
+  private:
+    FILE *file;			// the trace file
+    char *name;			// its name, for messages
+    unsigned char *chunk;	// the records not yet written
+    int used;			// bytes of them
+    int count;			// how many
+    int when;			// the time of the first
+    int space;			// the address space of the last record
+    int lastPC;			// the last instruction fetched
+    int lastData;		// the address of the last load or store
+    int numFetches, numLoads, numStores;
+    int numChunks;		// chunks written
+    double numBytes;		// bytes of records written
+
+    void Begin(int space);	// make room for a record by "space"
+    void Put(unsigned long long value);
+				// append a record to the chunk
+    void Flush();		// write out the chunk
+};
+
+#endif // ADDRTRACE_H
@@ -93,11 +93,21 @@ Console::CheckCharAvail()
 			ConsoleReadInt);
 
     // do nothing if character is already buffered, or none to be read
-    if ((incoming != EOF) || !PollFile(readFileNo))
-	return;	  
-
-    // otherwise, read character and tell user about it
-    Read(readFileNo, &c, sizeof(char));
+    if (incoming != EOF)
+	return;
+    if ((replayLog != NULL) && replayLog->IsReplaying()) {
+	if (!replayLog->Pending(ConsoleEvent))	// typed at this poll
+	    return;				// in the recorded run?
+	c = (char) replayLog->Log(ConsoleEvent, 0);
+    } else {
+	if (!PollFile(readFileNo))
+	    return;
+
+	// otherwise, read character and tell user about it
+	Read(readFileNo, &c, sizeof(char));
+	if (replayLog != NULL)
+	    replayLog->Log(ConsoleEvent, c);
+    }
     incoming = c ;
     stats->numConsoleCharsRead++;
     (*readHandler)(handlerArg);	
@@ -23,6 +23,11 @@
 #include "copyright.h"
 #include "interrupt.h"
 #include "system.h"
+#include "slab.h"
+
+// Every device operation schedules a PendingInterrupt, so keep a cache
+// of them rather than going to the host allocator each time.
+static ObjectCache *pendingCache = NULL;
 
 // String definitions for debugging messages
 
@@ -50,6 +55,27 @@ PendingInterrupt::PendingInterrupt(VoidFunctionPtr func, int param, int time,
     type = kind;
 }
 
+//----------------------------------------------------------------------
+// PendingInterrupt::operator new, PendingInterrupt::operator delete
+// 	Get a pending interrupt from the cache, and put it back.
+//----------------------------------------------------------------------
+
+void *
+PendingInterrupt::operator new(size_t size)
+{
+    ASSERT(size == sizeof(PendingInterrupt));
+    if (pendingCache == NULL)
+	pendingCache = new ObjectCache("pending interrupts", 
+					sizeof(PendingInterrupt), 32);
+    return pendingCache->Alloc();
+}
+
+void
+PendingInterrupt::operator delete(void *p)
+{
+    pendingCache->Free(p);
+}
+
 //----------------------------------------------------------------------
 // Interrupt::Interrupt
 // 	Initialize the simulation of hardware device interrupts.
@@ -60,7 +86,7 @@ PendingInterrupt::PendingInterrupt(VoidFunctionPtr func, int param, int time,
 Interrupt::Interrupt()
 {
     level = IntOff;
-    pending = new List();
+    pending = new SortedList<PendingInterrupt *, int>();
     inHandler = FALSE;
     yieldOnReturn = FALSE;
     status = SystemMode;
@@ -74,7 +100,7 @@ Interrupt::Interrupt()
 Interrupt::~Interrupt()
 {
     while (!pending->IsEmpty())
-	delete (PendingInterrupt *)pending->Remove();
+	delete pending->Remove(NULL);
     delete pending;
 }
 
@@ -152,12 +178,13 @@ Interrupt::OneTick()
 {
     MachineStatus old = status;
 
-// advance simulated time
+// advance simulated time -- the clock of the CPU we're on, and the
+// machine's with it (see scheduler.h)
     if (status == SystemMode) {
-        stats->totalTicks += SystemTick;
+        scheduler->Tick(SystemTick);
 	stats->systemTicks += SystemTick;
     } else {					// USER_PROGRAM
-	stats->totalTicks += UserTick;
+	scheduler->Tick(UserTick);
 	stats->userTicks += UserTick;
     }
     DEBUG('i', "\n== Tick %d ==\n", stats->totalTicks);
@@ -242,6 +269,8 @@ Interrupt::Halt()
 {
     printf("Machine halting!\n\n");
     stats->Print();
+    ObjectCache::PrintAll();
+    scheduler->PrintStats();
     Cleanup();     // Never returns.
 }
 
@@ -271,7 +300,7 @@ Interrupt::Schedule(VoidFunctionPtr handler, int arg, int fromNow, IntType type)
 					intTypeNames[type], when);
     ASSERT(fromNow > 0);
 
-    pending->SortedInsert(toOccur, when);
+    pending->Insert(toOccur, when);
 }
 
 //----------------------------------------------------------------------
@@ -297,24 +326,22 @@ Interrupt::CheckIfDue(bool advanceClock)
 					// to invoke an interrupt handler
     if (DebugIsEnabled('i'))
 	DumpState();
-    PendingInterrupt *toOccur = 
-		(PendingInterrupt *)pending->SortedRemove(&when);
-
-    if (toOccur == NULL)		// no pending interrupts
+    if (pending->IsEmpty())		// no pending interrupts
 	return FALSE;			
 
+    when = pending->FirstKey();
     if (advanceClock && when > stats->totalTicks) {	// advance the clock
 	stats->idleTicks += (when - stats->totalTicks);
-	stats->totalTicks = when;
-    } else if (when > stats->totalTicks) {	// not time yet, put it back
-	pending->SortedInsert(toOccur, when);
+	scheduler->Tick(when - scheduler->Now());
+    } else if (when > stats->totalTicks) {	// not time yet, leave it
 	return FALSE;
     }
+    PendingInterrupt *toOccur = pending->Remove(&when);
 
 // Check if there is nothing more to do, and if so, quit
     if ((status == IdleMode) && (toOccur->type == TimerInt) 
 				&& pending->IsEmpty()) {
-	 pending->SortedInsert(toOccur, when);
+	 pending->Insert(toOccur, when);
 	 return FALSE;
     }
 
@@ -342,10 +369,8 @@ Interrupt::CheckIfDue(bool advanceClock)
 //----------------------------------------------------------------------
 
 static void
-PrintPending(int arg)
+PrintPending(PendingInterrupt *pend)
 {
-    PendingInterrupt *pend = (PendingInterrupt *)arg;
-
     printf("Interrupt handler %s, scheduled at %d\n", 
 	intTypeNames[pend->type], pend->when);
 }
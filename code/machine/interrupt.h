@@ -61,6 +61,8 @@ class PendingInterrupt {
     PendingInterrupt(VoidFunctionPtr func, int param, int time, IntType kind);
 				// initialize an interrupt that will
 				// occur in the future
+    void *operator new(size_t size);	// PendingInterrupts come from an
+    void operator delete(void *p);	// ObjectCache (see slab.h)
 
     VoidFunctionPtr handler;    // The function (in the hardware device
 				// emulator) to call when the interrupt occurs
@@ -114,7 +116,8 @@ class Interrupt {
 
   private:
     IntStatus level;		// are interrupts enabled or disabled?
-    List *pending;		// the list of interrupts scheduled
+    SortedList<PendingInterrupt *, int> *pending;
+				// the list of interrupts scheduled
 				// to occur in the future
     bool inHandler;		// TRUE if we are running an interrupt handler
     bool yieldOnReturn; 	// TRUE if we are to context switch
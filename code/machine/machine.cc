@@ -63,15 +63,18 @@ Machine::Machine(bool debug)
       	mainMemory[i] = 0;
 #ifdef USE_TLB
     tlb = new TranslationEntry[TLBSize];
-    for (i = 0; i < TLBSize; i++)
+    for (i = 0; i < TLBSize; i++) {
 	tlb[i].valid = FALSE;
+	tlb[i].numPages = 1;
+    }
     pageTable = NULL;
-#else	// use linear page table
+#else	// use a page table
     tlb = NULL;
     pageTable = NULL;
 #endif
 
     singleStep = debug;
+    fetching = FALSE;
     CheckEndian();
 }
 
@@ -99,8 +99,12 @@ Machine::OneInstruction(Instruction *instr)
 				// in the future
 
     // Fetch instruction 
-    if (!machine->ReadMem(registers[PCReg], 4, &raw))
+    fetching = TRUE;
+    if (!machine->ReadMem(registers[PCReg], 4, &raw)) {
+	fetching = FALSE;
 	return;			// exception occurred
+    }
+    fetching = FALSE;
     instr->value = raw;
     instr->Decode();
 
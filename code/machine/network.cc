@@ -10,10 +10,23 @@
 
 #include "copyright.h"
 #include "system.h"
+#include "slab.h"
 #ifdef HOST_SPARC
 #include <strings.h>
 #endif
 
+// cache of MaxWireSize buffers, for assembling packets on their
+// way to and from the socket
+static ObjectCache *wireCache = NULL;
+
+static char *
+AllocWireBuffer()
+{
+    if (wireCache == NULL)
+	wireCache = new ObjectCache("wire buffers", MaxWireSize, 4);
+    return (char *) wireCache->Alloc();
+}
+
 // Dummy functions because C++ can't call member functions indirectly 
 static void NetworkReadPoll(int arg)
 { Network *net = (Network *)arg; net->CheckPktAvail(); }
@@ -65,18 +78,29 @@ Network::CheckPktAvail()
 
     if (inHdr.length != 0) 	// do nothing if packet is already buffered
 	return;		
-    if (!PollSocket(sock)) 	// do nothing if no packet to be read
-	return;
 
-    // otherwise, read packet in
-    char *buffer = new char[MaxWireSize];
-    ReadFromSocket(sock, buffer, MaxWireSize);
+    char *buffer;
+    if ((replayLog != NULL) && replayLog->IsReplaying()) {
+	if (!replayLog->Pending(NetworkEvent))	// packet arrived at this 
+	    return;				// poll in the recorded run?
+	buffer = AllocWireBuffer();
+	replayLog->LogData(NetworkEvent, buffer, MaxWireSize);
+    } else {
+	if (!PollSocket(sock)) 	// do nothing if no packet to be read
+	    return;
+
+	// otherwise, read packet in
+	buffer = AllocWireBuffer();
+	ReadFromSocket(sock, buffer, MaxWireSize);
+	if (replayLog != NULL)
+	    replayLog->LogData(NetworkEvent, buffer, MaxWireSize);
+    }
 
     // divide packet into header and data
     inHdr = *(PacketHeader *)buffer;
     ASSERT((inHdr.to == ident) && (inHdr.length <= MaxPacketSize));
     bcopy(buffer + sizeof(PacketHeader), inbox, inHdr.length);
-    delete []buffer ;
+    wireCache->Free(buffer);
 
     DEBUG('n', "Network received packet from %d, length %d...\n",
 	  				(int) inHdr.from, inHdr.length);
@@ -118,12 +142,17 @@ Network::Send(PacketHeader hdr, char* data)
 	return;
     }
 
+    // the other machines aren't running when we replay a run; their
+    // side of the conversation comes from the log
+    if ((replayLog != NULL) && replayLog->IsReplaying())
+	return;
+
     // concatenate hdr and data into a single buffer, and send it out
-    char *buffer = new char[MaxWireSize];
+    char *buffer = AllocWireBuffer();
     *(PacketHeader *)buffer = hdr;
     bcopy(data, buffer + sizeof(PacketHeader), hdr.length);
     SendToSocket(sock, buffer, MaxWireSize, toName);
-    delete []buffer;
+    wireCache->Free(buffer);
 }
 
 // read a packet, if one is buffered
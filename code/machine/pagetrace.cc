@@ -0,0 +1,113 @@
+// pagetrace.cc
+//	Routines to record the pages a user program touches, for
+//	offline analysis by ../bin/pfanalyze.
+//
+//	Runs of references to the same page are folded into one record
+//	as they come in, which keeps the trace down to a fraction of the
+//	size of the reference string itself.
+//
+// Copyright (c) 1992-1993 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#include "copyright.h"
+#include "pagetrace.h"
+#include "system.h"
+
+//----------------------------------------------------------------------
+// PageTrace::PageTrace
+// 	Create a trace file and write its header.
+//
+//	"fileName" -- UNIX file to hold the trace
+//----------------------------------------------------------------------
+
+PageTrace::PageTrace(char *fileName)
+{
+    PFTraceHeader header;
+
+    name = fileName;
+    haveLast = FALSE;
+    numReferences = numRecords = numFaults = 0;
+    file = fopen(fileName, "wb");
+    if (file == NULL) {
+	printf("Page trace: couldn't open trace file %s\n", fileName);
+	Abort();
+    }
+    header.magic = PFTRACEMAGIC;
+    header.pageSize = PageSize;
+    fwrite((char *) &header, sizeof(header), 1, file);
+}
+
+//----------------------------------------------------------------------
+// PageTrace::~PageTrace
+// 	Write out the last run of references, and close the trace.
+//----------------------------------------------------------------------
+
+PageTrace::~PageTrace()
+{
+    if (haveLast)
+	WriteLast();
+    fclose(file);
+}
+
+//----------------------------------------------------------------------
+// PageTrace::WriteLast
+// 	Append the run of references we have been collecting to the file.
+//----------------------------------------------------------------------
+
+void
+PageTrace::WriteLast()
+{
+    fwrite((char *) &last, sizeof(last), 1, file);
+    numRecords++;
+    haveLast = FALSE;
+}
+
+//----------------------------------------------------------------------
+// PageTrace::Reference
+// 	Record a reference to user memory.  If it is to the same page
+//	as the run before it, it just joins that run.
+//
+//	"space" -- the number of the address space doing it
+//	"virtAddr" -- the virtual address it touched
+//	"writing" -- TRUE for a store
+//	"fault" -- TRUE if the address didn't translate
+//----------------------------------------------------------------------
+
+void
+PageTrace::Reference(int space, int virtAddr, bool writing, bool fault)
+{
+    unsigned int vpn = ((unsigned) virtAddr / PageSize) & 0xffff;
+					// the low 16 bits, enough to tell
+					// apart the stack at the top of
+					// user memory from the program
+    if (fault)				// it will be made again, and
+	numFaults++;			// counted then, once the fault
+    else				// has been handled
+	numReferences++;
+    if (haveLast && !fault && !(last.flags & PFTRACE_FAULT)
+		&& (last.space == space) && (last.page == vpn)) {
+	if (writing)
+	    last.flags |= PFTRACE_WRITE;
+	return;
+    }
+    if (haveLast)
+	WriteLast();
+    last.when = stats->totalTicks;
+    last.page = vpn;
+    last.space = space;
+    last.flags = (writing ? PFTRACE_WRITE : 0) | (fault ? PFTRACE_FAULT : 0);
+    haveLast = TRUE;
+}
+
+//----------------------------------------------------------------------
+// PageTrace::Print
+// 	Print how many references were traced.
+//----------------------------------------------------------------------
+
+void
+PageTrace::Print()
+{
+    printf("Page trace: %d references, %d faults, in %d records to %s\n",
+	numReferences, numFaults, numRecords + (haveLast ? 1 : 0), name);
+}
@@ -0,0 +1,52 @@
+// pagetrace.h
+//	Data structures to record every page a user program touches.
+//
+//	With "nachos -pt <file>", each read and write of user memory
+//	that goes through Machine::ReadMem and Machine::WriteMem -- every
+//	instruction fetch, load and store -- is written to a trace file,
+//	with the address space, the virtual page, the tick, whether it
+//	wrote, and whether its translation faulted.  The format of the
+//	file is defined in ../bin/pftrace.h, and ../bin/pfanalyze reads it
+//	back to work out working-set sizes, reuse distances and how many
+//	faults FIFO, LRU, clock and OPT replacement would take with each
+//	number of page frames.
+//
+//	Copies made by the kernel, for system calls, don't go through
+//	ReadMem and WriteMem, so they aren't in the trace.
+//
+// Copyright (c) 1992-1993 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#ifndef PAGETRACE_H
+#define PAGETRACE_H
+
+#include "copyright.h"
+#include "utility.h"
+#include "pftrace.h"
+
+// The following class defines a page reference trace, being recorded.
+
+class PageTrace {
+  public:
+    PageTrace(char *fileName);	// Start a trace in "fileName"
+    ~PageTrace();		// Write out the last record, and close it
+
+    void Reference(int space, int virtAddr, bool writing, bool fault);
+				// Record a reference to user memory
+
+    void Print();		// print how much was traced
+
+  private:
+    FILE *file;			// the trace file
+    char *name;			// its name, for messages
+    PFTraceRecord last;		// the run of references not yet written
+    bool haveLast;		// is there one?
+    int numReferences;		// references traced
+    int numRecords;		// records written
+    int numFaults;		// references whose translation failed
+
+    void WriteLast();		// write out "last"
+};
+
+#endif // PAGETRACE_H
@@ -0,0 +1,203 @@
+// replay.cc
+//	Routines to record the nondeterministic inputs to a Nachos run,
+//	and to play them back, so that the run can be reproduced exactly.
+//
+//	The log is a sequence of fixed-size ReplayRecords, each optionally
+//	followed by a few bytes of device data.  Records are written in
+//	the order that the simulation consumes them, so in replay mode
+//	we just read them back in order, checking as we go that the
+//	simulation is asking for the same kind of input at the same
+//	simulated time.
+//
+//	Remember -- nothing in here is part of Nachos.  It is just
+//	part of the emulation of the hardware that Nachos runs on.
+//
+// Copyright (c) 1992-1993 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#include "copyright.h"
+#include "replay.h"
+#include "system.h"
+
+// String definitions for debugging messages
+static char *eventNames[] = { "random", "timer", "console", "network" };
+
+//----------------------------------------------------------------------
+// ReplayLog::ReplayLog
+// 	Open a log file, either to record a new run into, or to replay
+//	an old run from.
+//
+//	"fileName" -- UNIX file holding the log
+//	"replay" -- if TRUE, read the log back; otherwise record a new one
+//----------------------------------------------------------------------
+
+ReplayLog::ReplayLog(char *fileName, bool replay)
+{
+    name = fileName;
+    replaying = replay;
+    havePeek = FALSE;
+    numEvents = 0;
+    file = fopen(fileName, replay ? "rb" : "wb");
+    if (file == NULL) {
+	printf("Replay: couldn't open log file %s\n", fileName);
+	Abort();
+    }
+    DEBUG('r', "%s log %s\n", replay ? "Replaying" : "Recording", fileName);
+}
+
+//----------------------------------------------------------------------
+// ReplayLog::~ReplayLog
+// 	Flush and close the log file.
+//----------------------------------------------------------------------
+
+ReplayLog::~ReplayLog()
+{
+    fclose(file);
+}
+
+//----------------------------------------------------------------------
+// ReplayLog::Next
+// 	Read the next record from the log, in replay mode.
+//	Returns FALSE if we have reached the end of the log.
+//----------------------------------------------------------------------
+
+bool
+ReplayLog::Next(ReplayRecord *rec)
+{
+    if (havePeek) {
+	*rec = peek;
+	havePeek = FALSE;
+	return TRUE;
+    }
+    return fread((char *) rec, sizeof(ReplayRecord), 1, file) == 1;
+}
+
+//----------------------------------------------------------------------
+// ReplayLog::Diverged
+// 	The replayed run is asking for an input the recorded run did
+//	not.  From here on the two runs can't be compared, so stop.
+//
+//	"type" -- the kind of input the simulation asked for
+//	"rec" -- the record that was found in the log instead
+//		(NULL if the log ran out)
+//----------------------------------------------------------------------
+
+void
+ReplayLog::Diverged(ReplayEventType type, ReplayRecord *rec)
+{
+    printf("Replay of %s diverged at time %d, after %d events: ",
+	name, stats->totalTicks, numEvents);
+    if (rec == NULL)
+	printf("wanted %s input, but the log is exhausted.\n",
+		eventNames[type]);
+    else
+	printf("wanted %s input, but the log has %s input at time %d.\n",
+		eventNames[type], eventNames[rec->type], rec->when);
+    fflush(stdout);
+    Abort();
+}
+
+//----------------------------------------------------------------------
+// ReplayLog::Log
+// 	Called by the machine emulation each time it gets a
+//	nondeterministic value from the host.  In record mode, save the
+//	value in the log; in replay mode, substitute the recorded value.
+//
+//	"type" -- where the value came from
+//	"value" -- the value the host supplied (ignored in replay mode)
+//----------------------------------------------------------------------
+
+int
+ReplayLog::Log(ReplayEventType type, int value)
+{
+    ReplayRecord rec;
+
+    if (!replaying) {
+	rec.type = type;
+	rec.when = stats->totalTicks;
+	rec.value = value;
+	rec.size = 0;
+	fwrite((char *) &rec, sizeof(ReplayRecord), 1, file);
+    } else {
+	if (!Next(&rec))
+	    Diverged(type, NULL);
+	if ((rec.type != type) || (rec.when != stats->totalTicks)
+		|| (rec.size != 0))
+	    Diverged(type, &rec);
+	value = rec.value;
+    }
+    numEvents++;
+    DEBUG('r', "%s event %d at time %d\n", eventNames[type], value,
+		stats->totalTicks);
+    return value;
+}
+
+//----------------------------------------------------------------------
+// ReplayLog::LogData
+// 	Like Log, but for a buffer of device input (an incoming packet).
+//
+//	"type" -- the device the data arrived on
+//	"data" -- the bytes that arrived; in replay mode, filled in
+//		from the log
+//	"size" -- the number of bytes
+//----------------------------------------------------------------------
+
+void
+ReplayLog::LogData(ReplayEventType type, char *data, int size)
+{
+    ReplayRecord rec;
+
+    if (!replaying) {
+	rec.type = type;
+	rec.when = stats->totalTicks;
+	rec.value = 0;
+	rec.size = size;
+	fwrite((char *) &rec, sizeof(ReplayRecord), 1, file);
+	fwrite(data, sizeof(char), size, file);
+    } else {
+	if (!Next(&rec))
+	    Diverged(type, NULL);
+	if ((rec.type != type) || (rec.when != stats->totalTicks)
+		|| (rec.size != size))
+	    Diverged(type, &rec);
+	if (fread(data, sizeof(char), size, file) != (unsigned) size)
+	    Diverged(type, NULL);
+    }
+    numEvents++;
+    DEBUG('r', "%s data, %d bytes at time %d\n", eventNames[type], size,
+		stats->totalTicks);
+}
+
+//----------------------------------------------------------------------
+// ReplayLog::Pending
+// 	In replay mode, return TRUE if the next record in the log is
+//	an input of type "type" that arrived at the current simulated
+//	time.  Devices that poll the host (the console and the network)
+//	only log something when input actually arrives, so they use this
+//	to decide whether there is anything to replay on this poll.
+//----------------------------------------------------------------------
+
+bool
+ReplayLog::Pending(ReplayEventType type)
+{
+    ASSERT(replaying);
+    if (!havePeek) {
+	if (fread((char *) &peek, sizeof(ReplayRecord), 1, file) != 1)
+	    return FALSE;
+	havePeek = TRUE;
+    }
+    return (peek.type == type) && (peek.when == stats->totalTicks);
+}
+
+//----------------------------------------------------------------------
+// ReplayLog::Print
+// 	Print how many nondeterministic inputs were recorded or replayed.
+//----------------------------------------------------------------------
+
+void
+ReplayLog::Print()
+{
+    printf("Replay: %s %d events %s %s\n", replaying ? "replayed" : "recorded",
+	numEvents, replaying ? "from" : "to", name);
+}
@@ -0,0 +1,90 @@
+// replay.h
+//	Data structures to record and replay the nondeterministic inputs
+//	to the machine emulation.
+//
+//	Given the same kernel code, a Nachos run is completely determined
+//	by a handful of inputs from outside the simulation:
+//		the values returned by Random() (random yields with -rs,
+//		  network packet loss, and the test cases themselves)
+//		the interval until each timer interrupt
+//		the characters typed at the console, and when they arrive
+//		the packets arriving from other Nachos machines
+//
+//	In record mode, each of these is appended to a log file, tagged
+//	with the simulated time at which it happened.  In replay mode,
+//	the log is read back, and the devices take their inputs from the
+//	log instead of from the host, so that the run is reproduced
+//	tick for tick.  If the replayed run asks for a different input
+//	than the one that was recorded (the kernel has diverged from the
+//	recorded schedule), we say so and abort.
+//
+// Copyright (c) 1992-1993 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#ifndef REPLAY_H
+#define REPLAY_H
+
+#include "copyright.h"
+#include "utility.h"
+
+// ReplayEventType records which source of nondeterminism an entry
+// in the log came from.
+enum ReplayEventType { RandomEvent, TimerEvent, ConsoleEvent, NetworkEvent };
+
+// The following class defines one entry in the log, as it is
+// stored in the log file.  Console and network entries are followed
+// in the file by "size" bytes of data.
+
+class ReplayRecord {
+  public:
+    int type;			// ReplayEventType of this entry
+    int when;			// stats->totalTicks when it happened
+    int value;			// the value returned to the simulation
+    int size;			// bytes of data following this record
+};
+
+// The following class defines the record/replay log.  The machine
+// emulation calls Log() at each point where it would otherwise consult
+// the host; in record mode the value is written to the log and
+// returned unchanged, in replay mode it is replaced with the value
+// from the log.
+
+class ReplayLog {
+  public:
+    ReplayLog(char *fileName, bool replay);
+				// Open "fileName" to record a new log,
+				// or to replay an old one
+    ~ReplayLog();		// flush and close the log
+
+    bool IsRecording() { return !replaying; }
+    bool IsReplaying() { return replaying; }
+
+    int Log(ReplayEventType type, int value);
+				// Record "value", or return the recorded
+				// value in its place
+    void LogData(ReplayEventType type, char *data, int size);
+				// Record "size" bytes of device input,
+				// or copy the recorded bytes into "data"
+    bool Pending(ReplayEventType type);
+				// In replay mode, is the next entry in the
+				// log a "type" event due at the current tick?
+				// Used for inputs that only appear now and
+				// then (console characters, packets)
+
+    void Print();		// print how many events were logged
+
+  private:
+    FILE *file;			// the log file
+    char *name;			// its name, for error messages
+    bool replaying;		// TRUE if reading the log back
+    bool havePeek;		// TRUE if "peek" holds the next record
+    ReplayRecord peek;		// the next unread record, in replay mode
+    int numEvents;		// number of records logged or replayed
+
+    bool Next(ReplayRecord *rec);	// read the next record in the log
+    void Diverged(ReplayEventType type, ReplayRecord *rec);
+					// report a mismatch and abort
+};
+
+#endif // REPLAY_H
@@ -10,6 +10,7 @@
 #include "copyright.h"
 #include "utility.h"
 #include "stats.h"
+#include <time.h>
 
 //----------------------------------------------------------------------
 // Statistics::Statistics
@@ -21,7 +22,11 @@ Statistics::Statistics()
     totalTicks = idleTicks = systemTicks = userTicks = 0;
     numDiskReads = numDiskWrites = 0;
     numConsoleCharsRead = numConsoleCharsWritten = 0;
-    numPageFaults = numPacketsSent = numPacketsRecvd = 0;
+    numPageFaults = numTLBMisses = numPacketsSent = numPacketsRecvd = 0;
+    numContextSwitches = numTimerInterrupts = 0;
+    userExited = FALSE;
+    userExitStatus = 0;
+    hostStart = (long) clock();
 }
 
 //----------------------------------------------------------------------
@@ -38,7 +43,17 @@ Statistics::Print()
     printf("Disk I/O: reads %d, writes %d\n", numDiskReads, numDiskWrites);
     printf("Console I/O: reads %d, writes %d\n", numConsoleCharsRead, 
 	numConsoleCharsWritten);
-    printf("Paging: faults %d\n", numPageFaults);
+    printf("Paging: faults %d, TLB misses %d\n", numPageFaults,
+	numTLBMisses);
     printf("Network I/O: packets received %d, sent %d\n", numPacketsRecvd, 
 	numPacketsSent);
+    printf("Threads: context switches %d\n", numContextSwitches);
+    printf("Timer: interrupts %d\n", numTimerInterrupts);
+    if (userExited)
+	printf("User program: exit status %d\n", userExitStatus);
+
+    // a tick is about a microsecond, so a simulated second is 1000000 ticks
+    double hostMs = (clock() - hostStart) * 1000.0 / CLOCKS_PER_SEC;
+    printf("Host CPU: %d ms, %d ms per simulated second\n", (int) hostMs,
+	(totalTicks > 0) ? (int) (hostMs * 1000000.0 / totalTicks) : 0);
 }
@@ -33,8 +33,16 @@ class Statistics {
     int numConsoleCharsRead;	// number of characters read from the keyboard
     int numConsoleCharsWritten; // number of characters written to the display
     int numPageFaults;		// number of virtual memory page faults
+    int numTLBMisses;		// number of times the TLB was refilled
     int numPacketsSent;		// number of packets sent over the network
     int numPacketsRecvd;	// number of packets received over the network
+    int numContextSwitches;	// number of times the CPU switched threads
+    int numTimerInterrupts;	// number of time-slice interrupts taken
+    bool userExited;		// has the first user program called Exit?
+    int userExitStatus;		// and if so, with what status
+
+    long hostStart;		// host CPU clock when Nachos started, to
+				// measure host time per simulated second
 
     Statistics(); 		// initialize everything to zero
 
@@ -35,6 +35,9 @@ extern "C" {
 #include <sys/file.h>
 #include <sys/un.h>
 #include <sys/mman.h>
+#include <sys/wait.h>
+#include <errno.h>
+#include <stdlib.h>
 #ifdef HOST_i386
 #include <unistd.h>
 #include <sys/time.h>
@@ -438,6 +441,108 @@ Exit(int exitCode)
     exit(exitCode);
 }
 
+//----------------------------------------------------------------------
+// NumHostCPUs
+// 	Return how many CPUs the host has, so that we know how many
+//	copies of Nachos can usefully run at once.
+//----------------------------------------------------------------------
+
+int
+NumHostCPUs()
+{
+    int n = (int) sysconf(_SC_NPROCESSORS_ONLN);
+
+    return (n > 0) ? n : 1;
+}
+
+//----------------------------------------------------------------------
+// StartChild
+// 	Fork the UNIX process running Nachos.  The child carries on from
+//	here with a copy of everything, except that its standard output
+//	and standard error go to "outputFd".
+//
+// Returns:
+//	0 in the child; in the parent, the child's process id.
+//----------------------------------------------------------------------
+
+int
+StartChild(int outputFd)
+{
+    int pid;
+
+    fflush(stdout);			// or the child would print
+    fflush(stderr);			// whatever is still buffered
+    pid = fork();
+    ASSERT(pid >= 0);
+    if (pid == 0) {
+	dup2(outputFd, 1);
+	dup2(outputFd, 2);
+	close(outputFd);
+    }
+    return pid;
+}
+
+//----------------------------------------------------------------------
+// WaitForChild
+// 	Wait for one of the processes started by StartChild to finish.
+//
+//	"exitCode" -- set to the child's exit code, or to minus the
+//	number of the signal that killed it
+//
+// Returns:
+//	The child's process id, or -1 if there are no children left.
+//----------------------------------------------------------------------
+
+int
+WaitForChild(int *exitCode)
+{
+    int status;
+    int pid;
+
+    do {
+	pid = waitpid(-1, &status, 0);
+    } while ((pid < 0) && (errno == EINTR));
+    if (pid < 0)
+	return -1;
+    if (WIFEXITED(status))
+	*exitCode = WEXITSTATUS(status);
+    else
+	*exitCode = -WTERMSIG(status);
+    return pid;
+}
+
+//----------------------------------------------------------------------
+// OpenTempFile
+// 	Open a new, empty scratch file, which goes away when it is
+//	closed (and when Nachos exits).
+//----------------------------------------------------------------------
+
+int
+OpenTempFile()
+{
+    char name[] = "/tmp/nachosXXXXXX";
+    int fd = mkstemp(name);
+
+    ASSERT(fd >= 0);
+    unlink(name);
+    return fd;
+}
+
+//----------------------------------------------------------------------
+// HostMilliseconds
+// 	Return the host's wall clock time, in milliseconds, for timing
+//	things on the host (rather than in simulated ticks).
+//----------------------------------------------------------------------
+
+int
+HostMilliseconds()
+{
+    struct timeval tv;
+
+    gettimeofday(&tv, NULL);
+    return (int) ((tv.tv_sec % 1000000) * 1000 + tv.tv_usec / 1000);
+}
+
 //----------------------------------------------------------------------
 // RandomInit
 // 	Initialize the pseudo-random number generator.  We use the
@@ -452,13 +557,18 @@ RandomInit(unsigned seed)
 
 //----------------------------------------------------------------------
 // Random
-// 	Return a pseudo-random number.
+// 	Return a pseudo-random number.  If we are recording or replaying
+//	a run, the number goes through the replay log.
 //----------------------------------------------------------------------
 
 int 
 Random()
 {
-    return rand();
+    int value = rand();
+
+    if (replayLog != NULL)
+	value = replayLog->Log(RandomEvent, value);
+    return value;
 }
 
 //----------------------------------------------------------------------
@@ -43,6 +43,13 @@ extern void Abort();
 extern void Exit(int exitCode);
 extern void Delay(int seconds);
 
+// Running several copies of Nachos at once (see threads/batch.h)
+extern int NumHostCPUs();
+extern int StartChild(int outputFd);
+extern int WaitForChild(int *exitCode);
+extern int OpenTempFile();
+extern int HostMilliseconds();
+
 // Initialize system so that cleanUp routine is called when user hits ctl-C
 extern void CallOnUserAbort(VoidNoArgFunctionPtr cleanUp);
 
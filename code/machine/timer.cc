@@ -46,21 +46,59 @@ Timer::Timer(VoidFunctionPtr timerHandler, int callArg, bool doRandom)
     randomize = doRandom;
     handler = timerHandler;
     arg = callArg; 
+    running = FALSE;
+    scheduled = FALSE;
 
     // schedule the first interrupt from the timer device
-    interrupt->Schedule(TimerHandler, (int) this, TimeOfNextInterrupt(), 
-		TimerInt); 
+    Start();
+}
+
+//----------------------------------------------------------------------
+// Timer::Start
+//      Start the timer generating interrupts, if it was stopped.
+//	Unless an interrupt is still on its way from before it was
+//	stopped, schedule the first one a time slice from now.
+//----------------------------------------------------------------------
+
+void
+Timer::Start()
+{
+    if (running)
+	return;
+    running = TRUE;
+    if (!scheduled) {
+	scheduled = TRUE;
+	interrupt->Schedule(TimerHandler, (int) this, TimeOfNextInterrupt(), 
+		TimerInt);
+    }
+}
+
+//----------------------------------------------------------------------
+// Timer::Stop
+//      Stop the timer generating interrupts, until Start is called.
+//----------------------------------------------------------------------
+
+void
+Timer::Stop()
+{
+    running = FALSE;
 }
 
 //----------------------------------------------------------------------
 // Timer::TimerExpired
 //      Routine to simulate the interrupt generated by the hardware 
 //	timer device.  Schedule the next interrupt, and invoke the
-//	interrupt handler.
+//	interrupt handler -- unless the timer has been stopped.
 //----------------------------------------------------------------------
 void 
 Timer::TimerExpired() 
 {
+    if (!running) {			// stopped since this was scheduled
+	scheduled = FALSE;
+	return;
+    }
+    stats->numTimerInterrupts++;
+
     // schedule the next timer device interrupt
     interrupt->Schedule(TimerHandler, (int) this, TimeOfNextInterrupt(), 
 		TimerInt);
@@ -78,8 +116,13 @@ Timer::TimerExpired()
 int 
 Timer::TimeOfNextInterrupt() 
 {
+    int delay;
+
     if (randomize)
-	return 1 + (Random() % (TimerTicks * 2));
+	delay = 1 + (Random() % (TimerTicks * 2));
     else
-	return TimerTicks; 
+	delay = TimerTicks; 
+    if (replayLog != NULL)		// time slices are part of the
+	delay = replayLog->Log(TimerEvent, delay);	// recorded schedule
+    return delay;
 }
@@ -11,6 +11,13 @@
 //	In order to introduce some randomness into time-slicing, if "doRandom"
 //	is set, then the interrupt comes after a random number of ticks.
 //
+//	The kernel can stop the timer when there is nothing for it to do --
+//	no other thread that could be given the CPU, and no one waiting for
+//	a timer interrupt -- and start it again when there is.  Stopping
+//	it masks the interrupt rather than taking it back: one that is
+//	already on its way still arrives, and is dropped.  If the timer is
+//	started again before that, it carries on where it was.
+//
 //  DO NOT CHANGE -- part of the machine emulation
 //
 // Copyright (c) 1992-1993 The Regents of the University of California.
@@ -31,6 +38,10 @@ class Timer {
 				// handler "timerHandler" every time slice.
     ~Timer() {}
 
+    void Start();		// start generating interrupts again
+    void Stop();		// stop, until Start is called
+    bool IsRunning() { return running; }
+
 // Internal routines to the timer emulation -- DO NOT call these
 
     void TimerExpired();	// called internally when the hardware
@@ -43,7 +54,8 @@ class Timer {
     bool randomize;		// set if we need to use a random timeout delay
     VoidFunctionPtr handler;	// timer interrupt handler 
     int arg;			// argument to pass to interrupt handler
-
+    bool running;		// FALSE if the timer has been stopped
+    bool scheduled;		// is an interrupt already on its way?
 };
 
 #endif // TIMER_H
@@ -6,11 +6,12 @@
 //
 // Two types of translation are supported here.
 //
-//	Linear page table -- the virtual page # is used as an index
-//	into the table, to find the physical page #.
+//	Page table -- the virtual page # is split into three indexes,
+//	into the three levels of the table, to find the physical page #.
 //
 //	Translation lookaside buffer -- associative lookup in the table
-//	to find an entry with the same virtual page #.  If found,
+//	to find an entry with the same virtual page #, or a superpage
+//	entry whose run of pages includes it.  If found,
 //	this entry is used for the translation.
 //	If not, it traps to software with an exception. 
 //
@@ -71,6 +72,22 @@ unsigned short
 ShortToMachine(unsigned short shortword) { return ShortToHost(shortword); }
 
 
+//----------------------------------------------------------------------
+// IsPageRun
+// 	Return TRUE if a TLB entry may map "numPages" pages: 1, or the
+//	size of a superpage.
+//----------------------------------------------------------------------
+
+static bool
+IsPageRun(int numPages)
+{
+    int size;
+
+    for (size = 1; size < numPages; size *= SuperPageRatio)
+	;
+    return (size == numPages) && (size <= MaxSuperPage);
+}
+
 //----------------------------------------------------------------------
 // Machine::ReadMem
 //      Read "size" (1, 2, or 4) bytes of virtual memory at "addr" into 
@@ -94,6 +111,15 @@ Machine::ReadMem(int addr, int size, int *value)
     DEBUG('a', "Reading VA 0x%x, size %d\n", addr, size);
     
     exception = Translate(addr, &physicalAddress, size, FALSE);
+    if (pageTrace != NULL)
+	pageTrace->Reference(currentThread->space->Id(), addr, FALSE,
+		exception != NoException);
+    if ((addrTrace != NULL) && (exception == NoException)) {
+	if (fetching)
+	    addrTrace->Fetch(currentThread->space->Id(), addr);
+	else
+	    addrTrace->Access(currentThread->space->Id(), addr, size, FALSE);
+    }
     if (exception != NoException) {
 	machine->RaiseException(exception, addr);
 	return FALSE;
@@ -143,6 +169,11 @@ Machine::WriteMem(int addr, int size, int value)
     DEBUG('a', "Writing VA 0x%x, size %d, value 0x%x\n", addr, size, value);
 
     exception = Translate(addr, &physicalAddress, size, TRUE);
+    if (pageTrace != NULL)
+	pageTrace->Reference(currentThread->space->Id(), addr, TRUE,
+		exception != NoException);
+    if ((addrTrace != NULL) && (exception == NoException))
+	addrTrace->Access(currentThread->space->Id(), addr, size, TRUE);
     if (exception != NoException) {
 	machine->RaiseException(exception, addr);
 	return FALSE;
@@ -208,20 +239,20 @@ Machine::Translate(int virtAddr, int* physAddr, int size, bool writing)
     vpn = (unsigned) virtAddr / PageSize;
     offset = (unsigned) virtAddr % PageSize;
     
-    if (tlb == NULL) {		// => page table => vpn is index into table
-	if (vpn >= pageTableSize) {
-	    DEBUG('a', "virtual page # %d too large for page table size %d!\n", 
-			virtAddr, pageTableSize);
+    if (tlb == NULL) {		// => page table => walk it to find vpn
+	if (vpn >= NumVirtPages) {
+	    DEBUG('a', "virtual page # %d beyond user memory!\n", vpn);
 	    return AddressErrorException;
-	} else if (!pageTable[vpn].valid) {
-	    DEBUG('a', "virtual page # %d too large for page table size %d!\n", 
-			virtAddr, pageTableSize);
+	}
+	entry = pageTable->Lookup(vpn);
+	if ((entry == NULL) || !entry->valid) {
+	    DEBUG('a', "virtual page # %d not mapped in page table!\n", vpn);
 	    return PageFaultException;
 	}
-	entry = &pageTable[vpn];
     } else {
         for (entry = NULL, i = 0; i < TLBSize; i++)
-    	    if (tlb[i].valid && (((unsigned int)tlb[i].virtualPage) == vpn)) {
+    	    if (tlb[i].valid && ((vpn - (unsigned int) tlb[i].virtualPage)
+				< (unsigned int) tlb[i].numPages)) {
 		entry = &tlb[i];			// FOUND!
 		break;
 	    }
@@ -231,6 +262,13 @@ Machine::Translate(int virtAddr, int* physAddr, int size, bool writing)
 						// the page may be in memory,
 						// but not in the TLB
 	}
+	if (!IsPageRun(entry->numPages)
+		|| (entry->virtualPage % entry->numPages != 0)
+		|| (entry->physicalPage % entry->numPages != 0)) {
+	    DEBUG('a', "*** TLB entry %d maps %d pages at %d, to frame %d!\n",
+		i, entry->numPages, entry->virtualPage, entry->physicalPage);
+	    return BusErrorException;
+	}
     }
 
     if (entry->readOnly && writing) {	// trying to write to a read-only page
@@ -238,6 +276,8 @@ Machine::Translate(int virtAddr, int* physAddr, int size, bool writing)
 	return ReadOnlyException;
     }
     pageFrame = entry->physicalPage;
+    if (tlb != NULL)				// the page's frame, within
+	pageFrame += vpn - entry->virtualPage;	// a superpage
 
     // if the pageFrame is too big, there is something really wrong! 
     // An invalid translation was loaded into the page table or TLB. 
@@ -253,3 +293,113 @@ Machine::Translate(int virtAddr, int* physAddr, int size, bool writing)
     DEBUG('a', "phys addr = 0x%x\n", *physAddr);
     return NoException;
 }
+
+//----------------------------------------------------------------------
+// PageTable::PageTable
+// 	Make a page table with nothing in it: just the top level, all
+//	of it empty.
+//----------------------------------------------------------------------
+
+PageTable::PageTable()
+{
+    for (int i = 0; i < PageTableFanout; i++)
+	top[i] = NULL;
+    numMiddles = numLeaves = 0;
+}
+
+//----------------------------------------------------------------------
+// PageTable::~PageTable
+// 	De-allocate a page table, with every level made for it.
+//----------------------------------------------------------------------
+
+PageTable::~PageTable()
+{
+    int i, j;
+
+    for (i = 0; i < PageTableFanout; i++)
+	if (top[i] != NULL) {
+	    for (j = 0; j < PageTableFanout; j++)
+		if (top[i][j] != NULL)
+		    delete [] top[i][j];
+	    delete [] top[i];
+	}
+}
+
+//----------------------------------------------------------------------
+// PageTable::Lookup
+// 	Walk the page table to the entry for virtual page "vpn".  Return
+//	NULL if the leaf that would hold it, or the middle level that
+//	would lead to that, hasn't been made.
+//----------------------------------------------------------------------
+
+TranslationEntry *
+PageTable::Lookup(unsigned int vpn)
+{
+    TranslationEntry **middle, *leaf;
+
+    if (vpn >= NumVirtPages)
+	return NULL;
+    middle = top[vpn >> (2 * PageTableBits)];
+    if (middle == NULL)
+	return NULL;
+    leaf = middle[(vpn >> PageTableBits) & (PageTableFanout - 1)];
+    if (leaf == NULL)
+	return NULL;
+    return &leaf[vpn & (PageTableFanout - 1)];
+}
+
+//----------------------------------------------------------------------
+// PageTable::Add
+// 	Return the entry for virtual page "vpn", first making the middle
+//	level and the leaf it needs, if they aren't there.  The entries
+//	of a new leaf map their own virtual page, to no frame, and are
+//	invalid.
+//----------------------------------------------------------------------
+
+TranslationEntry *
+PageTable::Add(unsigned int vpn)
+{
+    TranslationEntry **middle, *leaf;
+    unsigned int first;
+    int i;
+
+    ASSERT(vpn < NumVirtPages);
+    middle = top[vpn >> (2 * PageTableBits)];
+    if (middle == NULL) {
+	middle = top[vpn >> (2 * PageTableBits)]
+		= new TranslationEntry *[PageTableFanout];
+	for (i = 0; i < PageTableFanout; i++)
+	    middle[i] = NULL;
+	numMiddles++;
+    }
+    leaf = middle[(vpn >> PageTableBits) & (PageTableFanout - 1)];
+    if (leaf == NULL) {
+	leaf = middle[(vpn >> PageTableBits) & (PageTableFanout - 1)]
+		= new TranslationEntry[PageTableFanout];
+	first = vpn & ~(PageTableFanout - 1);
+	for (i = 0; i < PageTableFanout; i++) {
+	    leaf[i].virtualPage = first + i;
+	    leaf[i].physicalPage = -1;
+	    leaf[i].valid = FALSE;
+	    leaf[i].readOnly = FALSE;
+	    leaf[i].use = FALSE;
+	    leaf[i].dirty = FALSE;
+	    leaf[i].numPages = 1;
+	}
+	numLeaves++;
+    }
+    return &leaf[vpn & (PageTableFanout - 1)];
+}
+
+//----------------------------------------------------------------------
+// PageTable::NumBytes
+// 	Return how much memory the page table takes, all levels together.
+//----------------------------------------------------------------------
+
+int
+PageTable::NumBytes()
+{
+    return sizeof(PageTable)
+	+ numMiddles * PageTableFanout * sizeof(TranslationEntry *)
+	+ numLeaves * PageTableFanout * sizeof(TranslationEntry);
+}
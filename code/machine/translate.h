@@ -9,6 +9,14 @@
 //	Either way, each entry is of the form:
 //	<virtual page #, physical page #>.
 //
+//	Page tables have three levels, so that a sparse address space --
+//	a program at the bottom, and its stack at the top -- only takes
+//	as much table as it has pages in use.
+//
+//	A TLB entry can also map a superpage: a run of 4 or 16 pages
+//	(up to MaxSuperPage), contiguous and aligned to its size both
+//	in virtual and in physical memory, with one entry.
+//
 // DO NOT CHANGE -- part of the machine emulation
 //
 // Copyright (c) 1992-1993 The Regents of the University of California.
@@ -23,7 +31,8 @@
 
 // The following class defines an entry in a translation table -- either
 // in a page table or a TLB.  Each entry defines a mapping from one 
-// virtual page to one physical page.
+// virtual page to one physical page -- or, in the TLB, from "numPages"
+// virtual pages to as many physical pages.
 // In addition, there are some extra bits for access control (valid and 
 // read-only) and some bits for usage information (use and dirty).
 
@@ -40,6 +49,47 @@ class TranslationEntry {
 			// page is referenced or modified.
     bool dirty;         // This bit is set by the hardware every time the
 			// page is modified.
+    int numPages;	// The number of pages mapped: 1, or the size of
+			// a superpage, in which case both page numbers
+			// must be multiples of it.  Only the TLB looks
+			// at this; a page table has an entry per page.
+};
+
+#define PageTableBits	8		// bits of the virtual page # that
+					// index each level of a page table
+#define PageTableFanout	(1 << PageTableBits)
+#define NumVirtPages	(1 << (3 * PageTableBits))
+					// pages a user program can address:
+					// the low 2GB, with 128-byte pages
+
+// The following class defines a page table, as the hardware walks it
+// when there is no TLB.  The top level has an entry for each 2^16
+// virtual pages, pointing to a middle level, which has an entry for
+// each 2^8 of them, pointing to a leaf: an array of TranslationEntry's.
+// Only the top level is made with the table; a middle level or a leaf
+// is made the first time a page in its part of the address space is
+// added, and its entries start out invalid.
+
+class PageTable {
+  public:
+    PageTable();			// Make an empty page table
+    ~PageTable();			// De-allocate it, and all its levels
+
+    TranslationEntry *Lookup(unsigned int vpn);
+					// The entry for virtual page "vpn",
+					// or NULL if no leaf holds it
+    TranslationEntry *Add(unsigned int vpn);
+					// The entry for "vpn", making the
+					// levels that lead to it if need be
+
+    int NumBytes();			// How much memory the table takes
+
+  private:
+    TranslationEntry **top[PageTableFanout];
+					// each a middle level of
+					// PageTableFanout leaves, or NULL
+    int numMiddles;			// middle levels made
+    int numLeaves;			// and leaves
 };
 
 #endif
@@ -18,9 +18,17 @@
 
 #include "copyright.h"
 #include "post.h"
+#include "system.h"
+#include "slab.h"
 #ifdef HOST_SPARC
 #include <strings.h>
 #endif
+
+// Caches for the mail messages queued in mailboxes, and for the
+// buffers PostOffice::Send builds outgoing packets in.
+static ObjectCache *mailCache = NULL;
+static ObjectCache *packetCache = NULL;
+
 //----------------------------------------------------------------------
 // Mail::Mail
 //      Initialize a single mail message, by concatenating the headers to
@@ -40,6 +48,26 @@ Mail::Mail(PacketHeader pktH, MailHeader mailH, char *msgData)
     bcopy(msgData, data, mailHdr.length);
 }
 
+//----------------------------------------------------------------------
+// Mail::operator new, Mail::operator delete
+// 	Get a mail message from the mail cache, and put it back.
+//----------------------------------------------------------------------
+
+void *
+Mail::operator new(size_t size)
+{
+    ASSERT(size == sizeof(Mail));
+    if (mailCache == NULL)
+	mailCache = new ObjectCache("mail", sizeof(Mail), 16);
+    return mailCache->Alloc();
+}
+
+void
+Mail::operator delete(void *p)
+{
+    mailCache->Free(p);
+}
+
 //----------------------------------------------------------------------
 // MailBox::MailBox
 //      Initialize a single mail box within the post office, so that it
@@ -51,7 +79,7 @@ Mail::Mail(PacketHeader pktH, MailHeader mailH, char *msgData)
 
 MailBox::MailBox()
 { 
-    messages = new SynchList(); 
+    messages = new SynchList<Mail *>(); 
 }
 
 //----------------------------------------------------------------------
@@ -88,20 +116,14 @@ PrintHeader(PacketHeader pktHdr, MailHeader mailHdr)
 // 	Add a message to the mailbox.  If anyone is waiting for message
 //	arrival, wake them up!
 //
-//	We need to reconstruct the Mail message (by concatenating the headers
-//	to the data), to simplify queueing the message on the SynchList.
-//
-//	"pktHdr" -- source, destination machine ID's
-//	"mailHdr" -- source, destination mailbox ID's
-//	"data" -- payload message data
+//	"mail" -- the message, with its headers; the mailbox takes it over,
+//		and Get deletes it once it has been read
 //----------------------------------------------------------------------
 
 void 
-MailBox::Put(PacketHeader pktHdr, MailHeader mailHdr, char *data)
+MailBox::Put(Mail *mail)
 { 
-    Mail *mail = new Mail(pktHdr, mailHdr, data); 
-
-    messages->Append((void *)mail);	// put on the end of the list of 
+    messages->Append(mail);	// put on the end of the list of 
 					// arrived messages, and wake up 
 					// any waiters
 }
@@ -122,7 +144,7 @@ void
 MailBox::Get(PacketHeader *pktHdr, MailHeader *mailHdr, char *data) 
 { 
     DEBUG('n', "Waiting for mail in mailbox\n");
-    Mail *mail = (Mail *) messages->Remove();	// remove message from list;
+    Mail *mail = messages->Remove();	// remove message from list;
 						// will wait if list is empty
 
     *pktHdr = mail->pktHdr;
@@ -141,14 +163,15 @@ MailBox::Get(PacketHeader *pktHdr, MailHeader *mailHdr, char *data)
 //----------------------------------------------------------------------
 // PostalHelper, ReadAvail, WriteDone
 // 	Dummy functions because C++ can't indirectly invoke member functions
-//	The first is forked as part of the "postal worker thread; the
-//	later two are called by the network interrupt handler.
+//	The first is run on the kernel work queue, to deliver one arrived
+//	message; the later two are called by the network interrupt handler.
 //
-//	"arg" -- pointer to the Post Office managing the Network
+//	"arg" -- the Mail to deliver (PostalHelper), or pointer to the 
+//		Post Office managing the Network
 //----------------------------------------------------------------------
 
 static void PostalHelper(int arg)
-{ PostOffice* po = (PostOffice *) arg; po->PostalDelivery(); }
+{ postOffice->PostalDelivery((Mail *) arg); }
 static void ReadAvail(int arg)
 { PostOffice* po = (PostOffice *) arg; po->IncomingPacket(); }
 static void WriteDone(int arg)
@@ -160,8 +183,8 @@ static void WriteDone(int arg)
 //	Also initialize the network device, to allow post offices
 //	on different machines to deliver messages to one another.
 //
-//      We use a separate thread "the postal worker" to wait for messages 
-//	to arrive, and deliver them to the correct mailbox.  Note that
+//      Arriving messages are handed to the kernel work queue, whose
+//	workers deliver them to the correct mailbox.  Note that
 //	delivering messages to the mailboxes can't be done directly
 //	by the interrupt handlers, because it requires a Lock.
 //
@@ -176,7 +199,6 @@ static void WriteDone(int arg)
 PostOffice::PostOffice(NetworkAddress addr, double reliability, int nBoxes)
 {
 // First, initialize the synchronization with the interrupt handlers
-    messageAvailable = new Semaphore("message available", 0);
     messageSent = new Semaphore("message sent", 0);
     sendLock = new Lock("message send lock");
 
@@ -187,13 +209,6 @@ PostOffice::PostOffice(NetworkAddress addr, double reliability, int nBoxes)
 
 // Third, initialize the network; tell it which interrupt handlers to call
     network = new Network(addr, reliability, ReadAvail, WriteDone, (int) this);
-
-
-// Finally, create a thread whose sole job is to wait for incoming messages,
-//   and put them in the right mailbox. 
-    Thread *t = new Thread("postal worker");
-
-    t->Fork(PostalHelper, (int) this);
 }
 
 //----------------------------------------------------------------------
@@ -205,44 +220,26 @@ PostOffice::~PostOffice()
 {
     delete network;
     delete [] boxes;
-    delete messageAvailable;
     delete messageSent;
     delete sendLock;
 }
 
 //----------------------------------------------------------------------
 // PostOffice::PostalDelivery
-// 	Wait for incoming messages, and put them in the right mailbox.
+// 	Put an arrived message in the right mailbox.  Runs on a kernel
+//	worker thread, since the mailbox may have to wait for its lock.
 //
-//      Incoming messages have had the PacketHeader stripped off,
-//	but the MailHeader is still tacked on the front of the data.
+//	"mail" -- the message, as unpacked by IncomingPacket
 //----------------------------------------------------------------------
 
 void
-PostOffice::PostalDelivery()
+PostOffice::PostalDelivery(Mail *mail)
 {
-    PacketHeader pktHdr;
-    MailHeader mailHdr;
-    char *buffer = new char[MaxPacketSize];
-
-    for (;;) {
-        // first, wait for a message
-        messageAvailable->P();	
-        pktHdr = network->Receive(buffer);
-
-        mailHdr = *(MailHeader *)buffer;
-        if (DebugIsEnabled('n')) {
-	    printf("Putting mail into mailbox: ");
-	    PrintHeader(pktHdr, mailHdr);
-        }
-
-	// check that arriving message is legal!
-	ASSERT(0 <= mailHdr.to && mailHdr.to < numBoxes);
-	ASSERT(mailHdr.length <= MaxMailSize);
-
-	// put into mailbox
-        boxes[mailHdr.to].Put(pktHdr, mailHdr, buffer + sizeof(MailHeader));
+    if (DebugIsEnabled('n')) {
+	printf("Putting mail into mailbox: ");
+	PrintHeader(mail->pktHdr, mail->mailHdr);
     }
+    boxes[mail->mailHdr.to].Put(mail);
 }
 
 //----------------------------------------------------------------------
@@ -261,8 +258,12 @@ PostOffice::PostalDelivery()
 void
 PostOffice::Send(PacketHeader pktHdr, MailHeader mailHdr, char* data)
 {
-    char* buffer = new char[MaxPacketSize];	// space to hold concatenated
-						// mailHdr + data
+    char* buffer;			// space to hold concatenated
+					// mailHdr + data
+
+    if (packetCache == NULL)
+	packetCache = new ObjectCache("packet buffers", MaxPacketSize, 4);
+    buffer = (char *) packetCache->Alloc();
 
     if (DebugIsEnabled('n')) {
 	printf("Post send: ");
@@ -286,8 +287,8 @@ PostOffice::Send(PacketHeader pktHdr, MailHeader mailHdr, char* data)
 					// ok to send the next message
     sendLock->Release();
 
-    delete [] buffer;			// we've sent the message, so
-					// we can delete our buffer
+    packetCache->Free(buffer);		// we've sent the message, so
+					// we can free our buffer
 }
 
 //----------------------------------------------------------------------
@@ -319,13 +320,27 @@ PostOffice::Receive(int box, PacketHeader *pktHdr,
 // PostOffice::IncomingPacket
 // 	Interrupt handler, called when a packet arrives from the network.
 //
-//	Signal the PostalDelivery routine that it is time to get to work!
+//	Take the packet off the network right away, so the network can
+//	accept the next one, and queue the work of putting it into its
+//	mailbox for PostalDelivery.
+//
+//      Incoming messages have had the PacketHeader stripped off,
+//	but the MailHeader is still tacked on the front of the data.
 //----------------------------------------------------------------------
 
 void
 PostOffice::IncomingPacket()
 { 
-    messageAvailable->V(); 
+    char buffer[MaxPacketSize];
+    PacketHeader pktHdr = network->Receive(buffer);
+    MailHeader mailHdr = *(MailHeader *)buffer;
+
+    // check that arriving message is legal!
+    ASSERT(0 <= mailHdr.to && mailHdr.to < numBoxes);
+    ASSERT(mailHdr.length <= MaxMailSize);
+
+    workQueue->Submit(PostalHelper,
+		(int) new Mail(pktHdr, mailHdr, buffer + sizeof(MailHeader)));
 }
 
 //----------------------------------------------------------------------
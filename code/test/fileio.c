@@ -0,0 +1,50 @@
+/* fileio.c 
+ *    Benchmark program: file I/O patterns.
+ *
+ *    Writes a file sequentially, reads it back sequentially with
+ *    small and large transfers, then checks it, so that the cost of
+ *    a transfer can be split into the part per call and the part per
+ *    byte.  (There is no Seek, so everything is sequential.)
+ */
+
+#include "syscall.h"
+
+#define FileSize	1024
+#define Large		256	/* bytes per large transfer */
+#define Small		16	/* and per small one */
+
+char buffer[Large];
+
+int
+main()
+{
+    OpenFileId file;
+    int i, n, bad = 0;
+
+    for (i = 0; i < Large; i++)
+	buffer[i] = 'a' + i % 26;
+
+    Create("fileio.dat");			/* write it, in small pieces */
+    file = Open("fileio.dat");
+    for (n = 0; n < FileSize; n += Small)
+	Write(&buffer[n % Large], Small, file);
+    Close(file);
+
+    file = Open("fileio.dat");			/* read it, in small pieces */
+    for (n = 0; Read(buffer, Small, file) == Small; n += Small)
+	;
+    Close(file);
+    if (n != FileSize)
+	bad++;
+
+    file = Open("fileio.dat");			/* and in large pieces, */
+    for (n = 0; Read(buffer, Large, file) == Large; n += Large)
+	for (i = 0; i < Large; i++)		/* checking each byte */
+	    if (buffer[i] != 'a' + i % 26)
+		bad++;
+    Close(file);
+    if (n != FileSize)
+	bad++;
+
+    Exit(bad);				/* should be 0 */
+}
@@ -0,0 +1,79 @@
+/* hash.c 
+ *    Benchmark program: an open-addressed hash table of integers.
+ *
+ *    Inserts a stream of pseudo-random keys until the table is three
+ *    quarters full, looks each one up (and some that aren't there),
+ *    then deletes half of them and looks them all up again -- lots of
+ *    short loops and data-dependent branches, unlike matmult.
+ */
+
+#include "syscall.h"
+
+#define TableSize	256	/* a power of two; with the values, 2Kb */
+#define NumKeys		192	/* three quarters full */
+#define Empty		0
+#define Deleted		-1
+
+int keys[TableSize];
+int values[TableSize];
+
+/* Next number in a linear congruential sequence; never 0 or -1 */
+int
+next(int seed)
+{
+    return ((seed * 1103515245 + 12345) & 0x3fffffff) | 1;
+}
+
+/* Index of key in the table, or of the slot where it should go */
+int
+probe(int key, int inserting)
+{
+    int i = (key ^ (key >> 8)) & (TableSize - 1);
+
+    while (keys[i] != Empty && keys[i] != key) {
+	if (inserting && keys[i] == Deleted)
+	    return i;
+	i = (i + 1) & (TableSize - 1);
+    }
+    return i;
+}
+
+int
+main()
+{
+    int i, key, slot, found = 0;
+
+    key = 1;
+    for (i = 0; i < NumKeys; i++) {	/* insert */
+	key = next(key);
+	slot = probe(key, 1);
+	keys[slot] = key;
+	values[slot] = i;
+    }
+
+    key = 1;
+    for (i = 0; i < 2 * NumKeys; i++) {	/* look up; half are missing */
+	key = next(key);
+	slot = probe(key, 0);
+	if (keys[slot] == key && values[slot] == i)
+	    found++;
+    }
+
+    key = 1;
+    for (i = 0; i < NumKeys; i += 2) {	/* delete every other key */
+	key = next(next(key));
+	slot = probe(key, 0);
+	if (keys[slot] == key)
+	    keys[slot] = Deleted;
+    }
+
+    key = 1;
+    for (i = 0; i < NumKeys; i++) {	/* and look them all up again */
+	key = next(key);
+	slot = probe(key, 0);
+	if (keys[slot] == key)
+	    found++;
+    }
+
+    Exit(found);		/* should be NumKeys + NumKeys / 2 */
+}
@@ -9,9 +9,11 @@
 
 #include "syscall.h"
 
+#ifndef Dim
 #define Dim 	20	/* sum total of the arrays doesn't fit in 
 			 * physical memory 
 			 */
+#endif			/* smaller sizes are built with -DDim=n */
 
 int A[Dim][Dim];
 int B[Dim][Dim];
@@ -0,0 +1,34 @@
+/* procs.c 
+ *    Benchmark program: a multi-process workload.
+ *
+ *    Starts children running the "yielder" program, one after
+ *    another, to measure what it costs to create and tear down an
+ *    address space; then runs each child alongside this process,
+ *    both of them yielding, to measure switching between address
+ *    spaces.  Physical memory only has room for two small programs
+ *    at a time, so there is only ever one child.
+ */
+
+#include "syscall.h"
+
+#define Children	5
+#define Yields		20
+
+int
+main()
+{
+    SpaceId child;
+    int i, j, sum = 0;
+
+    for (i = 0; i < Children; i++)	/* one after another */
+	sum += Join(Exec("../test/yielder"));
+
+    for (i = 0; i < Children; i++) {	/* side by side */
+	child = Exec("../test/yielder");
+	for (j = 0; j < Yields; j++)
+	    Yield();
+	sum += Join(child);
+    }
+
+    Exit(sum);			/* should be 2 * Children */
+}
@@ -9,7 +9,13 @@
 
 #include "syscall.h"
 
-int A[1024];	/* size of physical memory; with code, we'll run out of space!*/
+#ifndef Size
+#define Size	1024	/* size of physical memory; with code, we'll run out
+			 * of space!  Smaller sizes are built with -DSize=n
+			 */
+#endif
+
+int A[Size];
 
 int
 main()
@@ -17,12 +23,12 @@ main()
     int i, j, tmp;
 
     /* first initialize the array, in reverse sorted order */
-    for (i = 0; i < 1024; i++)		
-        A[i] = 1024 - i;
+    for (i = 0; i < Size; i++)		
+        A[i] = Size - i;
 
     /* then sort! */
-    for (i = 0; i < 1023; i++)
-        for (j = i; j < (1023 - i); j++)
+    for (i = 0; i < (Size - 1); i++)
+        for (j = i; j < ((Size - 1) - i); j++)
 	   if (A[j] > A[j + 1]) {	/* out of order -> need to swap ! */
 	      tmp = A[j];
 	      A[j] = A[j + 1];
@@ -0,0 +1,109 @@
+/* strings.c 
+ *    Benchmark program: string processing, byte at a time.
+ *
+ *    Takes a paragraph of text through the sort of things a shell or
+ *    a compiler does to strings: measuring, copying, searching, case
+ *    conversion, splitting into words and comparing them.  There is
+ *    no C library, so the string routines are here too.
+ */
+
+#include "syscall.h"
+
+#define Rounds	4
+
+char text[] = "Nachos is an instructional operating system. It runs as "
+	"a user process on a host operating system, and simulates a MIPS "
+	"machine with a disk, a console, a timer and a network. Students "
+	"write the kernel: threads and synchronization, multiprogramming, "
+	"virtual memory, a file system and networking.";
+
+char copy[sizeof(text)];
+char *words[64];
+
+int
+length(char *s)
+{
+    int n = 0;
+
+    while (s[n] != '\0')
+	n++;
+    return n;
+}
+
+void
+copystr(char *to, char *from)
+{
+    while ((*to++ = *from++) != '\0')
+	;
+}
+
+int
+compare(char *a, char *b)
+{
+    while (*a != '\0' && *a == *b) {
+	a++;
+	b++;
+    }
+    return *a - *b;
+}
+
+/* How many times does "pattern" occur in "s"? */
+int
+occurrences(char *s, char *pattern)
+{
+    int i, j, n = 0;
+
+    for (i = 0; s[i] != '\0'; i++) {
+	for (j = 0; pattern[j] != '\0' && s[i + j] == pattern[j]; j++)
+	    ;
+	if (pattern[j] == '\0')
+	    n++;
+    }
+    return n;
+}
+
+/* Split s into words, in place; return how many */
+int
+split(char *s)
+{
+    int n = 0;
+
+    while (*s != '\0') {
+	while (*s == ' ')
+	    *s++ = '\0';
+	if (*s != '\0')
+	    words[n++] = s;
+	while (*s != '\0' && *s != ' ')
+	    s++;
+    }
+    return n;
+}
+
+int
+main()
+{
+    int round, i, j, n, sum = 0;
+    char *tmp;
+
+    for (round = 0; round < Rounds; round++) {
+	copystr(copy, text);
+	sum += length(copy);
+	sum += occurrences(copy, "system");
+	sum += occurrences(copy, "a ");
+
+	for (i = 0; copy[i] != '\0'; i++)	/* upper case */
+	    if (copy[i] >= 'a' && copy[i] <= 'z')
+		copy[i] = copy[i] - 'a' + 'A';
+
+	n = split(copy);			/* sort the words */
+	for (i = 0; i < n; i++)
+	    for (j = n - 1; j > i; j--)
+		if (compare(words[j - 1], words[j]) > 0) {
+		    tmp = words[j - 1];
+		    words[j - 1] = words[j];
+		    words[j] = tmp;
+		}
+	sum += n + words[0][0] + words[n - 1][0];
+    }
+    Exit(sum);
+}
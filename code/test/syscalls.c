@@ -0,0 +1,39 @@
+/* syscalls.c 
+ *    Benchmark program: the cost of a system call.
+ *
+ *    Makes a long run of the cheapest system calls there are -- Yield,
+ *    with no one else to yield to, and Writes and Reads of a single
+ *    byte, and Open and Close of the same file -- so the time is
+ *    almost all trap, argument copying and return.
+ */
+
+#include "syscall.h"
+
+#define Calls	500
+
+int
+main()
+{
+    OpenFileId file;
+    char ch = 'x';
+    int i, n = 0;
+
+    for (i = 0; i < Calls; i++)
+	Yield();
+
+    Create("syscalls.dat");
+    file = Open("syscalls.dat");
+    for (i = 0; i < Calls; i++)
+	Write(&ch, 1, file);
+    Close(file);
+
+    file = Open("syscalls.dat");
+    for (i = 0; i < Calls; i++)
+	n += Read(&ch, 1, file);
+    Close(file);
+
+    for (i = 0; i < Calls; i++)
+	Close(Open("syscalls.dat"));
+
+    Exit(n);			/* should be Calls */
+}
@@ -0,0 +1,18 @@
+/* yielder.c 
+ *    The child process run by procs.c: yield the CPU a number of
+ *    times, then exit.
+ */
+
+#include "syscall.h"
+
+#define Yields		20
+
+int
+main()
+{
+    int i;
+
+    for (i = 0; i < Yields; i++)
+	Yield();
+    Exit(1);
+}
@@ -24,13 +24,15 @@ void sentinel(int when)
 Alarm::Alarm()
 {
 	//name=debugName;
-    alarmQueue = new List();
+    alarmQueue = new SortedList<Thread *, int>();
+    taskQueue = new SortedList<Task *, int>();
     waiternum = 0;
 }
 
 Alarm::~Alarm()
 {
     delete alarmQueue;
+    delete taskQueue;
 }
 
 bool Alarm::CheckEmpty()
@@ -48,10 +50,15 @@ void Alarm::Pause(int howLong)
     	DEBUG('a',"\033[1;33;40mThread%s alarm failed, howLong is negative.\033[m\n\n", currentThread->getName());
         return;
     }
+	DEBUG('a',"Thread%s set an alarm for %d Time Unit .\n\n", currentThread->getName(), howLong);
+    PauseUntil(stats->totalTicks +  TimerTicks * howLong);		//set the Alarm
+}
+
+void Alarm::PauseUntil(int wakeTime)
+{
     IntStatus oldLevel = interrupt->SetLevel(IntOff);   // disable interrupts
 
 	waiternum++;
-	int wakeTime=-1;
 	if(waiternum==1)	//only one thread waiting for the alarm
     {
         Thread *t = new Thread("CheckThread");  //create a check thread
@@ -59,11 +66,8 @@ void Alarm::Pause(int howLong)
     	DEBUG('a',"\033[1;33;40mCheckThread has been created.\033[m\n\n");
     }
 
-    
-    wakeTime = stats->totalTicks +  TimerTicks * howLong;		//set the Alarm
-	DEBUG('a',"Thread%s set an alarm for %d Time Unit .\n\n", currentThread->getName(), howLong);
     DEBUG('a',"\033[1;33;40mThread%s SLEEP, it will wake up at %d totalTicks.\033[m\n\n", currentThread->getName(), wakeTime);
-    alarmQueue->SortedInsert((void *)currentThread, wakeTime);  //insert into queue
+    alarmQueue->Insert(currentThread, wakeTime);  //insert into queue
     currentThread->Sleep();
 
     (void) interrupt->SetLevel(oldLevel);   // re-enable interrupts
@@ -72,30 +76,52 @@ void Alarm::Pause(int howLong)
 
 void Alarm::Awaken()
 {
-    int when = -1;
     Thread *thread = NULL;
     //DEBUG('a',"\033[1;33;40mTimer interrupt handler is going to wake up threads at %d totalTicks.\033[m\n\n", stats->totalTicks);
 
     IntStatus oldLevel = interrupt->SetLevel(IntOff);   // disable interrupts
 
-    thread = (Thread*)alarmQueue->SortedRemove(&when);	//capture the first thread and  
-    													//its wakeTime in the alarmQueue.
-    while(thread != NULL)
+    //wake up every thread at the front of the alarmQueue whose wakeTime has come;
+    //the rest stay where they are.
+    while(!alarmQueue->IsEmpty() && alarmQueue->FirstKey() <= stats->totalTicks)
     {
-        if( when <= stats->totalTicks)   //If there is any thread can be waked up this time.
-        {
-            scheduler->ReadyToRun(thread);  //set runnable status
-            DEBUG('a',"\033[1;33;40mTimer interrupt handler wake up a thread%s successfully at %d totalTicks.\033[m\n\n", thread->getName(),stats->totalTicks);
-            thread = (Thread *)alarmQueue->SortedRemove(&when);	//capture next thread
-            waiternum--;
-        }
-        else
-        {
-            alarmQueue->SortedInsert(thread, when);  //insert back into the alarmQueue
-            break;
-        }
+        thread = alarmQueue->Remove(NULL);
+        scheduler->ReadyToRun(thread);  //set runnable status
+        DEBUG('a',"\033[1;33;40mTimer interrupt handler wake up a thread%s successfully at %d totalTicks.\033[m\n\n", thread->getName(),stats->totalTicks);
+        waiternum--;
+    }
+    while(!taskQueue->IsEmpty() && taskQueue->FirstKey() <= stats->totalTicks)
+    {
+        taskQueue->Remove(NULL)->Wake();
+        waiternum--;
+    }
+
+    (void) interrupt->SetLevel(oldLevel);   // re-enable interrupts
+}
+
+bool Alarm::Pause(int howLong, Task *task)
+{
+    if(howLong <= 0)
+        return TRUE;
+    return PauseUntil(stats->totalTicks +  TimerTicks * howLong, task);     //set the Alarm
+}
+
+bool Alarm::PauseUntil(int wakeTime, Task *task)
+{
+    if(wakeTime <= stats->totalTicks)
+        return TRUE;
+    IntStatus oldLevel = interrupt->SetLevel(IntOff);   // disable interrupts
+
+    waiternum++;
+    if(waiternum==1)    //only one waiting for the alarm
+    {
+        Thread *t = new Thread("CheckThread");  //create a check thread
+        t->Fork(sentinel, 0);
     }
+    DEBUG('a',"Task %s set an alarm, it will wake up at %d totalTicks.\n\n", task->getName(), wakeTime);
+    taskQueue->Insert(task, wakeTime);
 
     (void) interrupt->SetLevel(oldLevel);   // re-enable interrupts
+    return FALSE;
 }
 
@@ -1,6 +1,9 @@
 #ifndef ALARM_H
 #define ALARM_H
 #include "list.h"
+#include "task.h"
+
+class Thread;
 
 class Alarm
 {
@@ -18,6 +21,18 @@ public:
                              // which check the count of threads
                              // waiting for Alarm
                              // from the beginning to the end.
+    void PauseUntil(int when);
+                             // sleep until totalTicks reaches "when"
+                             // (or rather, until the first timer
+                             // interrupt after that)
+    bool Pause(int howLong, Task *task);
+                             // Pause on behalf of a stackless task:
+                             // queue the task to be woken in howLong
+                             // units.  Returns TRUE (don't wait) only
+                             // if howLong is not positive.
+    bool PauseUntil(int when, Task *task);
+                             // likewise, until totalTicks reaches "when";
+                             // TRUE if it already has
     void Awaken();           // an atomic operation.
                              // Be called as the time interrupt generates
                              // it has not been added yet.
@@ -27,7 +42,11 @@ public:
 
 private:
     //char* name;              // for debugging
-    List *alarmQueue;        // a queue record the thread which calls the function and sleep
+    SortedList<Thread *, int> *alarmQueue;
+                             // a queue record the thread which calls the function and sleep,
+                             // sorted by wake up time
+    SortedList<Task *, int> *taskQueue;
+                             // tasks waiting for the Alarm, likewise
     int waiternum;           // the count of threads already in the alarmQueue
 };
 
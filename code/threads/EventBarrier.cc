@@ -59,4 +59,174 @@ void EventBarrier::Complete(){
 // Return a count of threads that are waiting for the event or that have not yet responded to it.
 int EventBarrier::Waiters(){
     return cnt;
-}
\ No newline at end of file
+}
+
+//=================   TREE EVENT BARRIER   ============================================
+
+// One sub-barrier in a TreeEventBarrier.
+
+class BarrierNode {
+public:
+    Lock *lock;
+    Condition *cond;		// all waiting here, for whatever reason
+    BarrierNode *parent;	// NULL at the root
+    int count;			// threads (at a leaf) or children (above)
+				// that have arrived and not yet responded
+    bool signaled;		// the event has been signaled down to here
+    bool sense;			// flips each time an event is over here
+};
+
+// Build a tree with a leaf for every BarrierFanIn expected waiters.
+TreeEventBarrier::TreeEventBarrier(int expected){
+    int width,level,i,levels;
+
+    numLeaves = divRoundUp(expected,BarrierFanIn);
+    if(numLeaves<1)
+        numLeaves=1;
+    numNodes=0;
+    levels=1;
+    for(width=numLeaves;width>1;width=divRoundUp(width,BarrierFanIn)){
+        numNodes+=width;
+        levels++;
+    }
+    numNodes++;//the root
+    ASSERT(levels<=MaxBarrierDepth);
+    nodes = new BarrierNode[numNodes];
+    for(i=0;i<numNodes;i++){
+        nodes[i].lock = new Lock("barrier node lock");
+        nodes[i].cond = new Condition("barrier node");
+        nodes[i].parent = NULL;
+        nodes[i].count = 0;
+        nodes[i].signaled = FALSE;
+        nodes[i].sense = FALSE;
+    }
+
+    // the children of the j'th node of a level are nodes
+    // j*BarrierFanIn... of the level below
+    level=0;//first node of this level
+    for(width=numLeaves;width>1;width=divRoundUp(width,BarrierFanIn)){
+        for(i=0;i<width;i++)
+            nodes[level+i].parent = &nodes[level+width+i/BarrierFanIn];
+        level+=width;
+    }
+    root = &nodes[numNodes-1];
+}
+
+TreeEventBarrier::~TreeEventBarrier(){
+    for(int i=0;i<numNodes;i++){
+        delete nodes[i].lock;
+        delete nodes[i].cond;
+    }
+    delete [] nodes;
+}
+
+// Spread threads over the leaves by their address; a thread must use
+// the same leaf for Complete as it did for Wait.
+BarrierNode* TreeEventBarrier::Leaf(){
+    unsigned int h = ((unsigned int) currentThread) * 2654435761u;
+    return &nodes[(h>>8)%numLeaves];
+}
+
+// Wait until the event is signaled. Return immediately if already in the signaled state.
+// The first thread to arrive at each node registers it with the node's parent, and so on
+// up to a node that is already registered; there it waits, and once released, it releases
+// the nodes it registered on the way up.
+void TreeEventBarrier::Wait(){
+    BarrierNode *path[MaxBarrierDepth];
+    BarrierNode *node = Leaf();
+    int depth=0;
+
+    node->lock->Acquire();
+    for(;;){
+        while(node->count==0 && node->signaled)//last event still being
+            node->cond->Wait(node->lock);       //cleared away below here
+        node->count++;
+        if(node->count>1 || node->signaled || node==root)
+            break;
+        path[depth++]=node;//first here: go on up
+        node->parent->lock->Acquire();
+        node->lock->Release();
+        node=node->parent;
+    }
+    DEBUG('e',"thread %s waits at barrier node %d\n",currentThread->getName(),
+        (int)(node-nodes));
+    while(!node->signaled)
+        node->cond->Wait(node->lock);
+    node->lock->Release();
+
+    while(depth>0){//release the nodes we registered
+        node=path[--depth];
+        node->lock->Acquire();
+        node->signaled=TRUE;
+        node->cond->Broadcast(node->lock);
+        node->lock->Release();
+    }
+}
+
+// Signal the event and block until all threads that wait for this event have responded.
+// The barrier reverts to the unsignaled state when Signal() returns.
+void TreeEventBarrier::Signal(){
+    root->lock->Acquire();
+    if(root->count>0){
+        bool sense=root->sense;
+        if(!root->signaled){
+            root->signaled=TRUE;
+            root->cond->Broadcast(root->lock);
+            DEBUG('e',"thread %s signaled\n",currentThread->getName());
+        }
+        while(root->sense==sense)
+            root->cond->Wait(root->lock);
+    }
+    root->lock->Release();
+}
+
+// Indicate that the calling thread has finished responding to a signaled event, and block
+// until all other threads that wait for this event have also responded.
+// The last thread to respond at each node goes on up to the parent; the last one at the
+// root ends the event, and each thread it wakes passes that on down the nodes below it.
+void TreeEventBarrier::Complete(){
+    BarrierNode *path[MaxBarrierDepth];
+    BarrierNode *node = Leaf();
+    int depth=0;
+
+    node->lock->Acquire();
+    for(;;){
+        ASSERT(node->count>0 && node->signaled);
+        node->count--;
+        if(node->count>0 || node==root)
+            break;
+        path[depth++]=node;//last here: go on up
+        node->parent->lock->Acquire();
+        node->lock->Release();
+        node=node->parent;
+    }
+    if(node->count>0){//wait for the rest
+        bool sense=node->sense;
+        while(node->sense==sense)
+            node->cond->Wait(node->lock);
+    }
+    else{//last one of all
+        DEBUG('e',"thread %s complete.\n",currentThread->getName());
+        node->signaled=FALSE;
+        node->sense=!node->sense;
+        node->cond->Broadcast(node->lock);
+    }
+    node->lock->Release();
+
+    while(depth>0){//end the event at the nodes we came up through
+        node=path[--depth];
+        node->lock->Acquire();
+        node->signaled=FALSE;
+        node->sense=!node->sense;
+        node->cond->Broadcast(node->lock);
+        node->lock->Release();
+    }
+}
+
+// Return a count of threads that are waiting for the event or that have not yet responded to it.
+int TreeEventBarrier::Waiters(){
+    int n=0;
+    for(int i=0;i<numLeaves;i++)
+        n+=nodes[i].count;
+    return n;
+}
@@ -22,4 +22,46 @@ private:
     int state,cnt;
 };
 
-#endif 
\ No newline at end of file
+// A scalable EventBarrier, with the same operations and meaning.
+//
+// EventBarrier sends every Wait and Complete through one lock, and
+// wakes every waiter from one condition, so with thousands of
+// waiters it becomes a serial bottleneck.  TreeEventBarrier spreads
+// them over a combining tree of sub-barriers, BarrierFanIn children
+// to a node.  A thread arrives at a leaf picked by its address; only
+// the first thread to reach a node goes on to register the node with
+// its parent, the rest wait at the node.  Signal releases the root,
+// and each thread that is released wakes the nodes below it that it
+// registered, so the wakeups fan out down the tree instead of all
+// coming from the signaller.  Complete combines back up the same way:
+// only the last thread to respond at a node goes on to the parent,
+// and the last one at the root wakes everyone back down the tree.
+//
+// Each node has a sense that flips every time an event it took part
+// in is over.  A thread waiting for the others to respond waits for
+// the sense to flip, rather than for anything to be reset, and the
+// node is ready for the next event as soon as it flips.
+
+#define BarrierFanIn	4	// children of each node in the tree
+#define MaxBarrierDepth	16	// most levels in the tree
+
+class BarrierNode;
+
+class TreeEventBarrier {
+public:
+    TreeEventBarrier(int expected);	// "expected" -- roughly how many
+					// threads will wait at once
+    ~TreeEventBarrier();
+    void Wait();
+    void Signal();
+    void Complete();
+    int Waiters();
+private:
+    BarrierNode *nodes;		// the tree; leaves first, root last
+    int numNodes, numLeaves;
+    BarrierNode *root;
+
+    BarrierNode *Leaf();	// where the current thread arrives
+};
+
+#endif // EVENTBARRIER_H
@@ -0,0 +1,295 @@
+// batch.cc
+//	Routines to run a batch of simulations, one copy of Nachos per
+//	simulation, and report on them.
+//
+//	The original process reads the batch file, starts up to "jobs"
+//	runs at a time, and waits for each to finish.  Each run's
+//	standard output and standard error go to a scratch file, which
+//	is copied into the report once the whole batch is done.  The
+//	summary table is made from the statistics every run prints as
+//	it halts (see Statistics::Print), among them the exit status of
+//	the first user program, if there is one.
+//
+// Copyright (c) 1992-1993 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#include "copyright.h"
+#include "batch.h"
+#include "utility.h"
+
+// The following class defines one simulation in a batch.
+
+class BatchRun {
+  public:
+    char *args;			// its arguments, as in the batch file
+    int argc;			// and split up, after the program name
+    char *argv[MaxRunArgs + 2];
+
+    int outputFd;		// scratch file holding its output
+    int pid;			// its process, while it is running
+    int exitCode;		// how it ended; minus the signal number
+				// if it was killed
+    int hostTime;		// milliseconds from start to finish
+
+    int ticks;			// statistics it printed as it halted;
+    int idleTicks;		// -1 if it didn't get that far
+    int systemTicks;
+    int userTicks;		// also the user instructions executed
+    int numDiskReads;
+    int numDiskWrites;
+    int numPageFaults;
+    int numTLBMisses;
+    int numSwitches;
+    int numTimerInterrupts;
+    bool exited;		// did the first user program call Exit?
+    int exitStatus;		// and if so, with what
+};
+
+//----------------------------------------------------------------------
+// ReadBatch
+// 	Read a batch file into an array of runs, skipping blank lines and
+//	comments.
+//
+//	"batchFile" -- the name of the file
+//	"program" -- argv[0] for each run
+//	"runs" -- where to put them
+//
+// Returns:
+//	The number of runs.
+//----------------------------------------------------------------------
+
+static int
+ReadBatch(char *batchFile, char *program, BatchRun *runs)
+{
+    FILE *file = fopen(batchFile, "r");
+    char line[1024];
+    char *arg;
+    int len, numRuns = 0;
+
+    if (file == NULL) {
+	fprintf(stderr, "Can't open batch file %s\n", batchFile);
+	Exit(1);
+    }
+    while (fgets(line, sizeof(line), file) != NULL) {
+	len = strlen(line);
+	if ((len > 0) && (line[len - 1] == '\n'))
+	    line[--len] = '\0';
+	for (arg = line; (*arg == ' ') || (*arg == '\t'); arg++)
+	    ;
+	if ((*arg == '\0') || (*arg == '#'))
+	    continue;
+	ASSERT(numRuns < MaxBatchRuns);
+
+	BatchRun *run = &runs[numRuns++];
+	run->args = new char[strlen(arg) + 1];
+	strcpy(run->args, arg);
+	run->argv[0] = program;
+	run->argc = 1;
+	for (arg = strtok(line, " \t"); arg != NULL; arg = strtok(NULL, " \t")) {
+	    ASSERT(run->argc <= MaxRunArgs);
+	    run->argv[run->argc] = new char[strlen(arg) + 1];
+	    strcpy(run->argv[run->argc++], arg);
+	}
+	run->argv[run->argc] = NULL;
+	run->pid = 0;
+    }
+    fclose(file);
+    return numRuns;
+}
+
+//----------------------------------------------------------------------
+// ReportRun
+// 	Copy one run's output into the report, and pick out the
+//	statistics it printed when it halted.
+//
+//	"run" -- the run
+//	"which" -- its place in the batch, counting from 1
+//	"numRuns" -- how many runs there are in all
+//----------------------------------------------------------------------
+
+static void
+ReportRun(BatchRun *run, int which, int numRuns)
+{
+    int size;
+    char *output, *s;
+
+    Lseek(run->outputFd, 0, 2);
+    size = Tell(run->outputFd);
+    output = new char[size + 1];
+    Lseek(run->outputFd, 0, 0);
+    Read(run->outputFd, output, size);
+    output[size] = '\0';
+    Close(run->outputFd);
+
+    printf("==== run %d of %d: %s ====\n", which, numRuns, run->args);
+    fwrite(output, 1, size, stdout);
+    if ((size > 0) && (output[size - 1] != '\n'))
+	printf("\n");
+
+    run->ticks = run->idleTicks = run->systemTicks = run->userTicks = -1;
+    run->numDiskReads = run->numDiskWrites = run->numPageFaults = -1;
+    run->numTLBMisses = -1;
+    run->numSwitches = run->numTimerInterrupts = -1;
+    if ((s = strstr(output, "Ticks: total ")) != NULL)
+	sscanf(s, "Ticks: total %d, idle %d, system %d, user %d", &run->ticks,
+		&run->idleTicks, &run->systemTicks, &run->userTicks);
+    if ((s = strstr(output, "Disk I/O: reads ")) != NULL)
+	sscanf(s, "Disk I/O: reads %d, writes %d", &run->numDiskReads,
+		&run->numDiskWrites);
+    if ((s = strstr(output, "Paging: faults ")) != NULL)
+	sscanf(s, "Paging: faults %d, TLB misses %d", &run->numPageFaults,
+		&run->numTLBMisses);
+    if ((s = strstr(output, "Threads: context switches ")) != NULL)
+	sscanf(s, "Threads: context switches %d", &run->numSwitches);
+    if ((s = strstr(output, "Timer: interrupts ")) != NULL)
+	sscanf(s, "Timer: interrupts %d", &run->numTimerInterrupts);
+    run->exited = ((s = strstr(output, "User program: exit status ")) != NULL)
+	&& (sscanf(s, "User program: exit status %d", &run->exitStatus) == 1);
+    delete [] output;
+}
+
+//----------------------------------------------------------------------
+// WriteJson
+// 	Write the results of a batch to a file, as a JSON array with one
+//	object per run.  Statistics a run didn't print are null.
+//
+//	"jsonFile" -- the name of the file
+//	"runs", "numRuns" -- the runs, all finished and reported on
+//----------------------------------------------------------------------
+
+static void
+WriteJson(char *jsonFile, BatchRun *runs, int numRuns)
+{
+    FILE *file = fopen(jsonFile, "w");
+    int i, j, k;
+    char *a;
+
+    if (file == NULL) {
+	fprintf(stderr, "Can't open JSON file %s\n", jsonFile);
+	Exit(1);
+    }
+    fprintf(file, "[\n");
+    for (i = 0; i < numRuns; i++) {
+	BatchRun *run = &runs[i];
+	int stats[] = { run->ticks, run->idleTicks, run->systemTicks,
+	    run->userTicks, run->userTicks, run->numPageFaults,
+	    run->numTLBMisses, run->numDiskReads, run->numDiskWrites,
+	    run->numSwitches, run->numTimerInterrupts };
+	static char *names[] = { "ticks", "idleTicks", "systemTicks",
+	    "userTicks", "instructions", "pageFaults", "tlbMisses",
+	    "diskReads", "diskWrites", "contextSwitches", "timerInterrupts" };
+
+	fprintf(file, "  {\"run\": %d, \"args\": \"", i + 1);
+	for (a = run->args; *a != '\0'; a++)
+	    if ((*a == '"') || (*a == '\\'))
+		fprintf(file, "\\%c", *a);
+	    else
+		fputc(*a, file);
+	fprintf(file, "\", \"exitCode\": %d, \"hostMs\": %d", run->exitCode,
+		run->hostTime);
+	if (run->exited)
+	    fprintf(file, ", \"exitStatus\": %d", run->exitStatus);
+	else
+	    fprintf(file, ", \"exitStatus\": null");
+	for (j = 0, k = sizeof(stats) / sizeof(int); j < k; j++)
+	    if (stats[j] < 0)
+		fprintf(file, ", \"%s\": null", names[j]);
+	    else
+		fprintf(file, ", \"%s\": %d", names[j], stats[j]);
+	fprintf(file, "}%s\n", (i < numRuns - 1) ? "," : "");
+    }
+    fprintf(file, "]\n");
+    fclose(file);
+}
+
+//----------------------------------------------------------------------
+// RunBatch
+// 	Run every simulation in the batch file named on the command line,
+//	"jobs" at a time (by default, one per host CPU), then print their
+//	output and a summary, and exit -- with 1 if any run failed.
+//	With -json, write the results to a file as well.
+//
+//	In the copy of Nachos forked for each run, return instead, with
+//	"argc" and "argv" set up for that run.
+//----------------------------------------------------------------------
+
+void
+RunBatch(int *argc, char ***argv)
+{
+    BatchRun *runs = new BatchRun[MaxBatchRuns];
+    int numRuns, next, running, jobs, i;
+    int pid, exitCode, start, elapsed, serial, failed;
+    char status[16];
+    char *jsonFile = NULL;
+
+    ASSERT((*argc >= 3) && ((*argc % 2) == 1));
+    jobs = NumHostCPUs();
+    for (i = 3; i < *argc; i += 2)
+	if (!strcmp((*argv)[i], "-j"))
+	    jobs = atoi((*argv)[i + 1]);
+	else if (!strcmp((*argv)[i], "-json"))
+	    jsonFile = (*argv)[i + 1];
+	else
+	    ASSERT(FALSE);
+    ASSERT(jobs > 0);
+    numRuns = ReadBatch((*argv)[2], (*argv)[0], runs);
+
+    start = HostMilliseconds();
+    next = running = 0;
+    while ((next < numRuns) || (running > 0)) {
+	if ((next < numRuns) && (running < jobs)) {	// start another
+	    BatchRun *run = &runs[next++];
+
+	    run->outputFd = OpenTempFile();
+	    run->hostTime = HostMilliseconds();
+	    run->pid = StartChild(run->outputFd);
+	    if (run->pid == 0) {		// we are the run
+		*argc = run->argc;
+		*argv = run->argv;
+		return;
+	    }
+	    running++;
+	    continue;
+	}
+
+	pid = WaitForChild(&exitCode);		// wait for one to finish
+	ASSERT(pid > 0);
+	for (i = 0; (i < next) && (runs[i].pid != pid); i++)
+	    ;
+	ASSERT(i < next);
+	runs[i].exitCode = exitCode;
+	runs[i].hostTime = HostMilliseconds() - runs[i].hostTime;
+	runs[i].pid = 0;
+	running--;
+    }
+
+    elapsed = HostMilliseconds() - start;
+
+    serial = failed = 0;
+    for (i = 0; i < numRuns; i++) {
+	ReportRun(&runs[i], i + 1, numRuns);
+	serial += runs[i].hostTime;
+	if (runs[i].exitCode != 0)
+	    failed++;
+    }
+
+    printf("\n run  status        ticks     idle  switches  host ms  arguments\n");
+    for (i = 0; i < numRuns; i++) {
+	BatchRun *run = &runs[i];
+
+	if (run->exitCode == 0)
+	    sprintf(status, "ok");
+	else if (run->exitCode > 0)
+	    sprintf(status, "exit %d", run->exitCode);
+	else
+	    sprintf(status, "signal %d", -run->exitCode);
+	printf("%4d  %-9s  %8d %8d  %8d  %7d  %s\n", i + 1, status, run->ticks,
+		run->idleTicks, run->numSwitches, run->hostTime, run->args);
+    }
+    printf("Batch: %d runs, %d failed, %d at a time; host time %d ms "
+	"(%d ms one after another)\n", numRuns, failed, jobs, elapsed, serial);
+    if (jsonFile != NULL)
+	WriteJson(jsonFile, runs, numRuns);
+    Exit((failed > 0) ? 1 : 0);
+}
@@ -0,0 +1,58 @@
+// batch.h
+//	Run a batch of independent simulations in parallel, and collect
+//	their results into a single report.
+//
+//	A batch file has one simulation per line, given as the Nachos
+//	command line arguments to run it with; blank lines, and lines
+//	starting with '#', are skipped.  For instance, to see how the
+//	elevator does as its capacity goes up:
+//
+//		# elevator capacity sweep
+//		-q 10 -F 9 -T 8 -V 2 -C 2
+//		-q 10 -F 9 -T 8 -V 2 -C 4
+//		-q 10 -F 9 -T 8 -V 2 -C 8
+//
+//	and then "nachos -batch sweep -j 4" runs them four at a time.
+//
+//	The kernel lives in global variables -- currentThread, scheduler,
+//	interrupt, stats and the rest -- along with the state hidden in
+//	each module (the slab caches, the task runner, the alarm queue,
+//	the random number generator).  So each simulation runs in its own
+//	copy of the Nachos process, forked before anything is initialized:
+//	that is its private kernel context, and the host is free to run
+//	the copies on different CPUs.  A simulation comes out exactly the
+//	same as it would run on its own.
+//
+//	Each run's output is captured, and once they have all finished,
+//	printed in the order the runs appear in the batch file, followed
+//	by a table summarizing them all.  With "-json <file>", the
+//	statistics each run printed as it halted -- ticks, user
+//	instructions, page faults, disk operations and so on -- are also
+//	written to <file> as a JSON array, one object per run, for
+//	scripts that track performance from one version to the next.
+//	(test/benchmarks is such a batch, of user programs.)
+//
+//	The runs share the host's current directory, so runs that use
+//	the same DISK file, or the same network sockets, should not be in
+//	the same batch.
+//
+// Copyright (c) 1992-1993 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#ifndef BATCH_H
+#define BATCH_H
+
+#include "copyright.h"
+
+#define MaxBatchRuns	1024	// most simulations in one batch
+#define MaxRunArgs	64	// most arguments to one simulation
+
+// Run the batch named by "nachos -batch <file> [-j <jobs>] [-json <file>]".
+// In the original process, RunBatch doesn't return: it prints the report
+// and exits.  In the process forked for each run, it returns, with argc
+// and argv changed to that run's arguments.
+
+extern void RunBatch(int *argc, char ***argv);
+
+#endif // BATCH_H
@@ -1,6 +1,7 @@
 #include "dllist.h"
 #include "copyright.h"
 #include "thread.h"
+#include "slab.h"
 #include <string.h>
 
 extern Thread *currentThread;
@@ -12,8 +13,21 @@ DLLElement::DLLElement( void *itemPtr, int sortKey){
     item=itemPtr;
 }
 
+static ObjectCache *elementCache=NULL;  // created on first use
+
+void *DLLElement::operator new(size_t size){
+    ASSERT(size==sizeof(DLLElement));
+    if(elementCache==NULL)
+        elementCache=new ObjectCache("dllist elements",sizeof(DLLElement),64);
+    return elementCache->Alloc();
+}
+
+void DLLElement::operator delete(void *p){
+    elementCache->Free(p);
+}
+
 DLList::DLList(){
-    list = new List();
+    list = new List<void *>();
     lock = new Lock("list lock"); 
     listEmpty = new Condition("list empty cond");
 }
@@ -5,6 +5,8 @@
 class DLLElement {
 public:
     DLLElement( void *itemPtr, int sortKey ); // initialize a list element
+    void *operator new(size_t size);    // elements come from an
+    void operator delete(void *p);      // ObjectCache (see slab.h)
     DLLElement *next;   // next element on list
                         // NULL if this is the last
     DLLElement *prev;   // previous element on list
@@ -34,7 +36,7 @@ public:
 private:
     DLLElement *first; // head of the list, NULL if empty
     DLLElement *last;  // last element of the list, NULL if empty
-    List *list;         // the unsynchronized list
+    List<void *> *list; // the unsynchronized list
     Lock *lock;         // enforce mutual exclusive access to the list
     Condition *listEmpty;   // wait in Remove if the list is empty
 };
@@ -1,13 +1,36 @@
-// list.h 
-//	Data structures to manage LISP-like lists.  
+// list.h
+//	Data structures to manage LISP-like lists.
 //
-//      As in LISP, a list can contain any type of data structure
-//	as an item on the list: thread control blocks, 
-//	pending interrupts, etc.  That is why each item is a "void *",
-//	or in other words, a "pointers to anything".
+//	There are three kinds of list, all templates over the type of
+//	item on the list, so that items go on and come off a list with
+//	their own type, and no casts:
+//
+//	List<T> -- a FIFO list of items.  A ListElement is allocated
+//		(from an ObjectCache, see slab.h) for each item on the list,
+//		so an item may be on any number of lists at once.
+//
+//	SortedList<T, Key> -- a list kept in increasing order by a key
+//		supplied when each item is inserted (pending interrupts,
+//		sleeping threads).
+//
+//	IntrusiveList<T, Link> -- a FIFO list that keeps its "next"
+//		pointers in the items themselves, in the member "Link".
+//		Nothing is allocated to put an item on the list, but an
+//		item can be on only one such list (per link) at a time.
+//		The ready list and the semaphore, lock and condition wait
+//		queues are of this kind, since a thread is only ever waiting
+//		in one place.
+//
+//	Everything here is inline, so that the common operations
+//	(Append and Remove on a short queue) compile to a handful of
+//	instructions at the call site.
+//
+//     	NOTE: Mutual exclusion must be provided by the caller.
+//  	If you want a synchronized list, you must use the routines
+//	in synchlist.h.
 //
 // Copyright (c) 1992-1993 The Regents of the University of California.
-// All rights reserved.  See copyright.h for copyright notice and limitation 
+// All rights reserved.  See copyright.h for copyright notice and limitation
 // of liability and disclaimer of warranty provisions.
 
 #ifndef LIST_H
@@ -15,52 +38,434 @@
 
 #include "copyright.h"
 #include "utility.h"
+#include "slab.h"
 
 // The following class defines a "list element" -- which is
-// used to keep track of one item on a list.  It is equivalent to a
-// LISP cell, with a "car" ("next") pointing to the next element on the list,
-// and a "cdr" ("item") pointing to the item on the list.
+// used to keep track of one item on a List or SortedList.  It is
+// equivalent to a LISP cell, with a "car" ("next") pointing to the next
+// element on the list, and a "cdr" ("item") pointing to the item on the
+// list.
 //
 // Internal data structures kept public so that List operations can
 // access them directly.
 
+template <class T, class Key>
 class ListElement {
    public:
-     ListElement(void *itemPtr, int sortKey);	// initialize a list element
+     ListElement(T itemPtr, Key sortKey)	// initialize a list element
+	{ item = itemPtr; key = sortKey; next = NULL; }
 
-     ListElement *next;		// next element on list, 
+     void *operator new(size_t size);	// ListElements come from an
+     void operator delete(void *p);	// ObjectCache, one per element type
+
+     ListElement *next;		// next element on list,
 				// NULL if this is the last
-     int key;		    	// priority, for a sorted list
-     void *item; 	    	// pointer to item on the list
+     Key key;		    	// priority, for a sorted list
+     T item; 	    		// the item on the list
+
+   private:
+     static ObjectCache *cache;	// created on first use, since lists are
+				// used by constructors that run before main
 };
 
 // The following class defines a "list" -- a singly linked list of
-// list elements, each of which points to a single item on the list.
-//
-// By using the "Sorted" functions, the list can be kept in sorted
-// in increasing order by "key" in ListElement.
+// list elements, each of which holds a single item on the list.
 
+template <class T>
 class List {
   public:
-    List();			// initialize the list
+    List() { first = last = NULL; }	// initialize the list
     ~List();			// de-allocate the list
 
-    void Prepend(void *item); 	// Put item at the beginning of the list
-    void Append(void *item); 	// Put item at the end of the list
-    void *Remove(); 	 	// Take item off the front of the list
+    void Prepend(T item); 	// Put item at the beginning of the list
+    void Append(T item); 	// Put item at the end of the list
+    T Remove(); 	 	// Take item off the front of the list
 
-    void Mapcar(VoidFunctionPtr func);	// Apply "func" to every element 
+    void Mapcar(void (*func)(T));	// Apply "func" to every element
 					// on the list
-    bool IsEmpty();		// is the list empty? 
-    
+    bool IsEmpty() { return first == NULL; }	// is the list empty?
+
+  private:
+    ListElement<T, int> *first;	// Head of the list, NULL if list is empty
+    ListElement<T, int> *last;	// Last element of list
+};
+
+// The following class defines a sorted list.  Items are kept in
+// increasing order by "key"; items with equal keys stay in the order
+// they were inserted.
+
+template <class T, class Key>
+class SortedList {
+  public:
+    SortedList() { first = NULL; }	// initialize the list
+    ~SortedList();		// de-allocate the list
+
+    void Insert(T item, Key sortKey);	// Put item into list
+    T Remove(Key *keyPtr); 	// Remove first item from list
+    Key FirstKey() { ASSERT(first != NULL); return first->key; }
+				// Key of the first item, without
+				// removing it
 
-    // Routines to put/get items on/off list in order (sorted by key)
-    void SortedInsert(void *item, int sortKey);	// Put item into list
-    void *SortedRemove(int *keyPtr); 	  	// Remove first item from list
+    void Mapcar(void (*func)(T));	// Apply "func" to every element
+					// on the list
+    bool IsEmpty() { return first == NULL; }	// is the list empty?
 
   private:
-    ListElement *first;  	// Head of the list, NULL if list is empty
-    ListElement *last;		// Last element of list
+    ListElement<T, Key> *first;	// Head of the list, NULL if list is empty
 };
 
+// The following class defines an intrusive list of objects of class
+// T, chained through T's member "Link" (a "T *").  The link must be
+// NULL whenever the object isn't on a list.
+
+template <class T, T *T::*Link>
+class IntrusiveList {
+  public:
+    IntrusiveList() { first = last = NULL; }	// initialize the list
+    ~IntrusiveList() { while (Remove() != NULL) ; }
+				// take everything off the list
+
+    void Prepend(T *item); 	// Put item at the beginning of the list
+    void Append(T *item); 	// Put item at the end of the list
+    T *Remove(); 	 	// Take item off the front of the list
+    bool Remove(T *item);	// Take "item" off the list, wherever it
+				// is; FALSE if it isn't on the list
+    T *Front() { return first; }	// First item, without removing it;
+					// follow "Link" for the rest
+
+    void Mapcar(void (*func)(T *));	// Apply "func" to every element
+					// on the list
+    bool IsEmpty() { return first == NULL; }	// is the list empty?
+
+  private:
+    T *first;  			// Head of the list, NULL if list is empty
+    T *last;			// Last item on the list
+};
+
+template <class T, class Key>
+ObjectCache *ListElement<T, Key>::cache = NULL;
+
+//----------------------------------------------------------------------
+// ListElement::operator new, ListElement::operator delete
+// 	Get a list element from the element cache, and put it back.
+//----------------------------------------------------------------------
+
+template <class T, class Key>
+inline void *
+ListElement<T, Key>::operator new(size_t size)
+{
+    ASSERT(size == sizeof(ListElement));
+    if (cache == NULL)
+	cache = new ObjectCache("list elements", sizeof(ListElement), 64);
+    return cache->Alloc();
+}
+
+template <class T, class Key>
+inline void
+ListElement<T, Key>::operator delete(void *p)
+{
+    cache->Free(p);
+}
+
+//----------------------------------------------------------------------
+// List::~List
+//	Prepare a list for deallocation.  If the list still contains any
+//	ListElements, de-allocate them.  However, note that we do *not*
+//	de-allocate the "items" on the list -- this module allocates
+//	and de-allocates the ListElements to keep track of each item,
+//	but a given item may be on multiple lists, so we can't
+//	de-allocate them here.
+//----------------------------------------------------------------------
+
+template <class T>
+List<T>::~List()
+{
+    while (!IsEmpty())
+	(void) Remove();	// delete all the list elements
+}
+
+//----------------------------------------------------------------------
+// List::Append
+//      Append an "item" to the end of the list.
+//
+//	Allocate a ListElement to keep track of the item.
+//      If the list is empty, then this will be the only element.
+//	Otherwise, put it at the end.
+//----------------------------------------------------------------------
+
+template <class T>
+inline void
+List<T>::Append(T item)
+{
+    ListElement<T, int> *element = new ListElement<T, int>(item, 0);
+
+    if (IsEmpty()) {		// list is empty
+	first = element;
+	last = element;
+    } else {			// else put it after last
+	last->next = element;
+	last = element;
+    }
+}
+
+//----------------------------------------------------------------------
+// List::Prepend
+//      Put an "item" on the front of the list.
+//
+//	Allocate a ListElement to keep track of the item.
+//      If the list is empty, then this will be the only element.
+//	Otherwise, put it at the beginning.
+//----------------------------------------------------------------------
+
+template <class T>
+inline void
+List<T>::Prepend(T item)
+{
+    ListElement<T, int> *element = new ListElement<T, int>(item, 0);
+
+    if (IsEmpty()) {		// list is empty
+	first = element;
+	last = element;
+    } else {			// else put it before first
+	element->next = first;
+	first = element;
+    }
+}
+
+//----------------------------------------------------------------------
+// List::Remove
+//      Remove the first "item" from the front of the list.
+//
+// Returns:
+//	The removed item, or T() (NULL for a list of pointers) if
+//	nothing is on the list.
+//----------------------------------------------------------------------
+
+template <class T>
+inline T
+List<T>::Remove()
+{
+    ListElement<T, int> *element = first;
+    T thing;
+
+    if (IsEmpty())
+	return T();
+
+    thing = first->item;
+    if (first == last) {	// list had one item, now has none
+        first = NULL;
+	last = NULL;
+    } else {
+        first = element->next;
+    }
+    delete element;
+    return thing;
+}
+
+//----------------------------------------------------------------------
+// List::Mapcar
+//	Apply a function to each item on the list, by walking through
+//	the list, one element at a time.
+//
+//	Unlike LISP, this mapcar does not return anything!
+//
+//	"func" is the procedure to apply to each element of the list.
+//----------------------------------------------------------------------
+
+template <class T>
+void
+List<T>::Mapcar(void (*func)(T))
+{
+    for (ListElement<T, int> *ptr = first; ptr != NULL; ptr = ptr->next)
+       (*func)(ptr->item);
+}
+
+//----------------------------------------------------------------------
+// SortedList::~SortedList
+//	De-allocate any ListElements still on the list (but not the
+//	items they point to).
+//----------------------------------------------------------------------
+
+template <class T, class Key>
+SortedList<T, Key>::~SortedList()
+{
+    while (!IsEmpty())
+	(void) Remove(NULL);
+}
+
+//----------------------------------------------------------------------
+// SortedList::Insert
+//      Insert an "item" into a list, so that the list elements are
+//	sorted in increasing order by "sortKey".
+//
+//	Allocate a ListElement to keep track of the item.
+//	Walk through the list, one element at a time, to find where
+//	the new item should be placed -- after any items with the
+//	same key.
+//
+//	"item" is the thing to put on the list.
+//	"sortKey" is the priority of the item.
+//----------------------------------------------------------------------
+
+template <class T, class Key>
+inline void
+SortedList<T, Key>::Insert(T item, Key sortKey)
+{
+    ListElement<T, Key> *element = new ListElement<T, Key>(item, sortKey);
+    ListElement<T, Key> **ptr;
+
+    for (ptr = &first; *ptr != NULL; ptr = &(*ptr)->next)
+	if (sortKey < (*ptr)->key)
+	    break;
+    element->next = *ptr;
+    *ptr = element;
+}
+
+//----------------------------------------------------------------------
+// SortedList::Remove
+//      Remove the first "item" from the front of a sorted list.
+//
+// Returns:
+//	The removed item, or T() if nothing is on the list.
+//	Sets *keyPtr to the priority value of the removed item
+//	(this is needed by interrupt.cc, for instance).
+//
+//	"keyPtr" is a pointer to the location in which to store the
+//		priority of the removed item, or NULL.
+//----------------------------------------------------------------------
+
+template <class T, class Key>
+inline T
+SortedList<T, Key>::Remove(Key *keyPtr)
+{
+    ListElement<T, Key> *element = first;
+    T thing;
+
+    if (IsEmpty())
+	return T();
+
+    thing = element->item;
+    first = element->next;
+    if (keyPtr != NULL)
+        *keyPtr = element->key;
+    delete element;
+    return thing;
+}
+
+//----------------------------------------------------------------------
+// SortedList::Mapcar
+//	Apply a function to each item on the list, in order.
+//----------------------------------------------------------------------
+
+template <class T, class Key>
+void
+SortedList<T, Key>::Mapcar(void (*func)(T))
+{
+    for (ListElement<T, Key> *ptr = first; ptr != NULL; ptr = ptr->next)
+       (*func)(ptr->item);
+}
+
+//----------------------------------------------------------------------
+// IntrusiveList::Append
+//      Append an "item" to the end of the list, linking it through
+//	its own "Link" member.  The item must not already be on a list
+//	that uses the same link.
+//----------------------------------------------------------------------
+
+template <class T, T *T::*Link>
+inline void
+IntrusiveList<T, Link>::Append(T *item)
+{
+    ASSERT((item->*Link == NULL) && (item != last));
+    if (IsEmpty())
+	first = item;
+    else
+	last->*Link = item;
+    last = item;
+}
+
+//----------------------------------------------------------------------
+// IntrusiveList::Prepend
+//      Put an "item" on the front of the list.
+//----------------------------------------------------------------------
+
+template <class T, T *T::*Link>
+inline void
+IntrusiveList<T, Link>::Prepend(T *item)
+{
+    ASSERT((item->*Link == NULL) && (item != last));
+    if (IsEmpty())
+	last = item;
+    item->*Link = first;
+    first = item;
+}
+
+//----------------------------------------------------------------------
+// IntrusiveList::Remove
+//      Remove the first item from the front of the list, and clear
+//	its link so it can be put on another list.
+//
+// Returns:
+//	The removed item, NULL if nothing on the list.
+//----------------------------------------------------------------------
+
+template <class T, T *T::*Link>
+inline T *
+IntrusiveList<T, Link>::Remove()
+{
+    T *thing = first;
+
+    if (thing == NULL)
+	return NULL;
+    first = thing->*Link;
+    if (first == NULL)
+	last = NULL;
+    thing->*Link = NULL;
+    return thing;
+}
+
+//----------------------------------------------------------------------
+// IntrusiveList::Remove(T *)
+//      Remove a particular item from the list, wherever it is.  Since
+//	the list is singly linked, this has to walk the list to find
+//	the item's predecessor.
+//
+// Returns:
+//	TRUE if the item was found (and removed).
+//----------------------------------------------------------------------
+
+template <class T, T *T::*Link>
+bool
+IntrusiveList<T, Link>::Remove(T *item)
+{
+    T *prev = NULL;
+    T *ptr;
+
+    for (ptr = first; ptr != NULL; prev = ptr, ptr = ptr->*Link)
+	if (ptr == item) {
+	    if (prev == NULL)
+		first = item->*Link;
+	    else
+		prev->*Link = item->*Link;
+	    if (last == item)
+		last = prev;
+	    item->*Link = NULL;
+	    return TRUE;
+	}
+    return FALSE;
+}
+
+//----------------------------------------------------------------------
+// IntrusiveList::Mapcar
+//	Apply a function to each item on the list, in order.
+//----------------------------------------------------------------------
+
+template <class T, T *T::*Link>
+void
+IntrusiveList<T, Link>::Mapcar(void (*func)(T *))
+{
+    for (T *ptr = first; ptr != NULL; ptr = ptr->*Link)
+       (*func)(ptr);
+}
+
 #endif // LIST_H
@@ -9,30 +9,51 @@
 // 	Most of this file is not needed until later assignments.
 //
 // Usage: nachos -d <debugflags> -rs <random seed #>
-//		-s -x <nachos file> -c <consoleIn> <consoleOut>
-//		-f -cp <unix file> <nachos file>
-//		-p <nachos file> -r <nachos file> -l -D -t
+//		-rec <log file> -rep <log file> -cpus <number of CPUs>
+//		-s -x <nachos file> -c <consoleIn> <consoleOut> -pt <trace file>
+//		-f -cp <unix file> <nachos file> -cpz <unix file> <nachos file>
+//		-p <nachos file> -r <nachos file> -l -D -t -bench
+//		-dt <trace file> -dtr <trace file> <speedup>
 //              -n <network reliability> -m <machine id>
 //              -o <other machine id>
 //              -z
+//	or: nachos -batch <batch file> [-j <jobs>] [-json <file>]
 //
 //    -d causes certain debugging messages to be printed (cf. utility.h)
 //    -rs causes Yield to occur at random (but repeatable) spots
+//    -rec records every nondeterministic input (random numbers, timer
+//	intervals, console and network input) into a log file
+//    -rep replays a log made with -rec, reproducing that run exactly
+//    -cpus simulates a multiprocessor with that many CPUs (see scheduler.h)
 //    -z prints the copyright message
+//    -batch runs each line of the batch file as a separate simulation,
+//	"jobs" at a time, and reports on them all (see batch.h); -json
+//	also writes the results to a file, in JSON
 //
 //  USER_PROGRAM
 //    -s causes user programs to be executed in single-step mode
 //    -x runs a user program
 //    -c tests the console
+//    -pt records every page user programs touch in a trace file, for
+//	../bin/pfanalyze (see pagetrace.h)
+//    -at records every address user programs fetch, load or store in
+//	a trace file, for ../bin/atdump (see addrtrace.h)
 //
 //  FILESYS
-//    -f causes the physical disk to be formatted
+//    -f causes the physical disk to be formatted (../bin/mkdisk
+//	formats one and copies UNIX files onto it, without Nachos)
 //    -cp copies a file from UNIX to Nachos
+//    -cpz does too, into a compressed Nachos file (see filehdr.h)
+//    -cl clones a Nachos file, sharing its data until it is written
 //    -p prints a Nachos file to stdout
 //    -r removes a Nachos file from the file system
 //    -l lists the contents of the Nachos directory
 //    -D prints the contents of the entire file system 
 //    -t tests the performance of the Nachos file system
+//    -bench runs a suite of file system benchmarks (see fsbench.cc)
+//    -dt records every disk request in a trace file, and -dtr replays
+//	one, "speedup" times faster (0 for flat out), and prints the
+//	latencies (see disktrace.h)
 //
 //  NETWORK
 //    -n sets the network reliability
@@ -54,6 +75,7 @@
 #include "system.h"
 #include "hello.h"
 #include "dllist.h"
+#include "batch.h"
 
 #ifdef THREADS
 extern int testnum;
@@ -62,12 +84,14 @@ extern int N;
 extern int floors;
 extern int capacity;
 extern int elevs;
+extern char *workload;
 #endif
 
 // External functions used by this file
 
-extern void ThreadTest(void), Copy(char *unixFile, char *nachosFile);
-extern void Print(char *file), PerformanceTest(void);
+extern void ThreadTest(void), Copy(char *unixFile, char *nachosFile,
+						bool compressed);
+extern void Print(char *file), PerformanceTest(void), FileSystemBench(void);
 extern void StartProcess(char *file), ConsoleTest(char *in, char *out);
 extern void MailTest(int networkID);
 
@@ -91,37 +115,48 @@ main(int argc, char **argv)
     int argCount;			// the number of arguments 
 					// for a particular command
 
+    if ((argc > 1) && !strcmp(argv[1], "-batch"))	// we return as one
+	RunBatch(&argc, &argv);				// run of the batch
+
     DEBUG('t', "Entering main");
     (void) Initialize(argc, argv);
 
     
 #ifdef THREADS
-    for (argc--, argv++; argc > 0; argc -= argCount, argv += argCount) {
+    int threadArgc;			// copies for the thread test flags,
+    char **threadArgv;			// which leave the rest of them to us
+
+    for (threadArgc = argc - 1, threadArgv = argv + 1; threadArgc > 0;
+		threadArgc -= argCount, threadArgv += argCount) {
       argCount = 1;
 
-      switch (argv[0][1]) {
+      switch (threadArgv[0][1]) {
       case 'q':
-        testnum = atoi(argv[1]);
+        testnum = atoi(threadArgv[1]);
         argCount++;
         break;
       case 'N':
-        N = atoi(argv[1]);
+        N = atoi(threadArgv[1]);
         argCount++;
         break;
       case 'T':
-        threadnum = atoi(argv[1]);
+        threadnum = atoi(threadArgv[1]);
         argCount++;
         break;
       case 'F':
-        floors = atoi(argv[1]);
+        floors = atoi(threadArgv[1]);
         argCount++;
         break;
       case 'C':
-        capacity = atoi(argv[1]);
+        capacity = atoi(threadArgv[1]);
         argCount++;
         break;
       case 'V':
-        elevs = atoi(argv[1]);
+        elevs = atoi(threadArgv[1]);
+        argCount++;
+        break;
+      case 'W':
+        workload = threadArgv[1];
         argCount++;
         break;
       default:
@@ -166,7 +201,21 @@ main(int argc, char **argv)
 #ifdef FILESYS
 	if (!strcmp(*argv, "-cp")) { 		// copy from UNIX to Nachos
 	    ASSERT(argc > 2);
-	    Copy(*(argv + 1), *(argv + 2));
+	    Copy(*(argv + 1), *(argv + 2), FALSE);
+	    argCount = 3;
+	} else if (!strcmp(*argv, "-cpz")) {	// copy, compressing it
+	    ASSERT(argc > 2);
+	    Copy(*(argv + 1), *(argv + 2), TRUE);
+	    argCount = 3;
+	} else if (!strcmp(*argv, "-cl")) {	// clone a Nachos file
+	    ASSERT(argc > 2);
+	    if (!fileSystem->Clone(*(argv + 1), *(argv + 2)))
+		printf("Clone: couldn't clone %s to %s\n", *(argv + 1),
+		    *(argv + 2));
+	    argCount = 3;
+	} else if (!strcmp(*argv, "-dtr")) {	// replay a disk trace
+	    ASSERT(argc > 2);
+	    DiskTraceReplay(*(argv + 1), atoi(*(argv + 2)));
 	    argCount = 3;
 	} else if (!strcmp(*argv, "-p")) {	// print a Nachos file
 	    ASSERT(argc > 1);
@@ -182,6 +231,8 @@ main(int argc, char **argv)
             fileSystem->Print();
 	} else if (!strcmp(*argv, "-t")) {	// performance test
             PerformanceTest();
+	} else if (!strcmp(*argv, "-bench")) {	// benchmark suite
+            FileSystemBench();
 	}
 #endif // FILESYS
 #ifdef NETWORK
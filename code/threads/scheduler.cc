@@ -4,15 +4,19 @@
 //
 // 	These routines assume that interrupts are already disabled.
 //	If interrupts are disabled, we can assume mutual exclusion
-//	(since we are on a uniprocessor).
+//	(since even with several simulated CPUs, only one runs at a
+//	time, and they only change places in Run).
 //
 // 	NOTE: We can't use Locks to provide mutual exclusion here, since
 // 	if we needed to wait for a lock, and the lock was busy, we would 
 //	end up calling FindNextToRun(), and that would put us in an 
 //	infinite loop.
 //
-// 	Very simple implementation -- no priorities, straight FIFO.
-//	Might need to be improved in later assignments.
+// 	On each CPU, ready real-time threads come first, earliest
+//	deadline first.  Below them is strict priority scheduling: there
+//	is a FIFO ready queue for each priority, and the next thread to
+//	run is the one at the front of the highest priority queue that
+//	isn't empty.
 //
 // Copyright (c) 1992-1993 The Regents of the University of California.
 // All rights reserved.  See copyright.h for copyright notice and limitation 
@@ -21,15 +25,50 @@
 #include "copyright.h"
 #include "scheduler.h"
 #include "system.h"
+#include "synch.h"
+
+//----------------------------------------------------------------------
+// CPU::CPU
+// 	Initialize a simulated CPU, with nothing to run.
+//
+//	"cpuId" -- which CPU this is
+//	"startTime" -- what its clock should start at
+//----------------------------------------------------------------------
+
+CPU::CPU(int cpuId, int startTime)
+{
+    id = cpuId;
+    current = NULL;
+    readyList = new ThreadQueue[NumPriorities];
+    realTimeList = new ThreadQueue;
+    numReady = 0;
+    readyLock = new SpinLock("ready lock");
+    clock = startTime;
+    spinDepth = 0;
+    numSteals = spinTicks = 0;
+}
+
+CPU::~CPU()
+{
+    delete [] readyList;
+    delete realTimeList;
+    delete readyLock;
+}
 
 //----------------------------------------------------------------------
 // Scheduler::Scheduler
-// 	Initialize the list of ready but not running threads to empty.
+// 	Initialize the lists of ready but not running threads to empty,
+//	on a single CPU.
 //----------------------------------------------------------------------
 
 Scheduler::Scheduler()
 { 
-    readyList = new List; 
+    cpus[0] = cpu = new CPU(0, 0);
+    numCPUs = 1;
+    realTimeLoad = 0;
+    lastCharged = 0;
+    numAdmitted = numRejected = numJobs = numMisses = numOverruns = 0;
+    numThrottled = 0;
 } 
 
 //----------------------------------------------------------------------
@@ -39,13 +78,18 @@ Scheduler::Scheduler()
 
 Scheduler::~Scheduler()
 { 
-    delete readyList; 
+    int i;
+
+    for (i = 0; i < numCPUs; i++)
+	delete cpus[i];
 } 
 
 //----------------------------------------------------------------------
 // Scheduler::ReadyToRun
 // 	Mark a thread as ready, but not running.
-//	Put it on the ready list, for later scheduling onto the CPU.
+//	Put it at the end of the ready list for its class and priority,
+//	for later scheduling onto the CPU -- the CPU it last ran on, or
+//	this one if it hasn't run yet.
 //
 //	"thread" is the thread to be put on the ready list.
 //----------------------------------------------------------------------
@@ -55,22 +99,223 @@ Scheduler::ReadyToRun (Thread *thread)
 {
     DEBUG('t', "Putting thread %s on ready list.\n", thread->getName());
 
+    if (thread->cpu == NULL)
+	thread->cpu = cpu;
+    Replenish(thread);			// it may have slept past its period
     thread->setStatus(READY);
-    readyList->Append((void *)thread);
+    thread->readyAt = Now();
+    thread->cpu->readyLock->Acquire();
+    if (IsRealTime(thread))
+	thread->cpu->realTimeList->Append(thread);
+    else
+	thread->cpu->readyList[thread->getPriority() - MinPriority].Append(thread);
+    thread->cpu->numReady++;
+    thread->cpu->readyLock->Release();
+    if ((timer != NULL) && !timer->IsRunning())
+	timer->Start();			// it may need to be time-sliced
 }
 
 //----------------------------------------------------------------------
 // Scheduler::FindNextToRun
-// 	Return the next thread to be scheduled onto the CPU.
-//	If there are no ready threads, return NULL.
+// 	Return the next thread to be scheduled onto this CPU: the real-time
+//	thread with the earliest deadline, if there is one; otherwise the
+//	one that has been waiting longest among the highest priority ready
+//	threads.  If there are no ready threads, return NULL.
+//
+//	"current" -- if not NULL, the thread that is giving up the CPU
+//	(see Thread::Yield); return NULL if it outranks the thread we
+//	would otherwise pick, or holds a SpinLock, since it should keep
+//	running.  If NULL, the CPU has nothing else to do, so if it has
+//	no ready threads of its own, it tries to steal one.
 // Side effect:
 //	Thread is removed from the ready list.
 //----------------------------------------------------------------------
 
 Thread *
-Scheduler::FindNextToRun ()
+Scheduler::FindNextToRun (Thread *current)
 {
-    return (Thread *)readyList->Remove();
+    Thread *best;
+
+    if (current == NULL)
+	return (cpu->numReady > 0) ? TakeFirstReady(cpu) : Steal(cpu);
+    if (cpu->spinDepth > 0)
+	return NULL;
+    cpu->readyLock->Acquire();
+    best = FirstReady(cpu);
+    if ((best != NULL) && !Outranks(current, best))
+	Dequeue(best);
+    else
+	best = NULL;
+    cpu->readyLock->Release();
+    return best;
+}
+
+//----------------------------------------------------------------------
+// Scheduler::FirstReady
+// 	Return the most urgent ready thread on a CPU, without taking it
+//	off the ready list, or NULL if there is none.  The caller holds
+//	the CPU's readyLock.
+//----------------------------------------------------------------------
+
+Thread *
+Scheduler::FirstReady (CPU *c)
+{
+    Thread *best = NULL;
+    Thread *t;
+    int p;
+
+    for (t = c->realTimeList->Front(); t != NULL; t = t->queueNext)
+	if ((best == NULL) || (t->realTime->deadline < best->realTime->deadline))
+	    best = t;
+    for (p = MaxPriority; (best == NULL) && (p >= MinPriority); p--)
+	best = c->readyList[p - MinPriority].Front();
+    return best;
+}
+
+//----------------------------------------------------------------------
+// Scheduler::TakeFirstReady
+// 	Take the most urgent ready thread off a CPU's ready lists, and
+//	return it, or NULL if there is none.
+//----------------------------------------------------------------------
+
+Thread *
+Scheduler::TakeFirstReady (CPU *c)
+{
+    Thread *thread;
+
+    c->readyLock->Acquire();
+    if ((thread = FirstReady(c)) != NULL)
+	Dequeue(thread);
+    c->readyLock->Release();
+    return thread;
+}
+
+//----------------------------------------------------------------------
+// Scheduler::Steal
+// 	A CPU has run out of work: take the most urgent ready thread from
+//	whichever other CPU has the most ready threads (the lowest
+//	numbered, among equals), so that it can run here instead.
+//
+//	"thief" -- the CPU that has nothing to do
+//
+// Returns:
+//	The stolen thread, or NULL if no CPU has a thread to spare.
+//----------------------------------------------------------------------
+
+Thread *
+Scheduler::Steal (CPU *thief)
+{
+    CPU *victim = NULL;
+    Thread *thread;
+    int i;
+
+    for (i = 0; i < numCPUs; i++)
+	if ((cpus[i] != thief) && (cpus[i]->numReady > 0)
+		&& ((victim == NULL) || (cpus[i]->numReady > victim->numReady)))
+	    victim = cpus[i];
+    if (victim == NULL)
+	return NULL;
+
+    thread = TakeFirstReady(victim);
+    DEBUG('t', "CPU %d steals thread %s from CPU %d\n", thief->id,
+	  thread->getName(), victim->id);
+    thief->numSteals++;
+    return thread;
+}
+
+//----------------------------------------------------------------------
+// Scheduler::Outranks
+// 	Compare two threads.  A real-time thread outranks any thread in
+//	the normal class, and another real-time thread with a later
+//	deadline; a normal thread outranks one of lower priority.
+//
+// Returns:
+//	TRUE if "a" should run ahead of "b".
+//----------------------------------------------------------------------
+
+bool
+Scheduler::Outranks (Thread *a, Thread *b)
+{
+    if (IsRealTime(a) != IsRealTime(b))
+	return IsRealTime(a);
+    if (IsRealTime(a))
+	return a->realTime->deadline < b->realTime->deadline;
+    return a->getPriority() > b->getPriority();
+}
+
+//----------------------------------------------------------------------
+// Scheduler::RemoveReady
+// 	Take a particular thread off the ready list, so that the caller
+//	can run it out of turn (see Thread::YieldTo).
+//
+//	"thread" -- the thread to remove
+//
+// Returns:
+//	TRUE if the thread was ready to run, and has been removed.
+//----------------------------------------------------------------------
+
+bool
+Scheduler::RemoveReady (Thread *thread)
+{
+    CPU *c = thread->cpu;
+    bool found;
+
+    if (thread->getStatus() != READY)
+	return FALSE;
+    c->readyLock->Acquire();
+    found = Dequeue(thread);
+    c->readyLock->Release();
+    return found;
+}
+
+//----------------------------------------------------------------------
+// Scheduler::Dequeue
+// 	Take a ready thread off its CPU's ready lists.  The caller holds
+//	the CPU's readyLock.
+//
+// Returns:
+//	TRUE if the thread was on them.
+//----------------------------------------------------------------------
+
+bool
+Scheduler::Dequeue (Thread *thread)
+{
+    CPU *c = thread->cpu;
+    bool found;
+
+    if (IsRealTime(thread))
+	found = c->realTimeList->Remove(thread);
+    else
+	found = c->readyList[thread->getPriority() - MinPriority].Remove(thread);
+    if (found)
+	c->numReady--;
+    return found;
+}
+
+//----------------------------------------------------------------------
+// Scheduler::ChangePriority
+// 	Change a thread's effective priority.  If the thread is on the
+//	ready list, move it to the end of its queue.
+//
+//	"thread" -- the thread whose priority is changing
+//	"newPriority" -- its new effective priority
+//----------------------------------------------------------------------
+
+void
+Scheduler::ChangePriority (Thread *thread, int newPriority)
+{
+    bool ready;
+
+    ASSERT(interrupt->getLevel() == IntOff);
+    if (newPriority == thread->getPriority())
+	return;
+
+    DEBUG('t', "Changing effective priority of thread %s from %d to %d\n",
+	  thread->getName(), thread->getPriority(), newPriority);
+    ready = RemoveReady(thread);
+    thread->setEffectivePriority(newPriority);
+    if (ready)
+	ReadyToRun(thread);
 }
 
 //----------------------------------------------------------------------
@@ -79,18 +324,38 @@ Scheduler::FindNextToRun ()
 //	and load the state of the new thread, by calling the machine
 //	dependent context switch routine, SWITCH.
 //
+//	With more than one CPU, this is also where the CPUs take turns:
+//	once nextThread is this CPU's current thread, we switch to the
+//	current thread of whichever CPU is furthest behind -- which may
+//	be another CPU's, or may be the old thread again.
+//
 //      Note: we assume the state of the previously running thread has
-//	already been changed from running to blocked or ready (depending).
+//	already been changed from running to blocked or ready (depending),
+//	unless it is staying on as this CPU's current thread.
 // Side effect:
-//	The global variable currentThread becomes nextThread.
+//	The global variable currentThread becomes nextThread, or the
+//	thread of another CPU.
 //
-//	"nextThread" is the thread to be put into the CPU.
+//	"nextThread" is the thread to be put into the CPU.  NULL means
+//	this CPU is to go idle, which is allowed only if OtherCPUsBusy().
 //----------------------------------------------------------------------
 
 void
 Scheduler::Run (Thread *nextThread)
 {
     Thread *oldThread = currentThread;
+
+    cpu->current = nextThread;
+    if (nextThread != NULL) {
+	nextThread->cpu = cpu;
+	nextThread->setStatus(RUNNING);
+	if (cpu->clock < nextThread->readyAt)	// it couldn't have run
+	    cpu->clock = nextThread->readyAt;	// before it was ready
+    }
+    cpu = PickCPU();			// whose turn is it?
+    nextThread = cpu->current;
+    if (nextThread == oldThread)	// ours, and we carry on
+	return;
     
 #ifdef USER_PROGRAM			// ignore until running user programs 
     if (currentThread->space != NULL) {	// if this thread is a user program,
@@ -101,9 +366,11 @@ Scheduler::Run (Thread *nextThread)
     
     oldThread->CheckOverflow();		    // check if the old thread
 					    // had an undetected stack overflow
+    Charge(oldThread);			    // and bill it for its time
 
     currentThread = nextThread;		    // switch to the next thread
     currentThread->setStatus(RUNNING);      // nextThread is now running
+    stats->numContextSwitches++;
     
     DEBUG('t', "Switching from thread \"%s\" to thread \"%s\"\n",
 	  oldThread->getName(), nextThread->getName());
@@ -134,14 +401,403 @@ Scheduler::Run (Thread *nextThread)
 #endif
 }
 
+//----------------------------------------------------------------------
+// Scheduler::PickCPU
+// 	Decide which CPU runs next: the one with the earliest clock,
+//	among those with a thread to run (the lowest numbered, among
+//	equals).  Idle CPUs first get a chance to find a thread, from
+//	their own ready lists or by stealing.
+//----------------------------------------------------------------------
+
+CPU *
+Scheduler::PickCPU()
+{
+    CPU *best = NULL;
+    CPU *c;
+    Thread *thread;
+    int i;
+
+    for (i = 0; i < numCPUs; i++) {
+	c = cpus[i];
+	if (c->current == NULL) {
+	    thread = (c->numReady > 0) ? TakeFirstReady(c) : NULL;
+	    if (thread == NULL)
+		thread = Steal(c);
+	    if (thread != NULL) {
+		c->current = thread;
+		thread->cpu = c;
+		thread->setStatus(RUNNING);
+		if (c->clock < thread->readyAt)
+		    c->clock = thread->readyAt;
+	    }
+	}
+	if ((c->current != NULL) && ((best == NULL) || (c->clock < best->clock)))
+	    best = c;
+    }
+    ASSERT(best != NULL);
+    return best;
+}
+
+//----------------------------------------------------------------------
+// Scheduler::OtherCPUsBusy
+// 	Return TRUE if a CPU other than this one has a thread to run, so
+//	that this one can go idle without the whole machine idling.
+//----------------------------------------------------------------------
+
+bool
+Scheduler::OtherCPUsBusy()
+{
+    int i;
+
+    for (i = 0; i < numCPUs; i++)
+	if ((cpus[i] != cpu) && (cpus[i]->current != NULL))
+	    return TRUE;
+    return FALSE;
+}
+
+//----------------------------------------------------------------------
+// Scheduler::Tick
+// 	Advance this CPU's clock by "ticks" it has spent running, idling
+//	until an interrupt, or spinning -- and the machine's clock,
+//	stats->totalTicks, with it, once this CPU is ahead of all the
+//	others (see scheduler.h).  Called by the interrupt simulation,
+//	which then checks whether any device interrupts are due.
+//----------------------------------------------------------------------
+
+void
+Scheduler::Tick(int ticks)
+{
+    cpu->clock += ticks;
+    if (cpu->clock > stats->totalTicks)
+	stats->totalTicks = cpu->clock;
+}
+
+//----------------------------------------------------------------------
+// Scheduler::Spin
+// 	Called by a thread spinning on a SpinLock held by a thread on
+//	another CPU.  Charge this CPU for once round the spin loop, and
+//	let any CPU that is now further behind -- in particular, the one
+//	holding the lock -- have its turn.
+//----------------------------------------------------------------------
+
+void
+Scheduler::Spin()
+{
+    ASSERT(interrupt->getLevel() == IntOff);
+    Tick(SpinTicks);
+    cpu->spinTicks += SpinTicks;
+    Run(currentThread);
+}
+
+//----------------------------------------------------------------------
+// Scheduler::SetNumCPUs
+// 	Change the number of simulated CPUs.  No CPU but this one may be
+//	running a thread.  This CPU becomes CPU 0, taking over the ready
+//	threads of the others; the rest start out idle.  Every clock
+//	starts from the machine's, as far as any CPU had got.  There
+//	can't be real-time threads if n > 1.
+//
+//	"n" -- how many CPUs, between 1 and MaxCPUs
+//----------------------------------------------------------------------
+
+void
+Scheduler::SetNumCPUs(int n)
+{
+    IntStatus oldLevel = interrupt->SetLevel(IntOff);
+    Thread *thread;
+    int i;
+
+    ASSERT((n >= 1) && (n <= MaxCPUs));
+    ASSERT(!OtherCPUsBusy());
+    ASSERT((n == 1) || (realTimeLoad == 0));	// see scheduler.h
+    cpu->clock = stats->totalTicks;	// catch up with the others
+    for (i = 0; i < numCPUs; i++)
+	if (cpus[i] != cpu) {
+	    while ((thread = TakeFirstReady(cpus[i])) != NULL) {
+		thread->cpu = cpu;
+		ReadyToRun(thread);
+	    }
+	    delete cpus[i];
+	}
+
+    cpus[0] = cpu;
+    cpu->id = 0;
+    cpu->current = currentThread;
+    for (i = 1; i < n; i++)
+	cpus[i] = new CPU(i, cpu->clock);
+    numCPUs = n;
+    DEBUG('t', "Now running with %d CPUs\n", n);
+    (void) interrupt->SetLevel(oldLevel);
+}
+
 //----------------------------------------------------------------------
 // Scheduler::Print
 // 	Print the scheduler state -- in other words, the contents of
-//	the ready list.  For debugging.
+//	the ready lists.  For debugging.
 //----------------------------------------------------------------------
 void
 Scheduler::Print()
 {
-    printf("Ready list contents:\n");
-    readyList->Mapcar((VoidFunctionPtr) ThreadPrint);
+    int i, p;
+
+    for (i = 0; i < numCPUs; i++) {
+	printf("CPU %d ready list contents:\n", i);
+	cpus[i]->realTimeList->Mapcar(ThreadPrint);
+	for (p = MaxPriority; p >= MinPriority; p--)
+	    cpus[i]->readyList[p - MinPriority].Mapcar(ThreadPrint);
+    }
+}
+
+//----------------------------------------------------------------------
+// Scheduler::AdmitRealTime
+// 	Put a thread into the real-time class, with its first period
+//	starting now -- if the CPU time it asks for, together with what
+//	has already been reserved, is no more than MaxRealTimeLoad percent.
+//
+//	"thread" -- the thread; it may be running, ready, or not yet forked
+//	"period" -- how often it is released, in ticks
+//	"budget" -- how much CPU time it needs each period, in ticks
+//
+// Returns:
+//	TRUE if the thread was admitted.
+//----------------------------------------------------------------------
+
+bool
+Scheduler::AdmitRealTime (Thread *thread, int period, int budget)
+{
+    int load = (budget * 1000 + period - 1) / period;	// rounded up
+    bool ready;
+    IntStatus oldLevel = interrupt->SetLevel(IntOff);
+
+    ASSERT((budget > 0) && (budget <= period));
+    ASSERT(thread->realTime == NULL);
+    ASSERT(numCPUs == 1);		// see scheduler.h
+    if (realTimeLoad + load > MaxRealTimeLoad * 10) {
+	DEBUG('R', "Rejecting thread %s: period %d, budget %d\n",
+	      thread->getName(), period, budget);
+	numRejected++;
+	(void) interrupt->SetLevel(oldLevel);
+	return FALSE;
+    }
+
+    DEBUG('R', "Admitting thread %s: period %d, budget %d\n",
+	  thread->getName(), period, budget);
+    numAdmitted++;
+    realTimeLoad += load;
+    ready = RemoveReady(thread);
+    thread->realTime = new RealTime(period, budget, stats->totalTicks);
+    if (ready)
+	ReadyToRun(thread);
+    timer->Start();			// to police its budget
+    (void) interrupt->SetLevel(oldLevel);
+    return TRUE;
+}
+
+//----------------------------------------------------------------------
+// Scheduler::LeaveRealTime
+// 	Take a thread out of the real-time class, giving back its
+//	reservation.  Called with interrupts off, by the thread itself
+//	(from Thread::Finish, for instance).
+//----------------------------------------------------------------------
+
+void
+Scheduler::LeaveRealTime (Thread *thread)
+{
+    RealTime *rt = thread->realTime;
+
+    ASSERT(interrupt->getLevel() == IntOff);
+    ASSERT((thread == currentThread) && (rt != NULL));
+    DEBUG('R', "Thread %s leaves the real-time class\n", thread->getName());
+    realTimeLoad -= (rt->budget * 1000 + rt->period - 1) / rt->period;
+    if (rt->throttled)
+	numThrottled--;
+    thread->realTime = NULL;
+    delete rt;
+}
+
+//----------------------------------------------------------------------
+// Scheduler::EndJob
+// 	Record that the running real-time thread has finished its job
+//	for this period, and set it up for the next period: count a
+//	deadline miss if it finished late (and one for each period it
+//	missed altogether), and give it a new budget and deadline.
+//	Called with interrupts off.
+//
+// Returns:
+//	When the next period starts; the thread should sleep until then.
+//----------------------------------------------------------------------
+
+int
+Scheduler::EndJob (Thread *thread)
+{
+    RealTime *rt = thread->realTime;
+    int now = stats->totalTicks;
+
+    ASSERT(interrupt->getLevel() == IntOff);
+    ASSERT((thread == currentThread) && (rt != NULL));
+    Charge(thread);
+    numJobs++;
+    if (now > rt->deadline) {
+	DEBUG('R', "Thread %s missed its deadline %d by %d ticks\n",
+	      thread->getName(), rt->deadline, now - rt->deadline);
+	numMisses++;
+    }
+
+    rt->release = rt->deadline;
+    while (rt->release + rt->period <= now) {	// skip releases we missed
+	rt->release += rt->period;
+	numMisses++;
+    }
+    rt->deadline = rt->release + rt->period;
+    rt->used = 0;
+    if (rt->throttled)
+	numThrottled--;
+    rt->throttled = FALSE;
+    return rt->release;
+}
+
+//----------------------------------------------------------------------
+// Scheduler::Replenish
+// 	If "thread" used up its budget, and its period is now over, give
+//	it a fresh budget and deadline, and put it back in the real-time
+//	class.  Its job missed its deadline (as did any job whose period
+//	went by altogether), but carries on in the new period; so a
+//	thread that overruns its budget falls behind by no more than it
+//	overruns, however much else there is to run.
+//
+//	"thread" must not be on a ready list, since that depends on its
+//	class.  Called with interrupts off.
+//----------------------------------------------------------------------
+
+void
+Scheduler::Replenish (Thread *thread)
+{
+    RealTime *rt = thread->realTime;
+    int now = stats->totalTicks;
+
+    if ((rt == NULL) || !rt->throttled || (now < rt->deadline))
+	return;
+    DEBUG('R', "Thread %s overran its deadline %d; new budget\n",
+	  thread->getName(), rt->deadline);
+    numMisses++;
+    rt->release = rt->deadline;
+    while (rt->release + rt->period <= now) {	// skip releases we missed
+	rt->release += rt->period;
+	numMisses++;
+    }
+    rt->deadline = rt->release + rt->period;
+    rt->used = 0;
+    rt->throttled = FALSE;
+    numThrottled--;
+}
+
+//----------------------------------------------------------------------
+// Scheduler::Charge
+// 	Bill a thread for the CPU time it has used since we last charged
+//	anyone -- not counting time the CPU was idle.  Only real-time
+//	threads keep track of it.
+//----------------------------------------------------------------------
+
+void
+Scheduler::Charge (Thread *thread)
+{
+    int busy = stats->totalTicks - stats->idleTicks;
+
+    if (thread->realTime != NULL)
+	thread->realTime->used += busy - lastCharged;
+    lastCharged = busy;
+}
+
+//----------------------------------------------------------------------
+// Scheduler::CheckBudget
+// 	Called from the timer interrupt handler.  If the running thread
+//	is a real-time thread that has used up its budget for this period,
+//	drop it to the normal class, and make it yield, so that it can't
+//	take time reserved by other real-time threads.
+//
+//	Also replenish any thread that dropped out earlier and whose
+//	period is now over -- the running thread, or one waiting on a
+//	normal ready queue, which may never get to run there.  (One that
+//	is blocked is replenished by ReadyToRun, when it wakes up.)
+//----------------------------------------------------------------------
+
+void
+Scheduler::CheckBudget ()
+{
+    RealTime *rt = currentThread->realTime;
+    Thread *thread, *next;
+    int i, p;
+
+    Charge(currentThread);
+    Replenish(currentThread);
+    if ((rt != NULL) && !rt->throttled && (rt->used >= rt->budget)) {
+	DEBUG('R', "Thread %s used up its budget of %d ticks\n",
+	      currentThread->getName(), rt->budget);
+	rt->throttled = TRUE;
+	numThrottled++;
+	numOverruns++;
+	interrupt->YieldOnReturn();
+    }
+
+    if (numThrottled == 0)
+	return;
+    for (i = 0; i < numCPUs; i++)
+	for (p = 0; p < NumPriorities; p++)
+	    for (thread = cpus[i]->readyList[p].Front(); thread != NULL;
+							thread = next) {
+		next = thread->queueNext;
+		rt = thread->realTime;
+		if ((rt != NULL) && rt->throttled
+			&& (stats->totalTicks >= rt->deadline)) {
+		    (void) RemoveReady(thread);
+		    ReadyToRun(thread);		// replenishes it
+		}
+	    }
+}
+
+//----------------------------------------------------------------------
+// Scheduler::NeedsTimer
+// 	Called from the timer interrupt handler.  Return FALSE if time
+//	slicing can't change what runs: there is no ready thread on any
+//	CPU, no other CPU busy (the CPUs take turns on timer interrupts,
+//	among other places), and no real-time budget to enforce.  The
+//	timer can then be stopped until ReadyToRun next has a thread.
+//----------------------------------------------------------------------
+
+bool
+Scheduler::NeedsTimer ()
+{
+    int i;
+
+    if ((realTimeLoad > 0) || OtherCPUsBusy())
+	return TRUE;
+    for (i = 0; i < numCPUs; i++)
+	if (cpus[i]->numReady > 0)
+	    return TRUE;
+    return FALSE;
+}
+
+//----------------------------------------------------------------------
+// Scheduler::PrintStats
+// 	Print how the real-time threads did, if there were any, and
+//	how busy each CPU was, if there was more than one.
+//----------------------------------------------------------------------
+
+void
+Scheduler::PrintStats()
+{
+    int i;
+
+    if (numAdmitted + numRejected > 0)
+	printf("Real-time: admitted %d, rejected %d, jobs %d, "
+	    "deadline misses %d, budget overruns %d\n", numAdmitted,
+	    numRejected, numJobs, numMisses, numOverruns);
+    if (numCPUs > 1) {
+	for (i = 0; i < numCPUs; i++)
+	    printf("CPU %d: clock %d, spinning %d, steals %d, "
+		"ready lock %d of %d contended\n", i, cpus[i]->clock,
+		cpus[i]->spinTicks, cpus[i]->numSteals,
+		cpus[i]->readyLock->numContended,
+		cpus[i]->readyLock->numAcquires);
+    }
 }
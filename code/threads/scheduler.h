@@ -2,6 +2,35 @@
 //	Data structures for the thread dispatcher and scheduler.
 //	Primarily, the list of threads that are ready to run.
 //
+//	The scheduler can simulate a multiprocessor, with up to MaxCPUs
+//	CPUs.  Each CPU has its own current thread, its own ready lists,
+//	and its own clock, which counts the ticks it has spent running
+//	(or spinning).  Nachos still runs on a single host thread, so
+//	the CPUs take turns: whenever a thread gives up the host -- when
+//	it yields, is time-sliced, sleeps, or spins on a SpinLock -- the
+//	CPU whose clock is furthest behind runs next.  The interleaving
+//	is entirely deterministic, and the largest clock is how long the
+//	work would have taken with the CPUs running side by side.
+//
+//	The machine's clock, stats->totalTicks, which drives the devices
+//	(interrupts, the timer, the disk, alarms), is that largest clock:
+//	it only moves on when the running CPU gets ahead of all the
+//	others.  A CPU that is behind catches up without time passing
+//	for the devices, so a device takes as long, by any CPU's clock,
+//	as it would on a uniprocessor.  (There is one timer, though, so
+//	with n CPUs busy each runs for about n time slices per turn.)
+//
+//	A thread is put on the ready list of the CPU it last ran on.  A
+//	CPU with nothing on its own lists steals the most urgent thread
+//	from the CPU with the most ready threads.
+//
+//	Since the CPUs only change places at the points where a
+//	uniprocessor could switch threads, turning interrupts off still
+//	gives mutual exclusion.  SpinLocks (see synch.h) are there to
+//	measure what contention would cost on a real multiprocessor;
+//	each CPU's ready lists have one, taken by whichever CPU adds a
+//	thread to them or takes one off.
+//
 // Copyright (c) 1992-1993 The Regents of the University of California.
 // All rights reserved.  See copyright.h for copyright notice and limitation 
 // of liability and disclaimer of warranty provisions.
@@ -13,9 +42,50 @@
 #include "list.h"
 #include "thread.h"
 
+class SpinLock;
+
+#define MaxRealTimeLoad	90	// percent of the CPU that may be reserved
+				// by threads in the real-time class
+#define MaxCPUs		8	// most CPUs we can simulate
+#define SpinTicks	SystemTick	// time to go once round a spin loop
+
+// The following class defines one simulated CPU.
+
+class CPU {
+  public:
+    CPU(int cpuId, int startTime);	// initialize an idle CPU
+    ~CPU();
+
+    int id;			// which CPU this is
+    Thread *current;		// thread this CPU is running; NULL if idle
+    ThreadQueue *readyList;	// threads ready to run on this CPU, one
+				// queue per priority
+    ThreadQueue *realTimeList;	// ready real-time threads, in the order
+				// they became ready
+    int numReady;		// threads on the queues above
+    SpinLock *readyLock;	// held while they are looked at or changed
+    int clock;			// local time, in ticks
+    int spinDepth;		// SpinLocks held by the current thread; it
+				// can't be switched out while it holds one
+
+    int numSteals;		// statistics
+    int spinTicks;
+};
+
 // The following class defines the scheduler/dispatcher abstraction -- 
 // the data structures and operations needed to keep track of which 
 // thread is running, and which threads are ready but not running.
+//
+// There are two scheduling classes.  Real-time threads are released
+// once every "period", and reserve "budget" ticks of CPU time in each;
+// they are run earliest deadline first, ahead of every other thread.
+// A thread that uses up its budget drops to the normal class -- strict
+// priority, FIFO within a priority -- until its next period.  Admission
+// control keeps the reserved budgets to MaxRealTimeLoad percent of the
+// CPU, so that (as long as each thread stays within its budget) every
+// real-time thread can meet its deadlines.  Deadlines are kept in
+// stats->totalTicks, which is only the same as a CPU's clock when
+// there is one CPU, so the real-time class needs a uniprocessor.
 
 class Scheduler {
   public:
@@ -23,14 +93,78 @@ class Scheduler {
     ~Scheduler();			// De-allocate ready list
 
     void ReadyToRun(Thread* thread);	// Thread can be dispatched.
-    Thread* FindNextToRun();		// Dequeue first thread on the ready 
-					// list, if any, and return thread.
+    Thread* FindNextToRun(Thread* current = NULL);
+					// Dequeue the most urgent thread on
+					// this CPU's ready list, and return
+					// it -- unless current is more urgent.
+					// With no current thread, steal one
+					// from another CPU if need be.
+    bool Outranks(Thread* a, Thread* b);	// TRUE if a should run
+					// ahead of b
     void Run(Thread* nextThread);	// Cause nextThread to start running
+					// on this CPU (NULL: make it idle),
+					// and let the CPU furthest behind run
+    bool RemoveReady(Thread* thread);	// Take thread off the ready list;
+					// FALSE if it isn't on it
+    void ChangePriority(Thread* thread, int newPriority);
+					// Set thread's effective priority,
+					// moving it if it is ready
     void Print();			// Print contents of ready list
+
+    bool AdmitRealTime(Thread* thread, int period, int budget);
+					// Put thread in the real-time class,
+					// if there is enough CPU to spare
+    void LeaveRealTime(Thread* thread);	// Return thread to the normal class
+    int EndJob(Thread* thread);		// A real-time thread's job is done;
+					// start its next period, and return
+					// when that is
+    void CheckBudget();			// Called on each timer interrupt
+    bool NeedsTimer();			// could a timer interrupt make a
+					// difference to who runs?
+    void PrintStats();			// Print real-time and multiprocessor
+					// statistics
+
+    void SetNumCPUs(int n);		// Change the number of CPUs; only
+					// the current thread may be running
+    int NumCPUs() { return numCPUs; }
+    CPU *CurrentCPU() { return cpu; }	// the CPU the current thread is on
+    bool OtherCPUsBusy();		// is another CPU running a thread?
+    int Now() { return cpu->clock; }	// the current CPU's clock
+    void Tick(int ticks);		// advance it, and the machine's
+					// clock once it is furthest ahead
+    void Spin();			// burn a spin loop's worth of time,
+					// and let the other CPUs run
     
   private:
-    List *readyList;  		// queue of threads that are ready to run,
-				// but not running
+    CPU *cpus[MaxCPUs];		// the CPUs
+    int numCPUs;
+    CPU *cpu;			// the CPU that is running now
+
+    Thread *FirstReady(CPU *c);	// the most urgent thread on c's
+				// ready lists
+    Thread *TakeFirstReady(CPU *c);	// and take it off them
+    bool Dequeue(Thread *thread);	// take thread off its CPU's ready
+				// lists; the caller holds its readyLock
+    Thread *Steal(CPU *thief);	// dequeue a thread from the CPU with
+				// the most ready threads
+    CPU *PickCPU();		// the CPU whose turn it is
+
+    int realTimeLoad;		// budgets reserved, in tenths of a percent
+    int lastCharged;		// busy (non-idle) time up to which the
+				// running thread has been charged
+
+    bool IsRealTime(Thread* thread)	// in the real-time class, and
+	{ return (thread->realTime != NULL) && !thread->realTime->throttled; }
+					// within its budget?
+    void Charge(Thread* thread);	// charge thread for the CPU it has used
+    void Replenish(Thread* thread);	// new budget, if its period is over
+
+    int numAdmitted;		// real-time statistics
+    int numRejected;
+    int numJobs;
+    int numMisses;
+    int numOverruns;
+    int numThrottled;		// real-time threads out of budget
 };
 
 #endif // SCHEDULER_H
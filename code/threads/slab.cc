@@ -0,0 +1,182 @@
+// slab.cc
+//	Routines to manage a cache of fixed-size objects.
+//
+//	A slab is one block of host memory, holding a link to the
+//	next slab followed by "perSlab" objects.  When a cache runs
+//	out of free objects, it mallocs one more slab and threads all
+//	of its objects onto the free list.  A free object uses its own
+//	first word as the free list link, so the free list costs no
+//	extra memory.
+//
+// Copyright (c) 1992-1993 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#include "copyright.h"
+#include "slab.h"
+
+// every object, and the slab link, is padded out to this many bytes,
+// so that any kind of object is properly aligned
+#define SlabAlign	8
+
+ObjectCache *ObjectCache::allCaches = NULL;
+
+//----------------------------------------------------------------------
+// ObjectCache::ObjectCache
+// 	Initialize an empty object cache.  No memory is allocated until
+//	the first call to Alloc.
+//
+//	"debugName" is an arbitrary name, useful for debugging.
+//	"objectSize" is the number of bytes in each object.
+//	"objectsPerSlab" is the number of objects to get from the host
+//		at a time.
+//	"initFunc", if not NULL, is called on each object (passed as
+//		an int, as with Thread::Fork) the first time it is carved
+//		out of a slab.
+//----------------------------------------------------------------------
+
+ObjectCache::ObjectCache(char *debugName, int objectSize, int objectsPerSlab,
+			 VoidFunctionPtr initFunc)
+{
+    ASSERT((objectSize > 0) && (objectsPerSlab > 0));
+    name = debugName;
+    if (objectSize < (int) sizeof(void *))
+	objectSize = sizeof(void *);
+    size = divRoundUp(objectSize, SlabAlign) * SlabAlign;
+    perSlab = objectsPerSlab;
+    init = initFunc;
+    freeList = NULL;
+    slabs = NULL;
+    numAllocs = numFrees = numSlabs = inUse = maxInUse = 0;
+
+    nextCache = allCaches;
+    allCaches = this;
+}
+
+//----------------------------------------------------------------------
+// ObjectCache::~ObjectCache
+// 	Give every slab back to the host.  Any objects still handed out
+//	become invalid.
+//----------------------------------------------------------------------
+
+ObjectCache::~ObjectCache()
+{
+    ObjectCache **ptr;
+
+    while (slabs != NULL) {
+	char *slab = (char *) slabs;
+	slabs = *(void **) slab;
+	delete [] slab;
+    }
+    for (ptr = &allCaches; *ptr != NULL; ptr = &(*ptr)->nextCache)
+	if (*ptr == this) {
+	    *ptr = nextCache;
+	    break;
+	}
+}
+
+//----------------------------------------------------------------------
+// ObjectCache::Grow
+// 	Get one more slab from the host, and put all of its objects on
+//	the free list, initializing each one if the cache has an
+//	initialization function.
+//----------------------------------------------------------------------
+
+void
+ObjectCache::Grow()
+{
+    char *slab = new char[SlabAlign + perSlab * size];
+    int i;
+
+    *(void **) slab = slabs;
+    slabs = (void *) slab;
+    numSlabs++;
+    DEBUG('k', "Cache %s: new slab %d, %d objects of %d bytes\n", name,
+		numSlabs, perSlab, size);
+
+    // push the objects in reverse, so they are handed out in address order
+    for (i = perSlab - 1; i >= 0; i--) {
+	void *object = (void *) (slab + SlabAlign + i * size);
+
+	if (init != NULL)
+	    (*init)((int) object);
+	*(void **) object = freeList;
+	freeList = object;
+    }
+}
+
+//----------------------------------------------------------------------
+// ObjectCache::Alloc
+// 	Hand out a free object, getting a new slab from the host if
+//	there aren't any.
+//
+//	Note that the first word of the object was used as the free
+//	list link; an initialization function can't count on it being
+//	preserved.
+//----------------------------------------------------------------------
+
+void *
+ObjectCache::Alloc()
+{
+    void *object;
+
+    if (freeList == NULL)
+	Grow();
+    object = freeList;
+    freeList = *(void **) object;
+
+    numAllocs++;
+    if (++inUse > maxInUse)
+	maxInUse = inUse;
+    return object;
+}
+
+//----------------------------------------------------------------------
+// ObjectCache::Free
+// 	Put an object back on the free list, to be handed out by a
+//	later Alloc.
+//
+//	"object" -- an object previously returned by Alloc on this cache
+//----------------------------------------------------------------------
+
+void
+ObjectCache::Free(void *object)
+{
+    if (object == NULL)
+	return;
+    ASSERT(inUse > 0);
+    *(void **) object = freeList;
+    freeList = object;
+    numFrees++;
+    inUse--;
+}
+
+//----------------------------------------------------------------------
+// ObjectCache::Print
+// 	Print how much the cache has been used, and how many calls to
+//	the host allocator it saved.
+//----------------------------------------------------------------------
+
+void
+ObjectCache::Print()
+{
+    printf("Cache %s: %d-byte objects, allocs %d, frees %d, in use %d, "
+	"peak %d, slabs %d (%d mallocs saved)\n", name, size, numAllocs,
+	numFrees, inUse, maxInUse, numSlabs, numAllocs - numSlabs);
+}
+
+//----------------------------------------------------------------------
+// ObjectCache::PrintAll
+// 	Print statistics for every cache that has handed out at least
+//	one object.  Called when Nachos halts.
+//----------------------------------------------------------------------
+
+void
+ObjectCache::PrintAll()
+{
+    ObjectCache *cache;
+
+    for (cache = allCaches; cache != NULL; cache = cache->nextCache)
+	if (cache->numAllocs > 0)
+	    cache->Print();
+}
@@ -0,0 +1,76 @@
+// slab.h
+//	Data structures for a slab allocator -- a cache of fixed-size
+//	objects that the kernel allocates and frees over and over
+//	(list elements, pending interrupts, mail messages, disk and
+//	network buffers).
+//
+//	Each ObjectCache hands out objects of one size.  Rather than
+//	calling malloc for every object, the cache gets memory from the
+//	host a "slab" (a batch of objects) at a time, and keeps freed
+//	objects on a free list to be handed out again.  Objects are
+//	never returned to the host until the cache itself is deleted.
+//
+//	Optionally, the cache can initialize each object once, when it
+//	is carved out of a fresh slab, rather than every time it is
+//	allocated; an object that is freed in its initialized state
+//	can then be reused without being set up again.
+//
+//	Like List, an ObjectCache does no synchronization of its own.
+//	Alloc and Free never block or enable interrupts, so on our
+//	uniprocessor they can't be interrupted part way through.
+//
+// Copyright (c) 1992-1993 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#ifndef SLAB_H
+#define SLAB_H
+
+#include "copyright.h"
+#include "utility.h"
+
+// The following class defines an object cache.  Kernel classes
+// that are allocated often declare their own operator new and
+// operator delete, which call Alloc and Free on a cache of
+// sizeof(class) objects.
+
+class ObjectCache {
+  public:
+    ObjectCache(char *debugName, int objectSize, int objectsPerSlab,
+		VoidFunctionPtr initFunc = NULL);
+				// initialize an empty cache of
+				// "objectSize" byte objects
+    ~ObjectCache();		// return all the slabs to the host
+
+    void *Alloc();		// get an object, growing the cache
+				// by one slab if the free list is empty
+    void Free(void *object);	// put an object back on the free list
+
+    void Print();		// print usage statistics
+    static void PrintAll();	// print statistics for every cache
+				// that has been used
+
+  private:
+    char *name;			// for debugging and statistics
+    int size;			// bytes per object
+    int perSlab;		// objects per slab
+    VoidFunctionPtr init;	// called once on each object, when it
+				// is carved out of a new slab
+    void *freeList;		// objects ready to be handed out; each
+				// free object holds a pointer to the next
+    void *slabs;		// every slab we got from the host, chained
+				// through the first word of the slab
+
+    int numAllocs;		// objects handed out
+    int numFrees;		// objects returned
+    int numSlabs;		// slabs allocated (= host malloc calls)
+    int inUse;			// objects currently handed out
+    int maxInUse;		// high water mark of inUse
+
+    ObjectCache *nextCache;	// chain of all caches, for PrintAll
+    static ObjectCache *allCaches;
+
+    void Grow();		// add one slab to the free list
+};
+
+#endif // SLAB_H
@@ -37,7 +37,7 @@ Semaphore::Semaphore(char* debugName, int initialValue)
 {
     name = debugName;
     value = initialValue;
-    queue = new List;
+    queue = new ThreadQueue;
 }
 
 //----------------------------------------------------------------------
@@ -67,7 +67,7 @@ Semaphore::P()
     IntStatus oldLevel = interrupt->SetLevel(IntOff);   // disable interrupts
 
     while (value == 0) {            // semaphore not available
-        queue->Append((void *)currentThread);   // so go to sleep
+        queue->Append(currentThread);   // so go to sleep
         currentThread->Sleep();
     }
     value--;            // semaphore available,
@@ -89,7 +89,7 @@ Semaphore::V()
     Thread *thread;
     IntStatus oldLevel = interrupt->SetLevel(IntOff);
 
-    thread = (Thread *)queue->Remove();
+    thread = queue->Remove();
     if (thread != NULL)    // make thread ready, consuming the V immediately
     scheduler->ReadyToRun(thread);
     value++;
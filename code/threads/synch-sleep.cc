@@ -37,7 +37,7 @@ Semaphore::Semaphore(char* debugName, int initialValue)
 {
     name = debugName;
     value = initialValue;
-    queue = new List;
+    queue = new ThreadQueue;
 }
 
 //----------------------------------------------------------------------
@@ -67,7 +67,7 @@ Semaphore::P()
     IntStatus oldLevel = interrupt->SetLevel(IntOff);   // disable interrupts
     
     while (value == 0) {            // semaphore not available
-    queue->Append((void *)currentThread);   // so go to sleep
+    queue->Append(currentThread);   // so go to sleep
     currentThread->Sleep();
     } 
     value--;                    // semaphore available, 
@@ -90,7 +90,7 @@ Semaphore::V()
     Thread *thread;
     IntStatus oldLevel = interrupt->SetLevel(IntOff);
 
-    thread = (Thread *)queue->Remove();
+    thread = queue->Remove();
     if (thread != NULL)    // make thread ready, consuming the V immediately
     scheduler->ReadyToRun(thread);
     value++;
@@ -109,7 +109,7 @@ Semaphore::V()
 Lock::Lock(char* debugName) {
     name=debugName;
     mutex=1;
-    queue = new List;
+    queue = new ThreadQueue;
     heldByThread=NULL;
 }
 
@@ -124,7 +124,7 @@ void Lock::Acquire() {
     DEBUG('l',"thread %s try to acquire lock\n",currentThread->getName());
     while(mutex==0){
         //can not enable int here because---Release can check the queue and not wake up thread.
-        queue->Append((void *)currentThread);   // so go to sleep
+        queue->Append(currentThread);   // so go to sleep
         //can not enable int here because---Misses wakeup and still holds lock (deadlock!)
         DEBUG('l',"thread %s try to acquire lock, but failed\n",currentThread->getName());
         currentThread->Sleep();
@@ -138,7 +138,7 @@ void Lock::Acquire() {
 void Lock::Release() {
     ASSERT(isHeldByCurrentThread());
     IntStatus oldLevel = interrupt->SetLevel(IntOff);   // disable interrupts
-    Thread *thread = (Thread *)queue->Remove();
+    Thread *thread = queue->Remove();
     mutex=1;
     heldByThread=NULL;
     DEBUG('l',"\033[1;33;40mlock Released by thread: %s\033[m\n\n",currentThread->getName());
@@ -162,7 +162,7 @@ bool Lock::isHeldByCurrentThread(){
 Condition::Condition(char* debugName) {
     firstLock=NULL;
     name=debugName;
-    queue=new List;
+    queue=new ThreadQueue;
 }
 
 Condition::~Condition() {
@@ -179,7 +179,7 @@ void Condition::Wait(Lock* conditionLock) {
     ASSERT(conditionLock->isHeldByCurrentThread());
     IntStatus oldLevel = interrupt->SetLevel(IntOff);   // disable interrupts
     DEBUG('c',"\033[1;34;40mthread %s Wait\033[m\n",currentThread->getName());
-    queue->Append((void *)currentThread);   // so go to sleep
+    queue->Append(currentThread);   // so go to sleep
     conditionLock->Release();
     currentThread->Sleep();
     conditionLock->Acquire();
@@ -197,7 +197,7 @@ void Condition::Signal(Lock* conditionLock) {
     Thread *thread;
     IntStatus oldLevel = interrupt->SetLevel(IntOff);   // disable interrupts
     
-    thread = (Thread *)queue->Remove();
+    thread = queue->Remove();
     if(thread!=NULL)
         scheduler->ReadyToRun(thread);
     DEBUG('c',"\033[1;34;40mthread %s Signal\033[m\n",currentThread->getName());
@@ -214,7 +214,7 @@ void Condition::Broadcast(Lock* conditionLock) {
     Thread *thread;
     IntStatus oldLevel = interrupt->SetLevel(IntOff);   // disable interrupts
     while(!queue->IsEmpty()){
-        thread = (Thread *)queue->Remove();
+        thread = queue->Remove();
         scheduler->ReadyToRun(thread);
     }
     DEBUG('c',"\033[1;34;40mthread %s Broadcast\033[m\n",currentThread->getName());
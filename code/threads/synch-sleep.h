@@ -48,7 +48,7 @@ class Semaphore {
   private:
     char* name;        // useful for debugging
     int value;         // semaphore value, always >= 0
-    List *queue;       // threads waiting in P() for the value to be > 0
+    ThreadQueue *queue; // threads waiting in P() for the value to be > 0
 };
 
 // The following class defines a "lock".  A lock can be BUSY or FREE.
@@ -80,7 +80,7 @@ class Lock {
   private:
     char* name;             // for debugging
     int mutex;
-    List* queue; // queue of waiting for mutex
+    ThreadQueue* queue; // queue of waiting for mutex
     // plus some other stuff you'll need to define
     Thread * heldByThread;
 };
@@ -135,6 +135,6 @@ class Condition {
   private:
     void* firstLock;
     char* name;
-    List *queue;
+    ThreadQueue *queue;
 };
 #endif // SYNCH_H
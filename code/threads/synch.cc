@@ -37,7 +37,8 @@ Semaphore::Semaphore(char* debugName, int initialValue)
 {
     name = debugName;
     value = initialValue;
-    queue = new List;
+    queue = new ThreadQueue;
+    taskQueue = new TaskQueue;
 }
 
 //----------------------------------------------------------------------
@@ -49,6 +50,7 @@ Semaphore::Semaphore(char* debugName, int initialValue)
 Semaphore::~Semaphore()
 {
     delete queue;
+    delete taskQueue;
 }
 
 //----------------------------------------------------------------------
@@ -67,7 +69,7 @@ Semaphore::P()
     IntStatus oldLevel = interrupt->SetLevel(IntOff);   // disable interrupts
     
     while (value == 0) {            // semaphore not available
-    queue->Append((void *)currentThread);   // so go to sleep
+    queue->Append(currentThread);   // so go to sleep
     currentThread->Sleep();
     } 
     value--;                    // semaphore available, 
@@ -88,16 +90,49 @@ void
 Semaphore::V()
 {
     Thread *thread;
+    Task *task;
     IntStatus oldLevel = interrupt->SetLevel(IntOff);
 
-    thread = (Thread *)queue->Remove();
-    if (thread != NULL)    // make thread ready, consuming the V immediately
-    scheduler->ReadyToRun(thread);
-    value++;
+    thread = queue->Remove();
+    if (thread != NULL) {   // make thread ready, consuming the V immediately
+        scheduler->ReadyToRun(thread);
+        value++;
+    } else if ((task = taskQueue->Remove()) != NULL)
+        task->Wake();       // hand the V straight to the task
+    else
+        value++;
 
     (void) interrupt->SetLevel(oldLevel);
 }
 
+//----------------------------------------------------------------------
+// Semaphore::P(Task *)
+//  Like P, but for a stackless task, which can't sleep.  If the
+//  semaphore is available, decrement it and return TRUE.  Otherwise
+//  queue the task and return FALSE; the task will be woken when a V
+//  has been handed to it, so it should not decrement again.
+//
+//  "task" -- the task doing the P (normally "this", inside TASK_AWAIT)
+//----------------------------------------------------------------------
+
+bool
+Semaphore::P(Task *task)
+{
+    bool gotIt;
+    IntStatus oldLevel = interrupt->SetLevel(IntOff);   // disable interrupts
+
+    if (value > 0) {
+        value--;
+        gotIt = TRUE;
+    } else {
+        taskQueue->Append(task);
+        gotIt = FALSE;
+    }
+
+    (void) interrupt->SetLevel(oldLevel);   // re-enable interrupts
+    return gotIt;
+}
+
 
 
 // ====================   LOCK   ==============================================
@@ -109,8 +144,9 @@ Semaphore::V()
 Lock::Lock(char* debugName) {
     name=debugName;
     mutex=1;
-    queue = new List;
+    queue = new ThreadQueue;
     heldByThread=NULL;
+    nextHeld=NULL;
 }
 
 Lock::~Lock() {
@@ -124,7 +160,9 @@ void Lock::Acquire() {
     DEBUG('l',"thread %s try to acquire lock\n",currentThread->getName());
     while(mutex==0){
         //can not enable int here because---Release can check the queue and not wake up thread.
-        queue->Append((void *)currentThread);   // so go to sleep
+        queue->Append(currentThread);   // so go to sleep
+        currentThread->waitingFor=this;
+        UpdatePriority(heldByThread);   // donate our priority to the holder
         //can not enable int here because---Misses wakeup and still holds lock (deadlock!)
         DEBUG('l',"thread %s try to acquire lock, but failed\n",currentThread->getName());
         currentThread->Sleep();
@@ -132,20 +170,86 @@ void Lock::Acquire() {
     mutex=0;
     DEBUG('l',"\033[1;33;40mlock Acquired by thread: %s\033[m\n",currentThread->getName());
     heldByThread=currentThread;
+    nextHeld=currentThread->locksHeld;
+    currentThread->locksHeld=this;
+    UpdatePriority(currentThread);  // inherit from anyone still waiting
     (void) interrupt->SetLevel(oldLevel);
 }
 
+// Release the lock, handing it to the highest priority waiter (the
+// longest waiting, among equals), and give back any priority that was
+// donated to us through it.  If the waiter now outranks us (see
+// Scheduler::Outranks), let it run
+// -- unless we were called with interrupts off (by Condition::Wait, for
+// instance), in which case the caller is in the middle of something
+// atomic, and the waiter runs when we next yield or sleep.
 void Lock::Release() {
     ASSERT(isHeldByCurrentThread());
     IntStatus oldLevel = interrupt->SetLevel(IntOff);   // disable interrupts
-    Thread *thread = (Thread *)queue->Remove();
+    Thread *thread = queue->Front();
+    Thread *t;
+    for (t = thread; t != NULL; t = t->queueNext)
+        if (t->getPriority() > thread->getPriority())
+            thread = t;
+    if (thread != NULL)
+        queue->Remove(thread);
+    RemoveFromHolder();
     mutex=1;
     heldByThread=NULL;
+    UpdatePriority(currentThread);  // drop anything donated through us
     DEBUG('l',"\033[1;33;40mlock Released by thread: %s\033[m\n\n",currentThread->getName());
     if (thread != NULL){    // make thread ready, consuming the V immediately
+        thread->waitingFor=NULL;
         scheduler->ReadyToRun(thread);
     }
     (void) interrupt->SetLevel(oldLevel);   // re-enable interrupts
+    if (thread != NULL && oldLevel == IntOn
+            && scheduler->Outranks(thread, currentThread))
+        currentThread->YieldTo(thread);
+}
+
+// Put a thread that is already asleep (in Condition::Wait) on the
+// lock's wait queue, donating its priority just as Acquire would.
+// Called by the holder, with interrupts off.
+void Lock::AddWaiter(Thread* thread) {
+    ASSERT(interrupt->getLevel() == IntOff);
+    ASSERT(isHeldByCurrentThread());
+    queue->Append(thread);
+    thread->waitingFor=this;
+    UpdatePriority(heldByThread);
+}
+
+// Take this lock off the list of locks its holder holds.
+void Lock::RemoveFromHolder() {
+    Lock **ptr;
+    for (ptr = &heldByThread->locksHeld; *ptr != this; ptr = &(*ptr)->nextHeld)
+        ASSERT(*ptr != NULL);
+    *ptr = nextHeld;
+    nextHeld = NULL;
+}
+
+// Recompute the effective priority of "thread" -- the highest of its
+// base priority and the priorities of the threads waiting for locks
+// it holds.  If that changes it, and it is itself waiting for a lock,
+// the holder of that lock has to be recomputed too, and so on down the
+// chain.  Called with interrupts off.
+void Lock::UpdatePriority(Thread* thread) {
+    ASSERT(interrupt->getLevel() == IntOff);
+    while (thread != NULL) {
+        int priority = thread->getBasePriority();
+        Lock *lock;
+        Thread *t;
+        for (lock = thread->locksHeld; lock != NULL; lock = lock->nextHeld)
+            for (t = lock->queue->Front(); t != NULL; t = t->queueNext)
+                if (t->getPriority() > priority)
+                    priority = t->getPriority();
+        if (priority == thread->getPriority())
+            break;
+        DEBUG('l',"thread %s now runs at priority %d\n",thread->getName(),priority);
+        scheduler->ChangePriority(thread, priority);
+        thread = (thread->waitingFor == NULL) ? NULL
+                    : thread->waitingFor->heldByThread;
+    }
 }
 
 bool Lock::isHeldByCurrentThread(){
@@ -157,17 +261,63 @@ bool Lock::isHeldByCurrentThread(){
 
 
 
+//=================   SPIN LOCK   =====================================================
+
+SpinLock::SpinLock(char* debugName) {
+    name=debugName;
+    holder=NULL;
+    numAcquires=numContended=0;
+}
+
+SpinLock::~SpinLock() {
+    ASSERT(holder==NULL);
+}
+
+// Spin until the lock is free.  The holder is on another CPU (it can't
+// have been switched out while holding the lock), so each time round
+// the loop, Scheduler::Spin charges our CPU and lets the other CPUs
+// catch up, until the holder gets to its Release.  Until we release
+// the lock, our CPU won't switch to another thread.
+void SpinLock::Acquire() {
+    ASSERT(!isHeldByCurrentThread());
+    IntStatus oldLevel = interrupt->SetLevel(IntOff);   // disable interrupts
+    numAcquires++;
+    if (holder!=NULL)
+        numContended++;
+    while (holder!=NULL) {
+        ASSERT(holder->cpu!=scheduler->CurrentCPU());   // or we'd spin forever
+        scheduler->Spin();
+    }
+    holder=currentThread;
+    scheduler->CurrentCPU()->spinDepth++;
+    (void) interrupt->SetLevel(oldLevel);
+}
+
+void SpinLock::Release() {
+    ASSERT(isHeldByCurrentThread());
+    IntStatus oldLevel = interrupt->SetLevel(IntOff);   // disable interrupts
+    holder=NULL;
+    scheduler->CurrentCPU()->spinDepth--;
+    (void) interrupt->SetLevel(oldLevel);
+}
+
+bool SpinLock::isHeldByCurrentThread() {
+    return holder==currentThread;
+}
+
+
+
+
 //=================   CONDITION   =====================================================
 
 Condition::Condition(char* debugName) {
     firstLock=NULL;
     name=debugName;
-    queue=new List;
+    queue=new ThreadQueue;
 }
 
 Condition::~Condition() {
     delete queue;
-    delete firstLock;
 }
 
 void Condition::Wait(Lock* conditionLock) {
@@ -179,9 +329,10 @@ void Condition::Wait(Lock* conditionLock) {
     ASSERT(conditionLock->isHeldByCurrentThread());
     IntStatus oldLevel = interrupt->SetLevel(IntOff);   // disable interrupts
     DEBUG('c',"\033[1;34;40mthread %s Wait\033[m\n",currentThread->getName());
-    queue->Append((void *)currentThread);   // so go to sleep
+    queue->Append(currentThread);   // so go to sleep
     conditionLock->Release();
-    currentThread->Sleep();
+    currentThread->Sleep();         // until Signal has moved us to the
+                                    // lock's queue, and Release wakes us
     conditionLock->Acquire();
     
     (void) interrupt->SetLevel(oldLevel);
@@ -197,9 +348,10 @@ void Condition::Signal(Lock* conditionLock) {
     Thread *thread;
     IntStatus oldLevel = interrupt->SetLevel(IntOff);   // disable interrupts
     
-    thread = (Thread *)queue->Remove();
+    thread = queue->Remove();
     if(thread!=NULL)
-        scheduler->ReadyToRun(thread);
+        conditionLock->AddWaiter(thread);   // wait morphing: it can't run
+                                            // until we release the lock
     DEBUG('c',"\033[1;34;40mthread %s Signal\033[m\n",currentThread->getName());
     (void) interrupt->SetLevel(oldLevel);
 }
@@ -214,8 +366,8 @@ void Condition::Broadcast(Lock* conditionLock) {
     Thread *thread;
     IntStatus oldLevel = interrupt->SetLevel(IntOff);   // disable interrupts
     while(!queue->IsEmpty()){
-        thread = (Thread *)queue->Remove();
-        scheduler->ReadyToRun(thread);
+        thread = queue->Remove();
+        conditionLock->AddWaiter(thread);
     }
     DEBUG('c',"\033[1;34;40mthread %s Broadcast\033[m\n",currentThread->getName());
     (void) interrupt->SetLevel(oldLevel);
@@ -20,6 +20,7 @@
 #include "copyright.h"
 #include "thread.h"
 #include "list.h"
+#include "task.h"
 
 // The following class defines a "semaphore" whose value is a non-negative
 // integer.  The semaphore has only two operations P() and V():
@@ -44,11 +45,17 @@ class Semaphore {
     
     void P();    // these are the only operations on a semaphore
     void V();    // they are both *atomic*
+
+    bool P(Task *task);	// P on behalf of a task: TRUE if the value
+			// was > 0 and has been decremented; otherwise
+			// the task is queued, and V will hand it the
+			// value and wake it
     
   private:
     char* name;        // useful for debugging
     int value;         // semaphore value, always >= 0
-    List *queue;       // threads waiting in P() for the value to be > 0
+    ThreadQueue *queue; // threads waiting in P() for the value to be > 0
+    TaskQueue *taskQueue; // tasks waiting in P(task)
 };
 
 // The following class defines a "lock".  A lock can be BUSY or FREE.
@@ -62,6 +69,13 @@ class Semaphore {
 // In addition, by convention, only the thread that acquired the lock
 // may release it.  As with semaphores, you can't read the lock value
 // (because the value might change immediately after you read it).  
+//
+// Locks use priority inheritance: while a thread waits in Acquire, the
+// holder of the lock runs at (at least) the waiter's priority, and so
+// on down the chain if the holder is itself waiting for another lock.
+// Otherwise a medium priority thread that never touches the lock could
+// keep the holder -- and so the waiter -- off the CPU indefinitely.
+// Release hands the lock to the highest priority waiter.
 
 class Lock {
   public:
@@ -76,13 +90,61 @@ class Lock {
                     // holds this lock.  Useful for
                     // checking in Release, and in
                     // Condition variable ops below.
+
+    void AddWaiter(Thread *thread);
+                    // queue a sleeping thread as though it were
+                    // waiting in Acquire; it is woken by Release,
+                    // and must then call Acquire itself
+
+    static void UpdatePriority(Thread *thread);
+                    // recompute thread's effective priority from
+                    // its base priority and the waiters on the locks
+                    // it holds, passing any change on to the holder
+                    // of the lock it is waiting for
     
   private:
     char* name;             // for debugging
     int mutex;
-    List* queue; // queue of waiting for mutex
+    ThreadQueue* queue; // queue of waiting for mutex
     // plus some other stuff you'll need to define
     Thread * heldByThread;
+    Lock *nextHeld;         // next lock held by heldByThread
+
+    void RemoveFromHolder();    // take this lock off heldByThread's
+                    // list of locks held
+};
+
+// The following class defines a "spin lock" -- a lock for short critical
+// sections in kernel data structures shared between CPUs.  A thread
+// waiting for a SpinLock doesn't sleep; it spins until the holder,
+// which is running on another CPU, releases it.  So the holder must
+// not sleep, or yield its CPU to another thread, while it holds one
+// (Thread::Yield and Thread::Sleep see to that).
+//
+// Nachos CPUs only take turns at thread switch points (see scheduler.h),
+// so a SpinLock adds no mutual exclusion that turning interrupts off
+// wouldn't give; what it adds is the cost of contention -- the time
+// each CPU spends spinning -- so that kernel data structures can be
+// measured as the number of CPUs grows.
+
+class SpinLock {
+  public:
+    SpinLock(char* debugName);	// initialize lock to be FREE
+    ~SpinLock();
+    char* getName() { return name; }
+
+    void Acquire();		// spin until the lock is FREE, then set it
+    void Release();		// to BUSY; and set it FREE again
+
+    bool isHeldByCurrentThread();	// TRUE if the current thread
+					// holds the lock
+
+    int numAcquires;		// statistics
+    int numContended;		// acquires that had to spin
+
+  private:
+    char* name;			// for debugging
+    Thread *holder;		// thread holding the lock, NULL if FREE
 };
 
 // The following class defines a "condition variable".  A condition
@@ -116,6 +178,13 @@ class Lock {
 // The consequence of using Mesa-style semantics is that some other thread
 // can acquire the lock, and change data structures, before the woken
 // thread gets a chance to run.
+//
+// Since the signaller always holds the lock, a woken thread can't get
+// anywhere until the lock is released.  So rather than making it ready
+// -- only for it to run, block in Acquire, and be woken again by Release
+// -- Signal and Broadcast move it straight from the condition's queue
+// onto the lock's ("wait morphing"), and it runs once, when Release
+// wakes it.
 
 class Condition {
   public:
@@ -135,6 +204,6 @@ class Condition {
   private:
     void* firstLock;
     char* name;
-    List *queue;
+    ThreadQueue *queue;
 };
 #endif // SYNCH_H
@@ -19,6 +19,8 @@ Statistics *stats;			// performance metrics
 Timer *timer;				// the hardware timer device,
 					// for invoking context switches
 Alarm *alarms;
+ReplayLog *replayLog;			// log of nondeterministic inputs
+WorkQueue *workQueue;			// kernel worker threads
 
 #ifdef FILESYS_NEEDED
 FileSystem  *fileSystem;
@@ -26,10 +28,13 @@ FileSystem  *fileSystem;
 
 #ifdef FILESYS
 SynchDisk   *synchDisk;
+DiskTrace   *diskTrace;		// disk requests, if we are tracing them
 #endif
 
 #ifdef USER_PROGRAM	// requires either FILESYS or FILESYS_STUB
 Machine *machine;	// user program memory and registers
+PageTrace *pageTrace;	// pages touched, if we are tracing them
+AddrTrace *addrTrace;	// addresses used, if we are tracing them
 #endif
 
 #ifdef NETWORK
@@ -37,6 +42,11 @@ PostOffice *postOffice;
 #endif
 
 
+// Number of worker threads in the kernel work queue: just one, so that
+// the post office delivers the messages for a mailbox in the order
+// they arrived
+#define NumKernelWorkers	1
+
 // External definition, to allow us to take a pointer to this function
 extern void Cleanup();
 
@@ -55,6 +65,10 @@ extern void Cleanup();
 //	if the interrupted thread called Yield at the point it is 
 //	was interrupted.
 //
+//	When there is only one thread that can run, and no one is
+//	waiting for an alarm, the timer has nothing to do, so we stop it;
+//	the scheduler starts it again once another thread is ready.
+//
 //	"dummy" is because every interrupt handler takes one argument,
 //		whether it needs it or not.
 //----------------------------------------------------------------------
@@ -62,9 +76,15 @@ static void
 TimerInterruptHandler(int dummy)
 {
     //DEBUG('a',"TimerInterruptHandler is working\n");
-    if (interrupt->getStatus() != IdleMode)
-    interrupt->YieldOnReturn();
+    if (interrupt->getStatus() != IdleMode) {
+	interrupt->YieldOnReturn();
+	scheduler->CheckBudget();	// enforce real-time budgets
+    }
     alarms->Awaken();
+    if (alarms->CheckEmpty() && !scheduler->NeedsTimer()) {
+	DEBUG('i', "Stopping the timer; nothing to time-slice\n");
+	timer->Stop();
+    }
 }
 
 //----------------------------------------------------------------------
@@ -83,15 +103,23 @@ Initialize(int argc, char **argv)
     int argCount;
     char* debugArgs = "";
     bool randomYield = FALSE;
+    char *recordFile = NULL;		// log host inputs to this file
+    char *replayFile = NULL;		// replay host inputs from this file
+    int numCPUs = 1;			// simulated CPUs
     RandomInit(5);  // initialize pseudo-random
                     // number generator
 
 #ifdef USER_PROGRAM
     bool debugUserProg = FALSE;	// single step user program
+    char *traceFile = NULL;	// trace the pages it touches to this file
+    char *addrTraceFile = NULL;	// and the addresses it uses to this one
 #endif
 #ifdef FILESYS_NEEDED
     bool format = FALSE;	// format disk
 #endif
+#ifdef FILESYS
+    char *diskTraceFile = NULL;	// trace disk requests to this file
+#endif
 #ifdef NETWORK
     double rely = 1;		// network reliability
     int netname = 0;		// UNIX socket name
@@ -113,15 +141,43 @@ Initialize(int argc, char **argv)
 						// number generator
 	    randomYield = TRUE;
 	    argCount = 2;
+	} else if (!strcmp(*argv, "-rec")) {
+	    ASSERT(argc > 1);
+	    recordFile = *(argv + 1);
+	    argCount = 2;
+	} else if (!strcmp(*argv, "-rep")) {
+	    ASSERT(argc > 1);
+	    replayFile = *(argv + 1);
+	    argCount = 2;
+	} else if (!strcmp(*argv, "-cpus")) {
+	    ASSERT(argc > 1);
+	    numCPUs = atoi(*(argv + 1));
+	    argCount = 2;
 	}
 #ifdef USER_PROGRAM
 	if (!strcmp(*argv, "-s"))
 	    debugUserProg = TRUE;
+	else if (!strcmp(*argv, "-pt")) {
+	    ASSERT(argc > 1);
+	    traceFile = *(argv + 1);
+	    argCount = 2;
+	} else if (!strcmp(*argv, "-at")) {
+	    ASSERT(argc > 1);
+	    addrTraceFile = *(argv + 1);
+	    argCount = 2;
+	}
 #endif
 #ifdef FILESYS_NEEDED
 	if (!strcmp(*argv, "-f"))
 	    format = TRUE;
 #endif
+#ifdef FILESYS
+	if (!strcmp(*argv, "-dt")) {
+	    ASSERT(argc > 1);
+	    diskTraceFile = *(argv + 1);
+	    argCount = 2;
+	}
+#endif
 #ifdef NETWORK
 	if (!strcmp(*argv, "-l")) {
 	    ASSERT(argc > 1);
@@ -139,6 +195,13 @@ Initialize(int argc, char **argv)
     stats = new Statistics();			// collect statistics
     interrupt = new Interrupt;			// start up interrupt handling
     scheduler = new Scheduler();		// initialize the ready queue
+    ASSERT((recordFile == NULL) || (replayFile == NULL));
+    if (replayFile != NULL)			// open the log before the
+	replayLog = new ReplayLog(replayFile, TRUE);	// devices use it
+    else if (recordFile != NULL)
+	replayLog = new ReplayLog(recordFile, FALSE);
+    else
+	replayLog = NULL;
     //randomYield = TRUE;                         // enable TimerInteruptHandler
     //if (randomYield)				// start the timer (if needed)
 	timer = new Timer(TimerInterruptHandler, 0, randomYield);
@@ -152,16 +215,20 @@ Initialize(int argc, char **argv)
     // object to save its state. 
     currentThread = new Thread("main");		
     currentThread->setStatus(RUNNING);
+    scheduler->SetNumCPUs(numCPUs);
 
     interrupt->Enable();
     CallOnUserAbort(Cleanup);			// if user hits ctl-C
     
 #ifdef USER_PROGRAM
     machine = new Machine(debugUserProg);	// this must come first
+    pageTrace = (traceFile != NULL) ? new PageTrace(traceFile) : NULL;
+    addrTrace = (addrTraceFile != NULL) ? new AddrTrace(addrTraceFile) : NULL;
 #endif
 
 #ifdef FILESYS
-    synchDisk = new SynchDisk("DISK");
+    diskTrace = (diskTraceFile != NULL) ? new DiskTrace(diskTraceFile) : NULL;
+    synchDisk = new SynchDisk("DISK", diskTrace);
 #endif
 
 #ifdef FILESYS_NEEDED
@@ -169,7 +236,10 @@ Initialize(int argc, char **argv)
 #endif
 
 #ifdef NETWORK
+    workQueue = new WorkQueue("kernel", NumKernelWorkers);
     postOffice = new PostOffice(netname, rely, 10);
+#else
+    workQueue = NULL;
 #endif
 }
 
@@ -187,6 +257,14 @@ Cleanup()
     
 #ifdef USER_PROGRAM
     delete machine;
+    if (pageTrace != NULL) {
+	pageTrace->Print();
+	delete pageTrace;
+    }
+    if (addrTrace != NULL) {
+	addrTrace->Print();
+	delete addrTrace;
+    }
 #endif
 
 #ifdef FILESYS_NEEDED
@@ -195,6 +273,10 @@ Cleanup()
 
 #ifdef FILESYS
     delete synchDisk;
+    if (diskTrace != NULL) {
+	diskTrace->Print();
+	delete diskTrace;
+    }
 #endif
     
     delete timer;
@@ -203,6 +285,16 @@ Cleanup()
     
     delete alarms;
 
+    if (replayLog != NULL) {
+	replayLog->Print();
+	delete replayLog;
+    }
+
+    // we may be running on one of the workers, so just report on the
+    // work queue rather than waiting for the workers to exit
+    if (workQueue != NULL)
+	workQueue->Print();
+
     Exit(0);
 }
 
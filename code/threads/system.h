@@ -16,6 +16,8 @@
 #include "stats.h"
 #include "timer.h"
 #include "Alarm.h"
+#include "replay.h"
+#include "workqueue.h"
 
 // Initialization and cleanup routines
 extern void Initialize(int argc, char **argv); 	// Initialization,
@@ -30,11 +32,20 @@ extern Interrupt *interrupt;			// interrupt status
 extern Statistics *stats;			// performance metrics
 extern Timer *timer;				// the hardware alarm clock
 extern Alarm *alarms;
+extern ReplayLog *replayLog;			// record/replay of host inputs,
+						// NULL unless -rec or -rep
+extern WorkQueue *workQueue;			// deferred work from device
+						// handlers, NULL if no device
+						// needs it
 
 
 #ifdef USER_PROGRAM
 #include "machine.h"
+#include "pagetrace.h"
+#include "addrtrace.h"
 extern Machine* machine;	// user program memory and registers
+extern PageTrace *pageTrace;	// pages touched, if we are tracing them
+extern AddrTrace *addrTrace;	// addresses used, if we are tracing them
 #endif
 
 #ifdef FILESYS_NEEDED 		// FILESYS or FILESYS_STUB 
@@ -45,6 +56,7 @@ extern FileSystem  *fileSystem;
 #ifdef FILESYS
 #include "synchdisk.h"
 extern SynchDisk   *synchDisk;
+extern DiskTrace   *diskTrace;	// disk requests, if we are tracing them
 #endif
 
 #ifdef NETWORK
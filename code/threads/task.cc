@@ -0,0 +1,142 @@
+// task.cc
+//	Routines to run stackless tasks.
+//
+//	Runnable tasks are kept on a single run queue, and run in FIFO
+//	order by the task runner thread, which is forked the first time
+//	a task is started.  When the run queue is empty, the runner
+//	sleeps until a task is woken.
+//
+//	The run queue is only touched with interrupts disabled, so that
+//	Wake can be called from Semaphore::V and from the timer
+//	interrupt (for Alarm).
+//
+// Copyright (c) 1992-1993 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#include "copyright.h"
+#include "task.h"
+#include "system.h"
+
+static TaskQueue *runQueue = NULL;	// tasks ready to run
+static Thread *runner = NULL;		// the thread that runs them
+static bool runnerIdle = FALSE;		// TRUE if runner is asleep,
+					// waiting for a task to run
+
+static int numStarted = 0;		// statistics
+static int numFinished = 0;
+static int numWakeups = 0;
+static int maxLive = 0;
+
+//----------------------------------------------------------------------
+// TaskRunner
+// 	The body of the task runner thread.  Take the next task off the
+//	run queue and run it until it waits or is done; when there are
+//	no runnable tasks, sleep.
+//----------------------------------------------------------------------
+
+static void
+TaskRunner(int dummy)
+{
+    Task *task;
+    IntStatus oldLevel;
+
+    for (;;) {
+	oldLevel = interrupt->SetLevel(IntOff);
+	while (runQueue->IsEmpty()) {
+	    runnerIdle = TRUE;
+	    currentThread->Sleep();
+	}
+	task = runQueue->Remove();
+	(void) interrupt->SetLevel(oldLevel);
+
+	DEBUG('T', "Running task %s\n", task->getName());
+	if (task->Run() == TaskDone) {
+	    DEBUG('T', "Task %s is done\n", task->getName());
+	    numFinished++;
+	    delete task;
+	}
+    }
+}
+
+//----------------------------------------------------------------------
+// MakeRunnable
+// 	Put a task on the run queue, waking up the task runner if it is
+//	asleep.  Interrupts must be disabled.
+//----------------------------------------------------------------------
+
+static void
+MakeRunnable(Task *task)
+{
+    ASSERT(interrupt->getLevel() == IntOff);
+    runQueue->Append(task);
+    if (runnerIdle) {
+	runnerIdle = FALSE;
+	scheduler->ReadyToRun(runner);
+    }
+}
+
+//----------------------------------------------------------------------
+// Task::Task
+// 	Initialize a task, so that Start will run it from the beginning.
+//
+//	"debugName" is an arbitrary name, useful for debugging.
+//----------------------------------------------------------------------
+
+Task::Task(char *debugName)
+{
+    name = debugName;
+    state = 0;
+    taskNext = NULL;
+}
+
+//----------------------------------------------------------------------
+// Task::Start
+// 	Put a new task on the run queue, forking the task runner if
+//	this is the first task.
+//----------------------------------------------------------------------
+
+void
+Task::Start()
+{
+    if (runner == NULL) {
+	runQueue = new TaskQueue;
+	runner = new Thread("task runner");
+	runner->Fork(TaskRunner, 0);
+    }
+    numStarted++;
+    if (numStarted - numFinished > maxLive)
+	maxLive = numStarted - numFinished;
+
+    IntStatus oldLevel = interrupt->SetLevel(IntOff);
+    MakeRunnable(this);
+    (void) interrupt->SetLevel(oldLevel);
+}
+
+//----------------------------------------------------------------------
+// Task::Wake
+// 	Put a task that was waiting back on the run queue, waking up
+//	the task runner if it is asleep.  Called by whatever the task
+//	was waiting on, with interrupts disabled.
+//----------------------------------------------------------------------
+
+void
+Task::Wake()
+{
+    DEBUG('T', "Waking task %s\n", name);
+    numWakeups++;
+    MakeRunnable(this);
+}
+
+//----------------------------------------------------------------------
+// Task::Print
+// 	Print how many tasks have been run, and the most that were
+//	alive at once.
+//----------------------------------------------------------------------
+
+void
+Task::Print()
+{
+    printf("Tasks: started %d, finished %d, wakeups %d, most alive %d\n",
+	numStarted, numFinished, numWakeups, maxLive);
+}
@@ -0,0 +1,105 @@
+// task.h
+//	Data structures for stackless tasks -- lightweight units of
+//	concurrency that, unlike Threads, have no stack of their own.
+//
+//	A task is a resumable state machine: a subclass of Task whose
+//	Run() method picks up where it last left off (recorded in
+//	"state"), runs until it has to wait for something, and returns.
+//	All tasks are run, one at a time, by a single kernel thread,
+//	the task runner.  A waiting task costs only its own object --
+//	a few words -- rather than a whole thread stack, so a kernel can
+//	have a very large number of them waiting at once.
+//
+//	Tasks can wait on:
+//		Semaphore::P(task)
+//		Alarm::Pause(howLong, task), Alarm::PauseUntil(when, task)
+//		SynchDisk::Wait(request, task)
+//	Each of these returns TRUE if the task can go on right away;
+//	otherwise it queues the task, which will be woken when the
+//	semaphore is V'ed, the alarm goes off, or the disk request is
+//	done.
+//
+//	Tasks must not use Locks or wait on Conditions.  A Lock belongs
+//	to a thread, and every task runs on the same one, the runner; a
+//	task that blocked in Acquire would stall every other task, and
+//	could deadlock with one that holds the lock.  A task that needs
+//	to wait for some state to change should wait on a Semaphore
+//	instead, V'ed by whoever changes it.
+//
+//	Run() is written with the TASK_ macros below, in the style of
+//	"protothreads":
+//
+//	TaskStatus
+//	MyTask::Run()
+//	{
+//	    TASK_BEGIN();
+//	    ...
+//	    TASK_AWAIT(sem->P(this));	// returns to the runner if we
+//	    ...				// have to wait, and resumes here
+//	    TASK_END();
+//	}
+//
+//	Since the runner's stack is reused by every task, local variables
+//	in Run() do not survive a TASK_AWAIT; keep anything that must
+//	survive in the task object.  And since all tasks share one
+//	thread, a task should never block the thread itself (by calling
+//	Semaphore::P() without a task, for instance) for long.
+//
+// Copyright (c) 1992-1993 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#ifndef TASK_H
+#define TASK_H
+
+#include "copyright.h"
+#include "utility.h"
+#include "list.h"
+
+// What Run() tells the task runner when it returns
+enum TaskStatus { TaskWaiting, TaskDone };
+
+// The following class defines a task.  Subclasses supply Run().
+
+class Task {
+  public:
+    Task(char *debugName);		// initialize a task; it doesn't
+					// run until Start is called
+    virtual ~Task() {}			// called by the task runner
+					// once Run returns TaskDone
+
+    void Start();			// make the task runnable
+    void Wake();			// make a waiting task runnable again;
+					// called with interrupts disabled
+    virtual TaskStatus Run() = 0;	// run until the task has to wait,
+					// or is done
+
+    char *getName() { return name; }
+
+    Task *taskNext;			// next task on the run queue or
+					// wait queue this task is on
+
+    static void Print();		// print task statistics
+
+  protected:
+    int state;				// where Run() is to resume; 0 to
+					// start at the beginning
+
+  private:
+    char *name;				// useful for debugging
+};
+
+// A queue of tasks -- the run queue, or the tasks waiting on a
+// synchronization object.  Like ThreadQueue, it allocates nothing.
+typedef IntrusiveList<Task, &Task::taskNext> TaskQueue;
+
+// Macros to write Run() as a state machine.  TASK_AWAIT(x) evaluates x;
+// if it is FALSE the task returns to the runner, and when it is woken,
+// carries on after the TASK_AWAIT.  Only one TASK_AWAIT per line.
+#define TASK_BEGIN()	switch (state) { case 0:
+#define TASK_AWAIT(x)	do { state = __LINE__;				\
+			     if (!(x)) return TaskWaiting;		\
+			     case __LINE__: ; } while (0)
+#define TASK_END()	} state = -1; return TaskDone
+
+#endif // TASK_H
@@ -38,6 +38,13 @@ Thread::Thread(char* threadName)
     stackTop = NULL;
     stack = NULL;
     status = JUST_CREATED;
+    priority = effectivePriority = DefaultPriority;
+    queueNext = NULL;
+    locksHeld = NULL;
+    waitingFor = NULL;
+    realTime = NULL;
+    cpu = NULL;
+    readyAt = 0;
 #ifdef USER_PROGRAM
     space = NULL;
 #endif
@@ -147,6 +154,8 @@ Thread::Finish ()
     ASSERT(this == currentThread);
     
     DEBUG('t', "Finishing thread \"%s\"\n", getName());
+    if (realTime != NULL)
+	scheduler->LeaveRealTime(this);
     
     threadToBeDestroyed = currentThread;
     Sleep();					// invokes SWITCH
@@ -155,13 +164,16 @@ Thread::Finish ()
 
 //----------------------------------------------------------------------
 // Thread::Yield
-// 	Relinquish the CPU if any other thread is ready to run.
+// 	Relinquish the CPU if any other thread that is at least as urgent
+//	as we are -- of at least our priority, or a real-time thread with
+//	a deadline no later than ours -- is ready to run.
 //	If so, put the thread on the end of the ready list, so that
 //	it will eventually be re-scheduled.
 //
-//	NOTE: returns immediately if no other thread on the ready queue.
-//	Otherwise returns when the thread eventually works its way
-//	to the front of the ready list and gets re-scheduled.
+//	NOTE: returns immediately if no other thread on the ready queue
+//	(on a simulated multiprocessor, once the other CPUs have had a
+//	turn).  Otherwise returns when the thread eventually works its
+//	way to the front of the ready list and gets re-scheduled.
 //
 //	NOTE: we disable interrupts, so that looking at the thread
 //	on the front of the ready list, and switching to it, can be done
@@ -181,14 +193,103 @@ Thread::Yield ()
     
     DEBUG('t', "Yielding thread \"%s\"\n", getName());
     
-    nextThread = scheduler->FindNextToRun();
+    nextThread = scheduler->FindNextToRun(this);
     if (nextThread != NULL) {
 	scheduler->ReadyToRun(this);
 	scheduler->Run(nextThread);
+    } else if (scheduler->NumCPUs() > 1)
+	scheduler->Run(this);		// give the other CPUs their turn
+    (void) interrupt->SetLevel(oldLevel);
+}
+
+//----------------------------------------------------------------------
+// Thread::YieldTo
+// 	Relinquish the CPU directly to "target", ahead of any other ready
+//	threads, and put ourselves on the end of the ready list.  Used
+//	to hand off to the thread we have just woken up (for instance,
+//	by releasing a lock it was waiting for), so that it runs while
+//	what it needs is still fresh, without a trip through the ready list.
+//
+//	NOTE: returns immediately, like Yield, if target isn't on the ready
+//	list -- or if it is less urgent than us, since then it wouldn't
+//	be its turn.
+//
+//	"target" -- the thread to run next
+//----------------------------------------------------------------------
+
+void
+Thread::YieldTo (Thread *target)
+{
+    IntStatus oldLevel = interrupt->SetLevel(IntOff);
+
+    ASSERT(this == currentThread);
+
+    if (!scheduler->Outranks(this, target)
+		&& scheduler->RemoveReady(target)) {
+	DEBUG('t', "Yielding thread \"%s\" to \"%s\"\n", getName(),
+	      target->getName());
+	scheduler->ReadyToRun(this);
+	scheduler->Run(target);
     }
     (void) interrupt->SetLevel(oldLevel);
 }
 
+//----------------------------------------------------------------------
+// Thread::WaitForNextPeriod
+// 	Called by a real-time thread when it has finished its work for
+//	this period (its "job").  Sleep until the start of the next
+//	period, when the thread gets a fresh budget and deadline.
+//
+//	If the job finished after its deadline, the next release is
+//	already past -- possibly several of them; any release that has
+//	been missed entirely is skipped, and we carry on with the period
+//	we are in now, right away.
+//
+//	Threads are woken by the Alarm, so releases are only as precise
+//	as the timer: periods should be multiples of TimerTicks.
+//----------------------------------------------------------------------
+
+void
+Thread::WaitForNextPeriod ()
+{
+    int release;
+
+    ASSERT(this == currentThread);
+    ASSERT(realTime != NULL);
+    IntStatus oldLevel = interrupt->SetLevel(IntOff);
+    release = scheduler->EndJob(this);
+    (void) interrupt->SetLevel(oldLevel);
+
+    if (release > stats->totalTicks)
+	alarms->PauseUntil(release);
+}
+
+//----------------------------------------------------------------------
+// Thread::setPriority
+// 	Change the thread's base priority.  Its effective priority
+//	follows, unless a higher priority is being donated to it; and
+//	if it is waiting for a lock, the change is passed on to the
+//	thread holding the lock.
+//
+//	Lowering the running thread's priority doesn't take the CPU
+//	away from it until it next yields.
+//
+//	"newPriority" -- between MinPriority and MaxPriority
+//----------------------------------------------------------------------
+
+void
+Thread::setPriority(int newPriority)
+{
+    ASSERT((newPriority >= MinPriority) && (newPriority <= MaxPriority));
+    IntStatus oldLevel = interrupt->SetLevel(IntOff);
+
+    DEBUG('t', "Setting priority of thread \"%s\" to %d\n", name,
+	  newPriority);
+    priority = newPriority;
+    Lock::UpdatePriority(this);
+    (void) interrupt->SetLevel(oldLevel);
+}
+
 //----------------------------------------------------------------------
 // Thread::Sleep
 // 	Relinquish the CPU, because the current thread is blocked
@@ -196,7 +297,8 @@ Thread::Yield ()
 //	Eventually, some thread will wake this thread up, and put it
 //	back on the ready queue, so that it can be re-scheduled.
 //
-//	NOTE: if there are no threads on the ready queue, that means
+//	NOTE: if there are no threads on the ready queue (and no other
+//	CPU has anything to do either), that means
 //	we have no thread to run.  "Interrupt::Idle" is called
 //	to signify that we should idle the CPU until the next I/O interrupt
 //	occurs (the only thing that could cause a thread to become
@@ -218,11 +320,16 @@ Thread::Sleep ()
     
     DEBUG('t', "Sleeping thread \"%s\"\n", getName());
 
+    ASSERT(scheduler->CurrentCPU()->spinDepth == 0);	// can't sleep
+							// holding a SpinLock
     status = BLOCKED;
-    while ((nextThread = scheduler->FindNextToRun()) == NULL)
+    while ((nextThread = scheduler->FindNextToRun()) == NULL
+		&& !scheduler->OtherCPUsBusy())
 	interrupt->Idle();	// no one to run, wait for an interrupt
         
-    scheduler->Run(nextThread); // returns when we've been signalled
+    scheduler->Run(nextThread); // returns when we've been signalled;
+				// NULL leaves this CPU idle, while
+				// the other CPUs carry on
 }
 
 //----------------------------------------------------------------------
@@ -235,7 +342,7 @@ Thread::Sleep ()
 
 static void ThreadFinish()    { currentThread->Finish(); }
 static void InterruptEnable() { interrupt->Enable(); }
-void ThreadPrint(int arg){ Thread *t = (Thread *)arg; t->Print(); }
+void ThreadPrint(Thread *t) { t->Print(); }
 
 //----------------------------------------------------------------------
 // Thread::StackAllocate
@@ -39,6 +39,7 @@
 
 #include "copyright.h"
 #include "utility.h"
+#include "list.h"
 
 #ifdef USER_PROGRAM
 #include "machine.h"
@@ -59,8 +60,40 @@
 // Thread state
 enum ThreadStatus { JUST_CREATED, RUNNING, READY, BLOCKED };
 
+// Thread priorities.  The scheduler always runs a ready thread of the
+// highest priority; threads of equal priority are run FIFO.  Every
+// thread starts at DefaultPriority, so unless some thread's priority
+// is changed, scheduling is plain FIFO.
+#define MinPriority	0
+#define MaxPriority	7
+#define NumPriorities	(MaxPriority - MinPriority + 1)
+#define DefaultPriority	MinPriority
+
+// The timing of a thread in the real-time scheduling class (see
+// Scheduler::AdmitRealTime).  All times are in ticks.
+
+class RealTime {
+  public:
+    RealTime(int p, int b, int now)
+	{ period = p; budget = b; release = now; deadline = now + p;
+	  used = 0; throttled = FALSE; }
+
+    int period;			// how often the thread is released
+    int budget;			// CPU time it may use each period
+    int release;		// start of the current period
+    int deadline;		// end of the current period, by which the
+				// current job should be done
+    int used;			// CPU time used so far this period
+    bool throttled;		// TRUE once "used" reaches "budget"; the
+				// thread then runs in the normal class
+				// until its next period
+};
+
 // external function, dummy routine whose sole job is to call Thread::Print
-extern void ThreadPrint(int arg);	 
+class Thread;
+class Lock;
+class CPU;
+extern void ThreadPrint(Thread *t);	 
 
 // The following class defines a "thread control block" -- which
 // represents a single thread of execution.
@@ -69,6 +102,9 @@ extern void ThreadPrint(int arg);
 //     an execution stack for activation records ("stackTop" and "stack")
 //     space to save CPU registers while not running ("machineState")
 //     a "status" (running/ready/blocked)
+//     a base "priority", and an effective priority, which is raised
+//	above the base while a higher priority thread is waiting for
+//	a lock this thread holds (see Lock::Acquire)
 //    
 //  Some threads also belong to a user address space; threads
 //  that only run in the kernel have a NULL address space.
@@ -92,6 +128,11 @@ class Thread {
     void Fork(VoidFunctionPtr func, int arg); 	// Make thread run (*func)(arg)
     void Yield();  				// Relinquish the CPU if any 
 						// other thread is runnable
+    void YieldTo(Thread *target);		// Relinquish the CPU to
+						// target, if it is runnable
+    void WaitForNextPeriod();			// A real-time thread's job
+						// is done; sleep until it
+						// is released again
     void Sleep();  				// Put the thread to sleep and 
 						// relinquish the processor
     void Finish();  				// The thread is done executing
@@ -99,9 +140,35 @@ class Thread {
     void CheckOverflow();   			// Check if thread has 
 						// overflowed its stack
     void setStatus(ThreadStatus st) { status = st; }
+    ThreadStatus getStatus() { return status; }
     char* getName() { return (name); }
     void Print() { printf("%s, ", name); }
 
+    void setPriority(int newPriority);		// change the base priority
+    int getBasePriority() { return priority; }
+    int getPriority() { return effectivePriority; }
+						// priority to schedule by,
+						// including any donated
+    void setEffectivePriority(int p) { effectivePriority = p; }
+						// only for the scheduler;
+						// see Scheduler::ChangePriority
+
+    Thread *queueNext;			// next thread on the ready list or
+					// wait queue this thread is on (a
+					// thread is only ever on one); see
+					// ThreadQueue below
+    Lock *locksHeld;			// locks this thread holds, chained
+					// through Lock::nextHeld
+    Lock *waitingFor;			// lock this thread is waiting to
+					// acquire, or NULL
+    RealTime *realTime;			// timing, if the thread is in the
+					// real-time class; otherwise NULL
+    CPU *cpu;				// CPU the thread is running or ready
+					// on, or last ran on; NULL if it
+					// hasn't run yet
+    int readyAt;			// that CPU's clock when the thread
+					// last became ready
+
   private:
     // some of the private data for this class is listed above
     
@@ -110,6 +177,9 @@ class Thread {
 					// (If NULL, don't deallocate stack)
     ThreadStatus status;		// ready, running or blocked
     char* name;
+    int priority;			// base priority
+    int effectivePriority;		// base priority, or the highest
+					// priority donated to us, if higher
 
     void StackAllocate(VoidFunctionPtr func, int arg);
     					// Allocate a stack for thread.
@@ -130,6 +200,11 @@ class Thread {
 #endif
 };
 
+// A queue of threads -- the ready list, or the threads waiting on a
+// synchronization object.  Threads are chained through their own
+// queueNext field, so queueing a thread never allocates anything.
+typedef IntrusiveList<Thread, &Thread::queueNext> ThreadQueue;
+
 // Magical machine-dependent routines, defined in switch.s
 
 extern "C" {
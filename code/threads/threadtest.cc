@@ -216,7 +216,7 @@ void Consumer(int n)
     //int a[3]={2,0,0};
     void *data=new char[10];
     for(int i=0;i<n;++i){
-        int t=rand()%10;
+        int t=Random()%10;
         //int t=a[i];
         bf->Read(data,t);
         printf("%s:%d\n",currentThread->getName(),t);
@@ -228,7 +228,7 @@ void Producer(int n)
     //int a[3]={3,3,5};
     void *data=new char[10];
     for(int i=0;i<n;++i){
-        int t=rand()%10;
+        int t=Random()%10;
         //int t=a[i];
         bf->Write(data,t);
         printf("%s:%d\n",currentThread->getName(),t);
@@ -347,9 +347,9 @@ void RiderThreadFunc(int id)                //Rider Threads
     }
     else
     {
-        srcFloor = (rand()%floors)+1;
+        srcFloor = (Random()%floors)+1;
         do{
-            dstFloor = (rand()%floors)+1;
+            dstFloor = (Random()%floors)+1;
         }while(dstFloor==srcFloor);
     }
 
@@ -406,6 +406,672 @@ void ElevatorTest10()
 //--------------------------- ThreadTest 10 Elevator ---------------------------
 
 
+//--------------------------- ThreadTest 11 WorkQueue ---------------------------
+// N units of work with priorities 0..2 run on a pool of threadnum workers,
+// instead of forking a thread per unit.  The first item to run submits an
+// urgent one (priority 3), which runs ahead of the rest of that batch.
+
+WorkQueue *wq11;
+
+void UrgentItemFunc11(int n)
+{
+    printf("%s runs urgent work item (priority 3)\n",currentThread->getName());
+}
+
+void WorkItemFunc11(int n)
+{
+    static bool submitted = FALSE;
+
+    printf("%s runs work item %d (priority %d)\n",currentThread->getName(),n,n%3);
+    if (!submitted) {
+        submitted = TRUE;
+        wq11->Submit(UrgentItemFunc11, 0, 3);
+    }
+    currentThread->Yield();
+}
+
+void WorkQueueTest11()
+{
+    DEBUG('t', "Entering WorkQueueTest11\n");
+    WorkQueue *wq = wq11 = new WorkQueue("test", threadnum);
+
+    for (int i = 0; i < N; ++i)
+        wq->Submit(WorkItemFunc11, i, i%3);
+    wq->Wait();
+    printf("All %d work items done.\n", N);
+    wq->Print();
+    delete wq;
+}
+
+
+//--------------------------- ThreadTest 12 Stackless tasks ---------------------------
+// N tasks all wait on one semaphore (every 1000th first sleeps on the alarm),
+// and are then released together.  A waiting task costs only its object,
+// where a waiting thread would pin a whole stack.
+
+Semaphore *taskGate;
+Semaphore *tasksDone;
+int tasksWaiting = 0;
+int tasksLeft = 0;
+
+class GateTask : public Task {
+  public:
+    GateTask(int n) : Task("gate task") { id = n; }
+    TaskStatus Run();
+  private:
+    int id;
+};
+
+TaskStatus GateTask::Run()
+{
+    TASK_BEGIN();
+    if (id % 1000 == 0)
+        TASK_AWAIT(alarms->Pause(1 + id % 7, this));
+    tasksWaiting++;
+    TASK_AWAIT(taskGate->P(this));
+    if (--tasksLeft == 0)
+        tasksDone->V();
+    TASK_END();
+}
+
+void TaskTest12()
+{
+    DEBUG('t', "Entering TaskTest12\n");
+    taskGate = new Semaphore("task gate", 0);
+    tasksDone = new Semaphore("tasks done", 0);
+    tasksLeft = N;
+
+    for (int i = 0; i < N; ++i)
+        (new GateTask(i))->Start();
+    while (tasksWaiting < N)            // let the task runner get them
+        currentThread->Yield();         // all waiting on the gate
+    printf("%d tasks waiting, %d bytes each (a waiting thread needs %d)\n",
+        N, (int) sizeof(GateTask), (int) (sizeof(Thread) + StackSize * sizeof(int)));
+
+    for (int i = 0; i < N; ++i)
+        taskGate->V();
+    tasksDone->P();
+    printf("All %d tasks done.\n", N);
+    Task::Print();
+}
+
+
+//--------------------------- ThreadTest 13 Priority inheritance ---------------------------
+// low (priority 1) holds lock1; mid (3) takes lock2 and waits for lock1;
+// threadnum hogs (5) spin until high is done; high (7) waits for lock2.
+// high's donation reaches low through mid, so low finishes its critical
+// section ahead of the hogs, and high waits only for low and mid -- not
+// for the hogs, which without inheritance would starve low forever.
+// Checks the priorities low and mid are boosted to, and back from, and
+// the order the locks are acquired in.
+
+Lock *piLock1;
+Lock *piLock2;
+bool piHighDone = FALSE;
+int piHogSpins = 0;
+char piOrder[64] = "";                  // who got which lock, in order
+
+void PIAcquired(char *what)
+{
+    strcat(piOrder, what);
+}
+
+void PILowFunc(int n)
+{
+    piLock1->Acquire();
+    PIAcquired("low:1 ");
+    for (int i = 0; i < 100; ++i)       // critical section
+        currentThread->Yield();
+    printf("low (base priority %d) releases lock1 at priority %d\n",
+        currentThread->getBasePriority(), currentThread->getPriority());
+    ASSERT(currentThread->getPriority() == 7);  // high's, through mid
+    piLock1->Release();
+    ASSERT(currentThread->getPriority() == 1);
+}
+
+void PIMidFunc(int n)
+{
+    alarms->Pause(1);
+    piLock2->Acquire();
+    PIAcquired("mid:2 ");
+    piLock1->Acquire();
+    PIAcquired("mid:1 ");
+    printf("mid (base priority %d) got lock1 at priority %d\n",
+        currentThread->getBasePriority(), currentThread->getPriority());
+    ASSERT(currentThread->getPriority() == 7);
+    piLock1->Release();
+    piLock2->Release();
+    ASSERT(currentThread->getPriority() == 3);
+}
+
+void PIHogFunc(int n)
+{
+    alarms->Pause(3);
+    while (!piHighDone) {
+        piHogSpins++;
+        currentThread->Yield();
+    }
+}
+
+void PIHighFunc(int n)
+{
+    alarms->Pause(5);
+    int start = stats->totalTicks;
+    int spins = piHogSpins;
+    piLock2->Acquire();
+    PIAcquired("high:2");
+    printf("high waited %d ticks for lock2; hogs ran %d times meanwhile\n",
+        stats->totalTicks - start, piHogSpins - spins);
+    piLock2->Release();
+    piHighDone = TRUE;
+    printf("locks acquired in order: %s\n", piOrder);
+    ASSERT(piHogSpins == spins);
+    ASSERT(!strcmp(piOrder, "low:1 mid:2 mid:1 high:2"));
+}
+
+void PriorityTest13()
+{
+    DEBUG('t', "Entering PriorityTest13\n");
+    piLock1 = new Lock("lock1");
+    piLock2 = new Lock("lock2");
+    int mainPriority = currentThread->getBasePriority();
+    currentThread->setPriority(MaxPriority);    // or a time slice could
+                                                // leave "high" unforked
+
+    Thread *t = new Thread("low");
+    t->setPriority(1);
+    t->Fork(PILowFunc, 0);
+    t = new Thread("mid");
+    t->setPriority(3);
+    t->Fork(PIMidFunc, 0);
+    for (int i = 0; i < threadnum; ++i) {
+        sprintf(threadname[i], "hog %d", i);
+        t = new Thread(threadname[i]);
+        t->setPriority(5);
+        t->Fork(PIHogFunc, i);
+    }
+    t = new Thread("high");
+    t->setPriority(7);
+    t->Fork(PIHighFunc, 0);
+    currentThread->setPriority(mainPriority);
+}
+
+
+//--------------------------- ThreadTest 14 Handoff ---------------------------
+// A producer and a consumer pass N bytes one at a time through a 4 byte
+// BoundedBuffer; then two threads take N turns each under a lock and a
+// condition, handing the CPU straight to each other with YieldTo.
+// Prints the context switches each takes per operation.
+
+BoundedBuffer *handoffBuffer;
+Semaphore *handoffDone;
+Lock *turnLock;
+Condition *turnCond;
+int turn = 0;
+Thread *turnThread[2];
+
+void HandoffProducer(int n)
+{
+    char c = 0;
+    for (int i = 0; i < n; ++i)
+        handoffBuffer->Write(&c, 1);
+    handoffDone->V();
+}
+
+void HandoffConsumer(int n)
+{
+    char c;
+    for (int i = 0; i < n; ++i)
+        handoffBuffer->Read(&c, 1);
+    handoffDone->V();
+}
+
+void TurnThreadFunc(int me)
+{
+    for (int i = 0; i < N; ++i) {
+        turnLock->Acquire();
+        while (turn != me)
+            turnCond->Wait(turnLock);
+        turn = 1 - me;
+        turnCond->Signal(turnLock);
+        turnLock->Release();
+        if (i < N - 1)                  // the other may be gone after
+            currentThread->YieldTo(turnThread[1 - me]); // its last turn
+    }
+    handoffDone->V();
+}
+
+void HandoffTest14()
+{
+    DEBUG('t', "Entering HandoffTest14\n");
+    handoffBuffer = new BoundedBuffer(4);
+    handoffDone = new Semaphore("handoff done", 0);
+    turnLock = new Lock("turn lock");
+    turnCond = new Condition("turn cond");
+
+    int start = stats->numContextSwitches;
+    (new Thread("producer"))->Fork(HandoffProducer, N);
+    (new Thread("consumer"))->Fork(HandoffConsumer, N);
+    handoffDone->P();
+    handoffDone->P();
+    int switches = stats->numContextSwitches - start;
+    printf("bounded buffer: %d context switches for %d bytes, %d.%02d per byte\n",
+        switches, N, switches / N, (switches * 100 / N) % 100);
+
+    start = stats->numContextSwitches;
+    turnThread[0] = new Thread("turn 0");
+    turnThread[1] = new Thread("turn 1");
+    turnThread[0]->Fork(TurnThreadFunc, 0);
+    turnThread[1]->Fork(TurnThreadFunc, 1);
+    handoffDone->P();
+    handoffDone->P();
+    switches = stats->numContextSwitches - start;
+    printf("turn taking: %d context switches for %d turns, %d.%02d per turn\n",
+        switches, 2 * N, switches / (2 * N), (switches * 100 / (2 * N)) % 100);
+}
+
+
+//--------------------------- ThreadTest 15 Real-time ---------------------------
+// Two periodic threads ("car" every 1000 ticks, "disk" every 1500) each
+// reserve 30% of the CPU and run N jobs, against threadnum hogs at the
+// highest normal priority.  A third asking for 40% is turned away.
+// A fourth ("overrun") reserves 10% but needs about 25%: it runs out of
+// budget in every job, and the hogs would starve it, but it gets a new
+// budget each period, so it never falls more than two periods behind.
+// Each job's finishing time is printed against its deadline; the miss
+// count is printed at Halt.
+
+int rtLeft = 0;
+
+void OverrunFunc(int period)
+{
+    for (int i = 0; i < N; ++i) {
+        int deadline = currentThread->realTime->deadline;
+        for (int j = 0; j < period / 40; ++j)
+            currentThread->Yield();
+        printf("%s job %d done at %d, deadline %d\n", currentThread->getName(),
+            i, stats->totalTicks, deadline);
+        ASSERT(stats->totalTicks <= deadline + 2 * period);
+        currentThread->WaitForNextPeriod();
+    }
+    rtLeft--;
+}
+
+void RealTimeFunc(int period)
+{
+    for (int i = 0; i < N; ++i) {
+        for (int j = 0; j < period / 40; ++j)   // about a quarter of the
+            currentThread->Yield();             // period's worth of work
+        printf("%s job %d done at %d, deadline %d\n", currentThread->getName(),
+            i, stats->totalTicks, currentThread->realTime->deadline);
+        currentThread->WaitForNextPeriod();
+    }
+    rtLeft--;
+}
+
+void RealTimeHogFunc(int n)
+{
+    while (rtLeft > 0)
+        currentThread->Yield();
+}
+
+void RealTimeTest15()
+{
+    DEBUG('t', "Entering RealTimeTest15\n");
+    Thread *t;
+
+    rtLeft = 3;
+    t = new Thread("car");
+    (void) scheduler->AdmitRealTime(t, 1000, 300);
+    t->Fork(RealTimeFunc, 1000);
+    t = new Thread("disk");
+    (void) scheduler->AdmitRealTime(t, 1500, 450);
+    t->Fork(RealTimeFunc, 1500);
+    t = new Thread("greedy");
+    if (!scheduler->AdmitRealTime(t, 500, 200))
+        printf("greedy (period 500, budget 200) was not admitted\n");
+    delete t;
+    t = new Thread("overrun");
+    (void) scheduler->AdmitRealTime(t, 1000, 100);
+    t->Fork(OverrunFunc, 1000);
+
+    for (int i = 0; i < threadnum; ++i) {
+        sprintf(threadname[i], "hog %d", i);
+        t = new Thread(threadname[i]);
+        t->setPriority(MaxPriority);
+        t->Fork(RealTimeHogFunc, i);
+    }
+}
+
+
+//--------------------------- ThreadTest 16 Multiprocessor ---------------------------
+// threadnum workers each do N units of work -- 200 ticks on their own,
+// then 20 ticks holding a SpinLock -- on 1, 2, 4 and 8 simulated CPUs.
+// Prints the elapsed time and throughput for each, and how many
+// acquires of the lock found it held.
+
+SpinLock *smpLock;
+Semaphore *smpDone;
+int smpCounter = 0;
+
+void SMPBusy(int ticks)         // run for about "ticks" ticks
+{
+    for (int i = 0; i < ticks / SystemTick; ++i) {
+        (void) interrupt->SetLevel(IntOff);
+        (void) interrupt->SetLevel(IntOn);
+    }
+}
+
+void SMPWorker(int n)
+{
+    for (int i = 0; i < n; ++i) {
+        SMPBusy(200);
+        smpLock->Acquire();
+        smpCounter++;
+        SMPBusy(20);
+        smpLock->Release();
+    }
+    smpDone->V();
+}
+
+void SMPTest16()
+{
+    DEBUG('t', "Entering SMPTest16\n");
+    int bootCPUs = scheduler->NumCPUs();
+    int base = 0;
+    int runs = 0;
+
+    smpLock = new SpinLock("smp lock");
+    smpDone = new Semaphore("smp done", 0);
+    printf("cpus  elapsed  units/1000 ticks  speedup  contended\n");
+    for (int cpus = 1; cpus <= MaxCPUs; cpus *= 2, runs++) {
+        scheduler->SetNumCPUs(cpus);
+        int start = stats->totalTicks;
+        for (int i = 0; i < threadnum; ++i)
+            (new Thread("smp worker"))->Fork(SMPWorker, N);
+        for (int i = 0; i < threadnum; ++i)
+            smpDone->P();
+        int elapsed = stats->totalTicks - start;
+        while (scheduler->OtherCPUsBusy())     // let the last workers
+            currentThread->Yield();             // finish exiting
+        if (cpus == 1)
+            base = elapsed;
+        printf("%4d  %7d  %16d  %4d.%02d  %d of %d\n", cpus, elapsed,
+            threadnum * N * 1000 / elapsed, base / elapsed,
+            (base * 100 / elapsed) % 100, smpLock->numContended,
+            smpLock->numAcquires);
+        smpLock->numContended = smpLock->numAcquires = 0;
+    }
+    ASSERT(smpCounter == threadnum * N * runs);
+    scheduler->SetNumCPUs(bootCPUs);
+}
+
+
+//--------------------------- ThreadTest 17 Barrier scaling ---------------------------
+// n threads wait on an EventBarrier, then on a TreeEventBarrier, for
+// n = 10, 100, 1000 and 10000.  Prints the ticks from Signal until the
+// last waiter gets out of Wait, and until Signal returns.  Try -cpus 8,
+// where the tree's wakeups can go on in parallel.  The tree is then
+// signaled again, with its waiters going straight back to Wait after
+// Complete -- which an EventBarrier can't cope with, since they can
+// get there before Signal has returned.
+
+EventBarrier *flatBarrier;
+TreeEventBarrier *treeBarrier;
+int barrierReleased;                    // when the last waiter got out
+int barrierDone;                        // waiters that have finished
+
+void BarrierWaiter(int tree)
+{
+    for (int i = 0; i < (tree ? 2 : 1); ++i) {
+        if (tree)
+            treeBarrier->Wait();
+        else
+            flatBarrier->Wait();
+        if (scheduler->Now() > barrierReleased)
+            barrierReleased = scheduler->Now();
+        if (tree)
+            treeBarrier->Complete();
+        else
+            flatBarrier->Complete();
+    }
+    barrierDone++;
+}
+
+void BarrierRun(int n, int tree, int *release, int *signal)
+{
+    barrierDone = 0;
+    for (int i = 0; i < n; ++i)
+        (new Thread("barrier waiter"))->Fork(BarrierWaiter, tree);
+    for (int i = 0; i < (tree ? 2 : 1); ++i) {
+        while ((tree ? treeBarrier->Waiters() : flatBarrier->Waiters()) < n
+                || scheduler->CurrentCPU()->numReady > 0
+                || scheduler->OtherCPUsBusy())
+            currentThread->Yield();     // until they are all asleep
+
+        int start = scheduler->Now();
+        barrierReleased = 0;
+        if (tree)
+            treeBarrier->Signal();
+        else
+            flatBarrier->Signal();
+        if (i == 0) {
+            *signal = scheduler->Now() - start;
+            *release = barrierReleased - start;
+        }
+    }
+    while (barrierDone < n || scheduler->OtherCPUsBusy())
+        currentThread->Yield();         // let them all finish
+}
+
+void BarrierTest17()
+{
+    DEBUG('t', "Entering BarrierTest17\n");
+    int flatRelease, flatSignal, treeRelease, treeSignal;
+
+    printf("waiters  release: flat    tree   Signal: flat    tree\n");
+    for (int n = 10; n <= 10000; n *= 10) {
+        flatBarrier = new EventBarrier();
+        treeBarrier = new TreeEventBarrier(n);
+        BarrierRun(n, 0, &flatRelease, &flatSignal);
+        BarrierRun(n, 1, &treeRelease, &treeSignal);
+        printf("%7d  %13d %7d  %12d %7d\n", n, flatRelease, treeRelease,
+            flatSignal, treeSignal);
+        delete flatBarrier;
+        delete treeBarrier;
+    }
+}
+
+//--------------------------- ThreadTest 18 Synthetic workload ---------------------------
+// threadnum workers run for a while, each over and over taking one of a
+// set of locks, computing while holding it, releasing it, computing on
+// its own ("thinking"), and then maybe yielding, sleeping or doing I/O.
+// All of that is set by -W, a comma-separated list of parameters:
+//
+//      time=<ticks>            how long the workers run (100000)
+//      locks=<n>               how many locks they share (1)
+//      lock=sleep|spin         Locks or SpinLocks (sleep)
+//      hot=<percent>           acquires that go to lock 0, the rest
+//                              spread over all of them (0)
+//      cs=<ticks>              mean ticks holding a lock (20)
+//      think=<ticks>           mean ticks between critical sections (100)
+//      csdist=, thinkdist=     const, uniform (0 to twice the mean) or
+//                              exp (exponential) (const)
+//      yield=, sleep=, io=     percent of rounds that end that way (0)
+//      sleeptime=<ticks>       mean ticks to sleep (500)
+//      iotime=<ticks>          mean ticks for an I/O, which goes to a
+//                              single device, one at a time (1000)
+//
+// for instance "-T 8 -q 18 -W locks=4,hot=80,cs=50,csdist=exp,io=10".
+// Prints the throughput, in critical sections per 1000 ticks; Jain's
+// fairness index over the critical sections each worker got through (1
+// when they all did as many, down to 1/threadnum when one did them all);
+// and percentiles of the time spent waiting to get a lock.
+
+#define MaxWaitSamples  100000          // waits kept for the percentiles
+
+enum WorkloadDist { DistConst, DistUniform, DistExp };
+
+int wlTime = 100000, wlLocks = 1, wlSpin = 0, wlHot = 0;
+int wlCS = 20, wlThink = 100, wlCSDist = DistConst, wlThinkDist = DistConst;
+int wlYield = 0, wlSleep = 0, wlIO = 0, wlSleepTime = 500, wlIOTime = 1000;
+char *workload = NULL;                  // -W, set in main.cc
+
+Lock **wlLock;
+SpinLock **wlSpinLock;
+Lock *wlDevice;                         // held for the length of an I/O
+Semaphore *wlDone;
+int wlDeadline;
+int *wlRounds;                          // critical sections per worker
+int *wlWaits;                           // ticks waited for each lock
+int wlNumWaits;
+
+void WorkloadParse(char *spec)
+{
+    struct { char *name; int *value; } params[] = {
+        { "time", &wlTime }, { "locks", &wlLocks }, { "hot", &wlHot },
+        { "cs", &wlCS }, { "think", &wlThink }, { "yield", &wlYield },
+        { "sleep", &wlSleep }, { "io", &wlIO },
+        { "sleeptime", &wlSleepTime }, { "iotime", &wlIOTime } };
+    char *copy = new char[strlen(spec) + 1];
+    char *param, *value;
+    unsigned int i;
+
+    strcpy(copy, spec);
+    for (param = strtok(copy, ","); param != NULL; param = strtok(NULL, ",")) {
+        value = strchr(param, '=');
+        ASSERT(value != NULL);
+        *value++ = '\0';
+        if (!strcmp(param, "lock"))
+            wlSpin = !strcmp(value, "spin");
+        else if (!strcmp(param, "csdist") || !strcmp(param, "thinkdist")) {
+            int dist = !strcmp(value, "exp") ? DistExp
+                : !strcmp(value, "uniform") ? DistUniform : DistConst;
+            *(!strcmp(param, "csdist") ? &wlCSDist : &wlThinkDist) = dist;
+        } else {
+            for (i = 0; i < sizeof(params) / sizeof(params[0]); ++i)
+                if (!strcmp(param, params[i].name))
+                    break;
+            if (i == sizeof(params) / sizeof(params[0])) {
+                printf("Unknown workload parameter %s\n", param);
+                ASSERT(FALSE);
+            }
+            *params[i].value = atoi(value);
+        }
+    }
+    delete [] copy;
+    ASSERT((wlLocks > 0) && (wlTime > 0));
+    ASSERT(wlYield + wlSleep + wlIO <= 100);
+}
+
+int WorkloadSample(int mean, int dist)  // ticks, with the given mean
+{
+    int ticks;
+
+    if ((mean <= 0) || (dist == DistConst))
+        return mean;
+    if (dist == DistUniform)
+        return Random() % (2 * mean + 1);
+    if (mean <= SystemTick)             // exponential, a tick at a time:
+        return mean;                    // each one is the last with
+    for (ticks = SystemTick; Random() % mean >= SystemTick; )
+        ticks += SystemTick;            // probability SystemTick / mean
+    return ticks;
+}
+
+void WorkloadWorker(int me)
+{
+    int which, start, r;
+
+    while (stats->totalTicks < wlDeadline) {
+        which = ((Random() % 100) < wlHot) ? 0 : Random() % wlLocks;
+        start = stats->totalTicks;
+        if (wlSpin)
+            wlSpinLock[which]->Acquire();
+        else
+            wlLock[which]->Acquire();
+        if (wlNumWaits < MaxWaitSamples)
+            wlWaits[wlNumWaits++] = stats->totalTicks - start;
+        SMPBusy(WorkloadSample(wlCS, wlCSDist));
+        if (wlSpin)
+            wlSpinLock[which]->Release();
+        else
+            wlLock[which]->Release();
+        wlRounds[me]++;
+
+        SMPBusy(WorkloadSample(wlThink, wlThinkDist));
+        r = Random() % 100;
+        if (r < wlYield)
+            currentThread->Yield();
+        else if (r < wlYield + wlSleep)
+            alarms->PauseUntil(stats->totalTicks
+                + WorkloadSample(wlSleepTime, DistExp));
+        else if (r < wlYield + wlSleep + wlIO) {
+            wlDevice->Acquire();
+            alarms->PauseUntil(stats->totalTicks
+                + WorkloadSample(wlIOTime, DistExp));
+            wlDevice->Release();
+        }
+    }
+    wlDone->V();
+}
+
+int WorkloadCompare(const void *a, const void *b)
+{
+    return *(int *) a - *(int *) b;
+}
+
+void WorkloadTest18()
+{
+    DEBUG('t', "Entering WorkloadTest18\n");
+    double sum = 0, sumSquares = 0;
+    int total = 0, elapsed;
+    char name[32];
+
+    if (workload != NULL)
+        WorkloadParse(workload);
+    wlLock = new Lock *[wlLocks];
+    wlSpinLock = new SpinLock *[wlLocks];
+    for (int i = 0; i < wlLocks; ++i) {
+        sprintf(name, "workload lock %d", i);
+        wlLock[i] = new Lock(name);
+        wlSpinLock[i] = new SpinLock(name);
+    }
+    wlDevice = new Lock("workload device");
+    wlDone = new Semaphore("workload done", 0);
+    wlRounds = new int[threadnum];
+    wlWaits = new int[MaxWaitSamples];
+    wlNumWaits = 0;
+
+    int start = stats->totalTicks;
+    wlDeadline = start + wlTime;
+    for (int i = 0; i < threadnum; ++i) {
+        wlRounds[i] = 0;
+        (new Thread("workload worker"))->Fork(WorkloadWorker, i);
+    }
+    for (int i = 0; i < threadnum; ++i)
+        wlDone->P();
+    elapsed = stats->totalTicks - start;
+    while (scheduler->OtherCPUsBusy())  // let the last workers
+        currentThread->Yield();         // finish exiting
+
+    for (int i = 0; i < threadnum; ++i) {
+        total += wlRounds[i];
+        sum += wlRounds[i];
+        sumSquares += (double) wlRounds[i] * wlRounds[i];
+    }
+    qsort(wlWaits, wlNumWaits, sizeof(int), WorkloadCompare);
+    printf("threads  locks  elapsed  rounds  rounds/1000 ticks  fairness\n");
+    printf("%7d  %5d  %7d  %6d  %17.2f  %8.3f\n", threadnum, wlLocks, elapsed,
+        total, total * 1000.0 / elapsed,
+        (sumSquares > 0) ? sum * sum / (threadnum * sumSquares) : 1.0);
+    if (wlNumWaits > 0)
+        printf("lock wait ticks: p50 %d, p90 %d, p99 %d, max %d (of %d)\n",
+            wlWaits[wlNumWaits * 50 / 100], wlWaits[wlNumWaits * 90 / 100],
+            wlWaits[wlNumWaits * 99 / 100], wlWaits[wlNumWaits - 1],
+            wlNumWaits);
+}
+
 //----------------------------------------------------------------------
 // ThreadTest
 //  Invoke a test routine.
@@ -485,6 +1151,62 @@ ThreadTest()
         break;
     }
 
+    case 11://test work queue
+    {
+        //./nachos -d w -q 11 -T 3 -N 20
+        WorkQueueTest11();//-T worker number; -N work items.
+        break;
+    }
+
+    case 12://test stackless tasks
+    {
+        //./nachos -q 12 -N 1000000
+        TaskTest12();//-N tasks.
+        break;
+    }
+
+    case 13://test priority inheritance
+    {
+        //./nachos -q 13 -T 3
+        PriorityTest13();//-T hog number.
+        break;
+    }
+
+    case 14://test condition handoff
+    {
+        //./nachos -q 14 -N 1000
+        HandoffTest14();//-N bytes and turns.
+        break;
+    }
+
+    case 15://test real-time scheduling
+    {
+        //./nachos -d R -q 15 -T 2 -N 10
+        RealTimeTest15();//-T hog number; -N jobs.
+        break;
+    }
+
+    case 16://test multiprocessor scaling
+    {
+        //./nachos -q 16 -T 8 -N 50
+        SMPTest16();//-T worker number; -N units each.
+        break;
+    }
+
+    case 17://test barrier scaling
+    {
+        //./nachos -cpus 8 -q 17
+        BarrierTest17();
+        break;
+    }
+
+    case 18://test a synthetic workload
+    {
+        //./nachos -T 8 -q 18 -W locks=4,hot=80,csdist=exp,io=10
+        WorkloadTest18();//-T worker number; -W workload (see above).
+        break;
+    }
+
     default:
     {
         printf("No test specified.\n");
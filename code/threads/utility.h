@@ -15,6 +15,11 @@
 //   	'f' -- file system (FILESYS)
 //   	'a' -- address spaces (USER_PROGRAM)
 //   	'n' -- network emulation (NETWORK)
+//   	'r' -- record/replay of nondeterministic inputs
+//   	'k' -- kernel object caches (slab allocator)
+//   	'w' -- kernel work queues
+//   	'T' -- stackless tasks
+//   	'R' -- real-time scheduling
 //
 // Copyright (c) 1992-1993 The Regents of the University of California.
 // All rights reserved.  See copyright.h for copyright notice and limitation 
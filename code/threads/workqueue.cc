@@ -0,0 +1,264 @@
+// workqueue.cc
+//	Routines to manage a kernel work queue and its pool of
+//	worker threads.
+//
+//	The queue, the list of idle workers, and the count of
+//	outstanding items are only touched with interrupts disabled,
+//	in the same way as the semaphore implementation in synch.cc.
+//	The work items themselves run with interrupts enabled, and may
+//	block.
+//
+// Copyright (c) 1992-1993 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#include "copyright.h"
+#include "workqueue.h"
+#include "system.h"
+#include "slab.h"
+
+// The following class defines one piece of deferred work.
+
+class WorkItem {
+  public:
+    WorkItem(VoidFunctionPtr f, int a, int p) { func = f; arg = a;
+						priority = p; }
+
+    void *operator new(size_t size);	// WorkItems come from an
+    void operator delete(void *p);	// ObjectCache (see slab.h)
+
+    VoidFunctionPtr func;	// the procedure to call
+    int arg;			// and its argument
+    int priority;		// as given to Submit
+};
+
+static ObjectCache *itemCache = NULL;
+
+void *
+WorkItem::operator new(size_t size)
+{
+    ASSERT(size == sizeof(WorkItem));
+    if (itemCache == NULL)
+	itemCache = new ObjectCache("work items", sizeof(WorkItem), 32);
+    return itemCache->Alloc();
+}
+
+void
+WorkItem::operator delete(void *p)
+{
+    itemCache->Free(p);
+}
+
+//----------------------------------------------------------------------
+// WorkerThread
+// 	Dummy function because C++ can't fork a member function.
+//----------------------------------------------------------------------
+
+static void
+WorkerThread(int arg)
+{
+    WorkQueue *workq = (WorkQueue *) arg;
+
+    workq->Worker();
+}
+
+//----------------------------------------------------------------------
+// WorkQueue::WorkQueue
+// 	Initialize an empty work queue, and fork its workers.  The
+//	workers go to sleep as soon as they first run, until there is
+//	work for them.
+//
+//	"debugName" is an arbitrary name, useful for debugging.
+//	"count" is the number of worker threads.
+//----------------------------------------------------------------------
+
+WorkQueue::WorkQueue(char *debugName, int count)
+{
+    int i;
+
+    ASSERT(count > 0);
+    name = debugName;
+    numWorkers = numLive = count;
+    exiting = FALSE;
+    queue = new SortedList<WorkItem *, int>;
+    idle = new ThreadQueue;
+    waiters = new ThreadQueue;
+    outstanding = 0;
+    numSubmitted = numBatches = maxQueued = numQueued = 0;
+
+    workerNames = new char *[count];
+    for (i = 0; i < count; i++) {
+	Thread *t;
+
+	workerNames[i] = new char[strlen(name) + 16];
+	sprintf(workerNames[i], "%s worker %d", name, i);
+	t = new Thread(workerNames[i]);
+	t->Fork(WorkerThread, (int) this);
+    }
+}
+
+//----------------------------------------------------------------------
+// WorkQueue::~WorkQueue
+// 	Let the workers finish whatever work is still queued, tell them
+//	to exit, and wait until they have.  By the time we run again,
+//	the last of them has been deleted, so their names can go too.
+//----------------------------------------------------------------------
+
+WorkQueue::~WorkQueue()
+{
+    Thread *thread;
+    int i;
+    IntStatus oldLevel = interrupt->SetLevel(IntOff);
+
+    exiting = TRUE;
+    while ((thread = idle->Remove()) != NULL)
+	scheduler->ReadyToRun(thread);
+    while (numLive > 0) {
+	waiters->Append(currentThread);
+	currentThread->Sleep();
+    }
+    (void) interrupt->SetLevel(oldLevel);
+
+    delete queue;
+    delete idle;
+    delete waiters;
+    for (i = 0; i < numWorkers; i++)
+	delete [] workerNames[i];
+    delete [] workerNames;
+}
+
+//----------------------------------------------------------------------
+// WorkQueue::Submit
+// 	Queue a call to (*func)(arg), and wake up an idle worker to run
+//	it.  Never blocks, so it is safe to call from an interrupt
+//	handler.
+//
+//	"func", "arg" -- the work to be done
+//	"priority" -- items with higher priority are run first
+//----------------------------------------------------------------------
+
+void
+WorkQueue::Submit(VoidFunctionPtr func, int arg, int priority)
+{
+    Thread *thread;
+    IntStatus oldLevel = interrupt->SetLevel(IntOff);
+
+    ASSERT(!exiting);
+    queue->Insert(new WorkItem(func, arg, priority), -priority);
+    outstanding++;
+    numSubmitted++;
+    if (++numQueued > maxQueued)
+	maxQueued = numQueued;
+    DEBUG('w', "%s: submitted work 0x%x(%d), priority %d\n", name,
+		(int) func, arg, priority);
+
+    thread = idle->Remove();		// wake up a worker, if one
+    if (thread != NULL)			// is waiting for work
+	scheduler->ReadyToRun(thread);
+
+    (void) interrupt->SetLevel(oldLevel);
+}
+
+//----------------------------------------------------------------------
+// WorkQueue::Wait
+// 	Wait until every item submitted so far has finished running.
+//	A work item must not call this, since it would be waiting for
+//	itself.
+//----------------------------------------------------------------------
+
+void
+WorkQueue::Wait()
+{
+    IntStatus oldLevel = interrupt->SetLevel(IntOff);
+
+    while (outstanding > 0) {
+	waiters->Append(currentThread);
+	currentThread->Sleep();
+    }
+    (void) interrupt->SetLevel(oldLevel);
+}
+
+//----------------------------------------------------------------------
+// WorkQueue::Run
+// 	Run one work item, with interrupts enabled, and note that it is
+//	done.  Called, and returns, with interrupts disabled.
+//----------------------------------------------------------------------
+
+void
+WorkQueue::Run(WorkItem *item)
+{
+    Thread *thread;
+
+    (void) interrupt->SetLevel(IntOn);
+    (*item->func)(item->arg);
+    delete item;
+    (void) interrupt->SetLevel(IntOff);
+
+    outstanding--;
+    if (outstanding == 0)		// wake up anyone in Wait()
+	while ((thread = waiters->Remove()) != NULL)
+	    scheduler->ReadyToRun(thread);
+}
+
+//----------------------------------------------------------------------
+// WorkQueue::Worker
+// 	The body of each worker thread.  Take a batch of items off the
+//	queue, run them, and repeat; when the queue is empty, sleep
+//	until Submit wakes us up.  Before each item of the batch, run
+//	anything more urgent that has been submitted since we took it.
+//	When the queue is being deleted, exit once there is no work
+//	left.
+//----------------------------------------------------------------------
+
+void
+WorkQueue::Worker()
+{
+    WorkItem *batch[WorkBatch];
+    Thread *thread;
+    int i, n;
+
+    (void) interrupt->SetLevel(IntOff);
+
+    for (;;) {
+	while (queue->IsEmpty() && !exiting) {
+	    idle->Append(currentThread);
+	    currentThread->Sleep();
+	}
+	if (queue->IsEmpty())		// exiting, and nothing left to do
+	    break;
+
+	for (n = 0; (n < WorkBatch) && !queue->IsEmpty(); n++)
+	    batch[n] = queue->Remove(NULL);
+	numQueued -= n;
+	numBatches++;
+	DEBUG('w', "%s: %s took %d items\n", name, currentThread->getName(), n);
+
+	for (i = 0; i < n; i++) {
+	    while (!queue->IsEmpty()
+			&& (-queue->FirstKey() > batch[i]->priority)) {
+		numQueued--;
+		Run(queue->Remove(NULL));
+	    }
+	    Run(batch[i]);
+	}
+    }
+
+    numLive--;
+    if (numLive == 0)			// wake up the destructor
+	while ((thread = waiters->Remove()) != NULL)
+	    scheduler->ReadyToRun(thread);
+    currentThread->Finish();
+}
+
+//----------------------------------------------------------------------
+// WorkQueue::Print
+// 	Print how much work the queue has done.
+//----------------------------------------------------------------------
+
+void
+WorkQueue::Print()
+{
+    printf("Work queue %s: %d workers, items %d, batches %d, "
+	"most queued %d\n", name, numWorkers, numSubmitted, numBatches,
+	maxQueued);
+}
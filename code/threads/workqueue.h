@@ -0,0 +1,81 @@
+// workqueue.h
+//	Data structures for a kernel work queue -- a fixed pool of
+//	worker threads that run short pieces of work ("work items")
+//	on behalf of the rest of the kernel.
+//
+//	A work item is just a procedure and an argument, like the
+//	arguments to Thread::Fork, plus a priority.  Submitting one is
+//	cheap -- no thread or stack is created -- and Submit can be called
+//	from an interrupt handler, so a device can defer the part of
+//	its completion processing that needs to block (to acquire a
+//	Lock, for instance) to a worker.
+//
+//	Workers take items off the queue highest priority first (in
+//	order of submission among items of equal priority), and take
+//	up to WorkBatch items at a time, to amortize the cost of going
+//	to the queue.  An item of higher priority than the rest of a
+//	batch, submitted after the batch was taken, is run before them.
+//
+//	With more than one worker, items can run at once, and so finish
+//	out of order.  Work that must be done in the order it was
+//	submitted needs a queue with a single worker.
+//
+// Copyright (c) 1992-1993 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#ifndef WORKQUEUE_H
+#define WORKQUEUE_H
+
+#include "copyright.h"
+#include "utility.h"
+#include "list.h"
+#include "thread.h"
+
+#define WorkBatch	8	// most items a worker takes at once
+
+class WorkItem;
+
+// The following class defines a work queue and its pool of workers.
+// As with Semaphore, the queue itself is protected by disabling
+// interrupts, which is what lets interrupt handlers submit work.
+
+class WorkQueue {
+  public:
+    WorkQueue(char *debugName, int numWorkers);
+				// initialize the queue, and fork the workers
+    ~WorkQueue();		// wait for the workers to finish all
+				// submitted work and exit
+
+    void Submit(VoidFunctionPtr func, int arg, int priority = 0);
+				// arrange for a worker to call (*func)(arg);
+				// higher priority items are run first
+    void Wait();		// wait until every item submitted so far
+				// has finished.  Must not be called by
+				// a work item!
+
+    void Worker();		// body of each worker thread
+    void Print();		// print usage statistics
+
+  private:
+    char *name;			// useful for debugging
+    int numWorkers;		// size of the pool
+    char **workerNames;		// the names of the worker threads
+    int numLive;		// workers that haven't exited
+    bool exiting;		// TRUE once the queue is being deleted
+
+    SortedList<WorkItem *, int> *queue;	// items not yet taken by
+					// a worker, keyed by -priority
+    ThreadQueue *idle;		// workers waiting for something to do
+    ThreadQueue *waiters;	// threads waiting in Wait()
+    int outstanding;		// items submitted but not yet finished
+
+    int numSubmitted;		// statistics
+    int numBatches;
+    int maxQueued;
+    int numQueued;
+
+    void Run(WorkItem *item);	// run one item, with interrupts enabled
+};
+
+#endif // WORKQUEUE_H
@@ -3,7 +3,8 @@
 //
 //	In order to run a user program, you must:
 //
-//	1. link with the -N -T 0 option 
+//	1. link with the -N -T 0 option (or with ../test/script, which
+//		starts the data on a page of its own)
 //	2. run coff2noff to convert the object file to Nachos format
 //		(Nachos object code format is essentially just a simpler
 //		version of the UNIX executable object code format)
@@ -19,10 +20,43 @@
 #include "system.h"
 #include "addrspace.h"
 #include "noff.h"
+#include "bitmap.h"
 #ifdef HOST_SPARC
 #include <strings.h>
 #endif
 
+// Physical page frames in use, by all address spaces
+static BitMap *freeFrames = NULL;
+
+// The number to give the next address space, for page traces
+static int nextSpaceId = 0;
+
+// Free frames promised to address spaces, for pages they haven't
+// touched yet
+static int reservedFrames = 0;
+
+#ifdef USE_TLB
+// The address space whose pages the TLB holds, if any, and the next
+// entry to replace once they are all in use
+static AddrSpace *tlbOwner = NULL;
+static int nextVictim = 0;
+#endif
+
+#define MaxSharedCode	16	// most programs whose code is shared at once
+
+// The following class defines the read-only pages of a program, shared
+// by every address space running it.
+
+class SharedCode {
+  public:
+    char *name;			// the program's file name
+    NoffHeader header;		// and its header, to be sure it's the same
+    int *frames;		// frame holding each page; -1 if not shared
+    int users;			// address spaces using the frames
+};
+
+static SharedCode *sharedCodes[MaxSharedCode];
+
 //----------------------------------------------------------------------
 // SwapHeader
 // 	Do little endian to big endian conversion on the bytes in the 
@@ -45,6 +79,62 @@ SwapHeader (NoffHeader *noffH)
 	noffH->uninitData.inFileAddr = WordToHost(noffH->uninitData.inFileAddr);
 }
 
+static void 
+SwapExtension (NoffExtension *noffX)
+{
+	noffX->pageSize = WordToHost(noffX->pageSize);
+	noffX->codeFlags = WordToHost(noffX->codeFlags);
+	noffX->initDataFlags = WordToHost(noffX->initDataFlags);
+	noffX->uninitDataFlags = WordToHost(noffX->uninitDataFlags);
+	noffX->symbols.size = WordToHost(noffX->symbols.size);
+	noffX->symbols.virtualAddr = WordToHost(noffX->symbols.virtualAddr);
+	noffX->symbols.inFileAddr = WordToHost(noffX->symbols.inFileAddr);
+}
+
+//----------------------------------------------------------------------
+// Overlaps
+// 	Return TRUE if the segment has any bytes in virtual page "page".
+//----------------------------------------------------------------------
+
+static bool
+Overlaps(Segment *segment, unsigned int page)
+{
+    return (segment->size > 0)
+	&& ((unsigned) segment->virtualAddr < (page + 1) * PageSize)
+	&& ((unsigned) (segment->virtualAddr + segment->size) > page * PageSize);
+}
+
+//----------------------------------------------------------------------
+// LoadSegment
+// 	Copy a segment of the executable into the address space, a page
+//	at a time, since virtual pages need not be contiguous in physical
+//	memory.
+//
+//	"executable" -- the file to read it from
+//	"pageTable" -- the address space's translation
+//	"virtualAddr", "size", "inFileAddr" -- where the segment goes, how
+//		big it is, and where it is in the file
+//----------------------------------------------------------------------
+
+static void
+LoadSegment(OpenFile *executable, PageTable *pageTable,
+	int virtualAddr, int size, int inFileAddr)
+{
+    int chunk, offset;
+
+    while (size > 0) {
+	offset = virtualAddr % PageSize;
+	chunk = min(size, PageSize - offset);
+	executable->ReadAt(&(machine->mainMemory[
+		pageTable->Lookup(virtualAddr / PageSize)->physicalPage
+						* PageSize + offset]),
+		chunk, inFileAddr);
+	virtualAddr += chunk;
+	inFileAddr += chunk;
+	size -= chunk;
+    }
+}
+
 //----------------------------------------------------------------------
 // AddrSpace::AddrSpace
 // 	Create an address space to run a user program.
@@ -54,22 +144,46 @@ SwapHeader (NoffHeader *noffH)
 //	Assumes that the object code file is in NOFF format.
 //
 //	First, set up the translation from program memory to physical 
-//	memory.  For now, this is really simple (1:1), since we are
-//	only uniprogramming, and we have a single unsegmented page table
+//	memory.  Each virtual page gets a free physical page frame of its
+//	own, so that several programs can be in memory at once; there is
+//	no virtual memory yet, so the program has to fit.
+//
+//	Programs with page-aligned segments are loaded by LoadPages
+//	instead.
 //
 //	"executable" is the file containing the object code to load into memory
+//	"fileName" is its name, so that programs can share code
 //----------------------------------------------------------------------
 
-AddrSpace::AddrSpace(OpenFile *executable)
+AddrSpace::AddrSpace(OpenFile *executable, char *fileName)
 {
     NoffHeader noffH;
+    TranslationEntry *entry;
     unsigned int i, size;
 
+    if (freeFrames == NULL)
+	freeFrames = new BitMap(NumPhysPages);
+    id = nextSpaceId++;
+    sharedCode = NULL;
+    numUnfilled = 0;
+    pageTable = new PageTable;
+    stackPage = NumVirtPages;		// until LoadPages moves it
+    loaded = TRUE;
+
     executable->ReadAt((char *)&noffH, sizeof(noffH), 0);
+    if ((noffH.noffMagic == NOFFPAGEDMAGIC)
+		|| (WordToHost(noffH.noffMagic) == NOFFPAGEDMAGIC)) {
+	LoadPages(executable, fileName);
+	return;
+    }
     if ((noffH.noffMagic != NOFFMAGIC) && 
 		(WordToHost(noffH.noffMagic) == NOFFMAGIC))
     	SwapHeader(&noffH);
-    ASSERT(noffH.noffMagic == NOFFMAGIC);
+    if (noffH.noffMagic != NOFFMAGIC) {
+	DEBUG('a', "Not a NOFF file\n");
+	loaded = FALSE;
+	return;
+    }
 
 // how big is address space?
     size = noffH.code.size + noffH.initData.size + noffH.uninitData.size 
@@ -78,55 +192,452 @@ AddrSpace::AddrSpace(OpenFile *executable)
     numPages = divRoundUp(size, PageSize);
     size = numPages * PageSize;
 
-    ASSERT(numPages <= NumPhysPages);		// check we're not trying
-						// to run anything too big --
-						// at least until we have
-						// virtual memory
+    if ((int) numPages > freeFrames->NumClear() - reservedFrames) {
+					// we can't run anything too big --
+					// at least until we have virtual
+					// memory
+	DEBUG('a', "Program needs %d pages, too many to fit\n", numPages);
+	numPages = 0;
+	loaded = FALSE;
+	return;
+    }
 
     DEBUG('a', "Initializing address space, num pages %d, size %d\n", 
 					numPages, size);
-// first, set up the translation 
-    pageTable = new TranslationEntry[numPages];
+// first, set up the translation, zeroing out each frame to zero the
+// unitialized data segment and the stack segment
     for (i = 0; i < numPages; i++) {
-	pageTable[i].virtualPage = i;	// for now, virtual page # = phys page #
-	pageTable[i].physicalPage = i;
-	pageTable[i].valid = TRUE;
-	pageTable[i].use = FALSE;
-	pageTable[i].dirty = FALSE;
-	pageTable[i].readOnly = FALSE;  // if the code segment was entirely on 
+	entry = pageTable->Add(i);
+	entry->valid = TRUE;
+	entry->readOnly = FALSE;	// if the code segment was entirely on 
 					// a separate page, we could set its 
 					// pages to be read-only
     }
+    for (i = 0; i < numPages; i++) {
+	entry = pageTable->Lookup(i);
+	entry->physicalPage = FindFrame(i);
+	bzero(&(machine->mainMemory[entry->physicalPage * PageSize]),
+		PageSize);
+    }
     
-// zero out the entire address space, to zero the unitialized data segment 
-// and the stack segment
-    bzero(machine->mainMemory, size);
-
 // then, copy in the code and data segments into memory
     if (noffH.code.size > 0) {
         DEBUG('a', "Initializing code segment, at 0x%x, size %d\n", 
 			noffH.code.virtualAddr, noffH.code.size);
-        executable->ReadAt(&(machine->mainMemory[noffH.code.virtualAddr]),
+	LoadSegment(executable, pageTable, noffH.code.virtualAddr,
 			noffH.code.size, noffH.code.inFileAddr);
     }
     if (noffH.initData.size > 0) {
         DEBUG('a', "Initializing data segment, at 0x%x, size %d\n", 
 			noffH.initData.virtualAddr, noffH.initData.size);
-        executable->ReadAt(&(machine->mainMemory[noffH.initData.virtualAddr]),
+	LoadSegment(executable, pageTable, noffH.initData.virtualAddr,
 			noffH.initData.size, noffH.initData.inFileAddr);
     }
+    for (i = 0; i < numPages; i++)
+	Promote(i);
+}
+
+//----------------------------------------------------------------------
+// AddrSpace::LoadPages
+// 	Set up an address space for a program whose segments are aligned
+//	to pages, and tagged with how they may be used (see noff.h).
+//	Each virtual page is either
+//
+//	   loaded from the file, if any code or initialized data is in it;
+//		read-only if none of it is writable, in which case the
+//		frame is shared with every other address space running
+//		the same program, and only loaded by the first of them
+//
+//	   or zero-filled on demand, if it holds only uninitialized data,
+//		stack, or nothing at all; it isn't even in the page table
+//		until the program touches it (see ZeroFill).  A frame is
+//		set aside for it all the same, so that it is sure to get
+//		one.
+//
+//	The stack goes at the top of user memory, far from the rest.
+//
+//	"executable", "fileName" -- as for the constructor
+//----------------------------------------------------------------------
+
+void
+AddrSpace::LoadPages(OpenFile *executable, char *fileName)
+{
+    NoffHeader noffH;
+    NoffExtension noffX;
+    Segment *segment;
+    SharedCode *code = NULL;
+    TranslationEntry *entry;
+    unsigned int i, size;
+    int j, needed, free, numRead;
+    bool writable;
+    char *frame;
+
+    executable->ReadAt((char *)&noffH, sizeof(noffH), 0);
+    executable->ReadAt((char *)&noffX, sizeof(noffX), sizeof(noffH));
+    if (noffH.noffMagic != NOFFPAGEDMAGIC) {
+    	SwapHeader(&noffH);
+	SwapExtension(&noffX);
+    }
+    ASSERT(noffX.pageSize == PageSize);
+
+// how big is address space?  there may be gaps between the segments
+    size = 0;
+    for (segment = &noffH.code; segment <= &noffH.uninitData; segment++)
+	if ((segment->size > 0)
+		&& ((unsigned) (segment->virtualAddr + segment->size) > size))
+	    size = segment->virtualAddr + segment->size;
+    numPages = divRoundUp(size, PageSize);
+    stackPage = NumVirtPages - divRoundUp(UserStackSize, PageSize);
+    size = numPages * PageSize;
+
+    for (j = 0; (j < MaxSharedCode) && (fileName != NULL); j++)
+	if ((sharedCodes[j] != NULL) && !strcmp(sharedCodes[j]->name, fileName)
+		&& !memcmp(&sharedCodes[j]->header, &noffH, sizeof(noffH))) {
+	    code = sharedCodes[j];
+	    break;
+	}
+
+    DEBUG('a', "Initializing paged address space, num pages %d, size %d%s\n",
+		numPages, size, (code != NULL) ? ", sharing code" : "");
+// first, decide what each page is: in the file (valid), writable or not
+    for (i = needed = 0; i < numPages; i++) {
+	if (!Overlaps(&noffH.code, i) && !Overlaps(&noffH.initData, i)) {
+	    numUnfilled++;
+	    needed++;
+	    continue;
+	}
+	writable = (Overlaps(&noffH.code, i) && (noffX.codeFlags & NOFF_WRITE))
+	    || (Overlaps(&noffH.initData, i)
+			&& (noffX.initDataFlags & NOFF_WRITE))
+	    || Overlaps(&noffH.uninitData, i);
+	entry = pageTable->Add(i);
+	entry->valid = TRUE;
+	entry->readOnly = !writable;
+	if (!entry->readOnly || (code == NULL))
+	    needed++;
+    }
+    numUnfilled += NumVirtPages - stackPage;
+    needed += NumVirtPages - stackPage;
+    if (needed > freeFrames->NumClear() - reservedFrames) {
+					// we can't run anything too big;
+					// drop the pages set up so far
+	DEBUG('a', "Program needs %d frames, too many to fit\n", needed);
+	delete pageTable;
+	pageTable = new PageTable;
+	numPages = numUnfilled = 0;
+	stackPage = NumVirtPages;
+	loaded = FALSE;
+	return;
+    }
+    reservedFrames += numUnfilled;
 
+    if (code == NULL) {			// the first to run this program
+	for (j = 0; (j < MaxSharedCode) && (sharedCodes[j] != NULL); j++)
+	    ;
+	if ((j < MaxSharedCode) && (fileName != NULL)) {
+	    code = sharedCodes[j] = new SharedCode;
+	    code->name = new char[strlen(fileName) + 1];
+	    strcpy(code->name, fileName);
+	    code->header = noffH;
+	    code->frames = new int[numPages];
+	    for (i = 0; i < numPages; i++)
+		code->frames[i] = -1;
+	    code->users = 0;
+	}
+    }
+
+// then, read in each page that is in the file, unless it's shared
+// and already in memory
+    for (i = 0; i < numPages; i++) {
+	entry = pageTable->Lookup(i);
+	if ((entry == NULL) || !entry->valid)
+	    continue;
+	if (entry->readOnly && (code != NULL) && (code->frames[i] >= 0)) {
+	    entry->physicalPage = code->frames[i];
+	    Promote(i);
+	    continue;
+	}
+	free = FindFrame(i);
+	ASSERT(free >= 0);
+	entry->physicalPage = free;
+	segment = Overlaps(&noffH.code, i) ? &noffH.code : &noffH.initData;
+	frame = &(machine->mainMemory[free * PageSize]);
+	numRead = executable->ReadAt(frame, PageSize,
+		segment->inFileAddr + i * PageSize - segment->virtualAddr);
+	if (numRead < PageSize)
+	    bzero(frame + numRead, PageSize - numRead);
+	if (entry->readOnly && (code != NULL))
+	    code->frames[i] = free;
+	DEBUG('a', "Loaded page %d into frame %d%s\n", i, free,
+		entry->readOnly ? ", read-only" : "");
+	Promote(i);
+    }
+    if (code != NULL) {
+	code->users++;
+	sharedCode = code;
+    }
 }
 
 //----------------------------------------------------------------------
 // AddrSpace::~AddrSpace
-// 	Dealloate an address space.  Nothing for now!
+// 	Dealloate an address space, giving back its page frames.
 //----------------------------------------------------------------------
 
 AddrSpace::~AddrSpace()
 {
-   delete pageTable;
+    TranslationEntry *entry;
+    unsigned int i;
+    int j;
+
+    for (i = 0; i < NumVirtPages; i++) {
+	if (i == numPages)
+	    i = stackPage;		// skip the gap below the stack
+	entry = pageTable->Lookup(i);
+	if ((entry != NULL) && entry->valid && ((sharedCode == NULL)
+		|| (i >= numPages)
+		|| (sharedCode->frames[i] != entry->physicalPage)))
+	    freeFrames->Clear(entry->physicalPage);
+    }
+    reservedFrames -= numUnfilled;
+
+    if ((sharedCode != NULL) && (--sharedCode->users == 0)) {
+	for (i = 0; i < numPages; i++)
+	    if (sharedCode->frames[i] >= 0)
+		freeFrames->Clear(sharedCode->frames[i]);
+	for (j = 0; sharedCodes[j] != sharedCode; j++)
+	    ;
+	sharedCodes[j] = NULL;
+	delete [] sharedCode->name;
+	delete [] sharedCode->frames;
+	delete sharedCode;
+    }
+#ifdef USE_TLB
+    if (tlbOwner == this)
+	tlbOwner = NULL;
+#endif
+    DEBUG('a', "Page table took %d bytes\n", pageTable->NumBytes());
+    delete pageTable;
+}
+
+//----------------------------------------------------------------------
+// FreeRun
+// 	Return TRUE if the "size" frames starting at "first" are all free.
+//----------------------------------------------------------------------
+
+static bool
+FreeRun(int first, int size)
+{
+    for (int i = first; i < first + size; i++)
+	if (freeFrames->Test(i))
+	    return FALSE;
+    return TRUE;
+}
+
+//----------------------------------------------------------------------
+// AddrSpace::FindFrame
+// 	Take a free frame for virtual page "vpn", and return it (or -1 if
+//	there are none).  To let the page be part of a superpage later,
+//	look at the pages around it, in aligned runs from the largest
+//	superpage down: if one of them has a frame, take the one that is
+//	as far from it as "vpn" is from that page.  If none of them has
+//	a frame yet, start a run, at the same offset into the largest
+//	aligned block of free frames we can find.  Otherwise, take a
+//	frame from a block that is partly used already, so as to leave
+//	whole blocks free for runs yet to start.
+//
+//	An aligned run of pages is always in a single page table leaf,
+//	which "vpn" is in already.
+//----------------------------------------------------------------------
+
+int
+AddrSpace::FindFrame(unsigned int vpn)
+{
+    TranslationEntry *run;
+    unsigned int size, first, i;
+    bool alone = TRUE;
+    int frame;
+
+    for (size = MaxSuperPage; size > 1; size /= SuperPageRatio) {
+	first = vpn - vpn % size;
+	run = pageTable->Lookup(first);
+	for (i = 0; i < size; i++)
+	    if ((first + i != vpn) && (run[i].physicalPage >= 0))
+		break;
+	if (i == size)
+	    continue;			// no neighbour has a frame
+	alone = FALSE;
+	frame = run[i].physicalPage + (int) (vpn - first) - (int) i;
+	if ((frame >= 0) && (frame < NumPhysPages)
+		&& !freeFrames->Test(frame)) {
+	    freeFrames->Mark(frame);
+	    return frame;
+	}
+    }
+    for (size = MaxSuperPage; alone && (size > 1); size /= SuperPageRatio)
+	for (frame = 0; frame < NumPhysPages; frame += size)
+	    if (FreeRun(frame, size)) {
+		frame += vpn % size;
+		freeFrames->Mark(frame);
+		return frame;
+	    }
+    for (size = SuperPageRatio; size <= MaxSuperPage; size *= SuperPageRatio)
+	for (frame = 0; frame < NumPhysPages; frame++)
+	    if (!freeFrames->Test(frame)
+		    && !FreeRun(frame - frame % size, size)) {
+		freeFrames->Mark(frame);
+		return frame;
+	    }
+    return freeFrames->Find();
+}
+
+//----------------------------------------------------------------------
+// AddrSpace::Promote
+// 	Called once virtual page "vpn" has a frame.  Find the largest
+//	aligned run of pages around it that could be a superpage -- all
+//	with frames, contiguous, the first of them aligned to the size of
+//	the run, and all read-only or all writable -- and make it one.
+//	The page table still has an entry per page; each of them says
+//	how big a superpage it is part of, for LoadTLB.
+//----------------------------------------------------------------------
+
+void
+AddrSpace::Promote(unsigned int vpn)
+{
+    TranslationEntry *run;
+    unsigned int size, first, i;
+    int frame;
+
+    for (size = MaxSuperPage; size > 1; size /= SuperPageRatio) {
+	first = vpn - vpn % size;
+	run = pageTable->Lookup(first);	// the run is all in one leaf
+	frame = run[0].physicalPage;
+	if ((frame < 0) || (frame % size != 0))
+	    continue;
+	for (i = 1; i < size; i++)
+	    if ((run[i].physicalPage != frame + (int) i)
+		    || (run[i].readOnly != run[0].readOnly))
+		break;
+	if (i < size)
+	    continue;
+	if (run[0].numPages < (int) size) {
+	    for (i = 0; i < size; i++)
+		run[i].numPages = size;
+	    DEBUG('a', "Promoted pages %d to %d, in frames %d to %d\n",
+		first, first + size - 1, frame, frame + size - 1);
+	}
+	return;
+    }
+}
+
+//----------------------------------------------------------------------
+// AddrSpace::PageFault
+// 	Called on a page fault at "virtAddr".  If the page is waiting to
+//	be zero-filled, fill it.  With a TLB, the fault may just be a TLB
+//	miss, on a page that is in memory; either way, map the page in the
+//	TLB.  Return TRUE if the faulting access can be tried again, and
+//	FALSE if the program touched memory it doesn't have.
+//----------------------------------------------------------------------
+
+bool
+AddrSpace::PageFault(int virtAddr)
+{
+    unsigned int vpn = (unsigned) virtAddr / PageSize;
+    TranslationEntry *entry;
+
+    if ((vpn >= numPages) && ((vpn < stackPage) || (vpn >= NumVirtPages)))
+	return FALSE;			// not in the image or the stack
+    entry = pageTable->Lookup(vpn);
+#ifdef USE_TLB
+    if ((entry == NULL) || !entry->valid)
+	ZeroFill(vpn);
+    LoadTLB(vpn);
+#else
+    if ((entry != NULL) && entry->valid)
+	return FALSE;
+    ZeroFill(vpn);
+#endif
+    return TRUE;
+}
+
+//----------------------------------------------------------------------
+// AddrSpace::ZeroFill
+// 	Give virtual page "vpn", which is waiting to be zero-filled, one
+//	of the frames we set aside, zero it, and add it to the page table.
+//----------------------------------------------------------------------
+
+void
+AddrSpace::ZeroFill(unsigned int vpn)
+{
+    TranslationEntry *entry = pageTable->Add(vpn);
+    int free;
+
+    ASSERT(!entry->valid);
+    free = FindFrame(vpn);
+    ASSERT(free >= 0);
+    reservedFrames--;
+    numUnfilled--;
+    bzero(&(machine->mainMemory[free * PageSize]), PageSize);
+    entry->physicalPage = free;
+    entry->valid = TRUE;
+    stats->numPageFaults++;
+    DEBUG('a', "Zero-filled page %d into frame %d\n", vpn, free);
+    Promote(vpn);
+}
+
+#ifdef USE_TLB
+//----------------------------------------------------------------------
+// AddrSpace::LoadTLB
+// 	Map virtual page "vpn" in the TLB -- the whole superpage, if it
+//	is part of one -- in a free entry, or else in place of the next
+//	entry in turn.
+//----------------------------------------------------------------------
+
+void
+AddrSpace::LoadTLB(unsigned int vpn)
+{
+    TranslationEntry *entry;
+    unsigned int size = pageTable->Lookup(vpn)->numPages;
+    int i;
+
+    for (i = 0; (i < TLBSize) && machine->tlb[i].valid; i++)
+	;
+    if (i == TLBSize) {
+	i = nextVictim;
+	nextVictim = (nextVictim + 1) % TLBSize;
+    }
+    entry = &machine->tlb[i];
+    SaveTLBEntry(entry);
+    *entry = *pageTable->Lookup(vpn - vpn % size);
+    entry->use = FALSE;
+    entry->dirty = FALSE;
+    stats->numTLBMisses++;
+    DEBUG('a', "TLB entry %d maps %d page(s) at %d to frame %d\n", i,
+	entry->numPages, entry->virtualPage, entry->physicalPage);
+}
+
+//----------------------------------------------------------------------
+// AddrSpace::SaveTLBEntry
+// 	Copy the use and dirty bits of a TLB entry back to the pages it
+//	maps, before it is replaced.
+//----------------------------------------------------------------------
+
+void
+AddrSpace::SaveTLBEntry(TranslationEntry *entry)
+{
+    TranslationEntry *run;
+    int i;
+
+    if (!entry->valid)
+	return;
+    run = pageTable->Lookup(entry->virtualPage);	// all in one leaf
+    for (i = 0; i < entry->numPages; i++) {
+	if (entry->use)
+	    run[i].use = TRUE;
+	if (entry->dirty)
+	    run[i].dirty = TRUE;
+    }
 }
+#endif
 
 //----------------------------------------------------------------------
 // AddrSpace::InitRegisters
@@ -141,6 +652,7 @@ AddrSpace::~AddrSpace()
 void
 AddrSpace::InitRegisters()
 {
+    unsigned int top = (stackPage < NumVirtPages) ? NumVirtPages : numPages;
     int i;
 
     for (i = 0; i < NumTotalRegs; i++)
@@ -154,10 +666,12 @@ AddrSpace::InitRegisters()
     machine->WriteRegister(NextPCReg, 4);
 
    // Set the stack register to the end of the address space, where we
-   // allocated the stack; but subtract off a bit, to make sure we don't
-   // accidentally reference off the end!
-    machine->WriteRegister(StackReg, numPages * PageSize - 16);
-    DEBUG('a', "Initializing stack register to %d\n", numPages * PageSize - 16);
+   // allocated the stack (the top of user memory, unless the stack is
+   // part of an old NOFF image); but subtract off a bit, to make sure
+   // we don't accidentally reference off the end!
+    machine->WriteRegister(StackReg, (int) (top * (unsigned) PageSize - 16));
+    DEBUG('a', "Initializing stack register to 0x%x\n",
+	top * (unsigned) PageSize - 16);
 }
 
 //----------------------------------------------------------------------
@@ -165,22 +679,38 @@ AddrSpace::InitRegisters()
 // 	On a context switch, save any machine state, specific
 //	to this address space, that needs saving.
 //
-//	For now, nothing!
+//	With a TLB, copy the use and dirty bits of our entries back to
+//	the page table.  Otherwise, nothing!
 //----------------------------------------------------------------------
 
 void AddrSpace::SaveState() 
-{}
+{
+#ifdef USE_TLB
+    if (tlbOwner == this)
+	for (int i = 0; i < TLBSize; i++)
+	    SaveTLBEntry(&machine->tlb[i]);
+#endif
+}
 
 //----------------------------------------------------------------------
 // AddrSpace::RestoreState
 // 	On a context switch, restore the machine state so that
 //	this address space can run.
 //
-//      For now, tell the machine where to find the page table.
+//      Without a TLB, tell the machine where to find the page table.
+//	With one, empty it, unless it still holds our pages; it is
+//	refilled a miss at a time.
 //----------------------------------------------------------------------
 
 void AddrSpace::RestoreState() 
 {
+#ifdef USE_TLB
+    if (tlbOwner != this) {
+	for (int i = 0; i < TLBSize; i++)
+	    machine->tlb[i].valid = FALSE;
+	tlbOwner = this;
+    }
+#else
     machine->pageTable = pageTable;
-    machine->pageTableSize = numPages;
+#endif
 }
@@ -2,9 +2,30 @@
 //	Data structures to keep track of executing user programs 
 //	(address spaces).
 //
-//	For now, we don't keep any information about address spaces.
-//	The user level CPU state is saved and restored in the thread
-//	executing the user program (see thread.h).
+//	An address space is a page table -- three levels of it (see
+//	../machine/translate.h), so that it only takes room for the
+//	parts of the address space in use.  The user level CPU state is
+//	saved and restored in the thread executing the user program (see
+//	thread.h).
+//
+//	A program made by the current coff2noff (see ../bin/noff.h) is
+//	loaded a page at a time, straight from the file; the pages that
+//	hold nothing but code are mapped read-only, and shared by every
+//	address space running the same program; and the pages that are
+//	all uninitialized data or stack start out invalid, and are only
+//	given a zeroed page frame when the program first touches them.
+//	The stack goes at the very top of user memory, far from the
+//	program, with nothing mapped in between.  An old NOFF file is
+//	loaded all at once, all writable, with the stack just after it.
+//
+//	With a TLB (see ../vm), the kernel refills it from the page table
+//	on each miss.  Frames are handed out so that each page lands next
+//	to the frames of the pages around it, at the same offset into an
+//	aligned block of frames; once an aligned run of 4 or 16 pages is
+//	all there, contiguous and protected alike, it is promoted to a
+//	superpage, which takes one TLB entry instead of one per page.
+//	Pages are never freed or remapped while the address space lives,
+//	so a superpage never has to be broken up again.
 //
 // Copyright (c) 1992-1993 The Regents of the University of California.
 // All rights reserved.  See copyright.h for copyright notice and limitation 
@@ -18,11 +39,15 @@
 
 #define UserStackSize		1024 	// increase this as necessary!
 
+class SharedCode;
+
 class AddrSpace {
   public:
-    AddrSpace(OpenFile *executable);	// Create an address space,
+    AddrSpace(OpenFile *executable, char *fileName);
+					// Create an address space,
 					// initializing it with the program
-					// stored in the file "executable"
+					// stored in the file "executable",
+					// opened from "fileName"
     ~AddrSpace();			// De-allocate an address space
 
     void InitRegisters();		// Initialize user-level CPU registers,
@@ -31,11 +56,42 @@ class AddrSpace {
     void SaveState();			// Save/restore address space-specific
     void RestoreState();		// info on a context switch 
 
+    bool Loaded() { return loaded; }	// FALSE if the program couldn't
+					// be loaded, such as if it is too
+					// big to fit in memory
+
+    int Id() { return id; }		// which address space this is,
+					// counting from 0 as they are made
+
+    bool PageFault(int virtAddr);	// Handle a page fault, or TLB miss,
+					// at "virtAddr"; FALSE if the
+					// program has no memory there
+
   private:
-    TranslationEntry *pageTable;	// Assume linear page table translation
-					// for now!
-    unsigned int numPages;		// Number of pages in the virtual 
-					// address space
+    PageTable *pageTable;		// Translations for the pages we
+					// have mapped
+    unsigned int numPages;		// Number of pages in the program
+					// image, from page 0
+    unsigned int stackPage;		// First page of the stack, which
+					// runs to NumVirtPages; NumVirtPages
+					// if it is part of the image
+    int id;				// number, for page traces
+    SharedCode *sharedCode;		// code pages shared with others
+					// running the same program, if any
+    int numUnfilled;			// pages still waiting to be zeroed
+    bool loaded;			// FALSE if the program didn't fit
+
+    void LoadPages(OpenFile *executable, char *fileName);
+					// load a NOFFPAGEDMAGIC program
+    int FindFrame(unsigned int vpn);	// a free frame for page "vpn"
+    void Promote(unsigned int vpn);	// make a superpage around "vpn",
+					// if it can be one
+    void ZeroFill(unsigned int vpn);	// give "vpn" a zeroed frame
+#ifdef USE_TLB
+    void LoadTLB(unsigned int vpn);	// map "vpn" in the TLB
+    void SaveTLBEntry(TranslationEntry *entry);
+					// copy its use and dirty bits back
+#endif
 };
 
 #endif // ADDRSPACE_H
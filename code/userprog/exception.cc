@@ -4,8 +4,8 @@
 //	transfer back to here from user code:
 //
 //	syscall -- The user code explicitly requests to call a procedure
-//	in the Nachos kernel.  Right now, the only function we support is
-//	"Halt".
+//	in the Nachos kernel.  We support all of those in syscall.h but
+//	Fork.
 //
 //	exceptions -- The user code does something that the CPU can't handle.
 //	For instance, accessing memory that doesn't exist, arithmetic errors,
@@ -14,8 +14,13 @@
 //	Interrupts (which can also cause control to transfer from user
 //	code into the Nachos kernel) are handled elsewhere.
 //
-// For now, this only handles the Halt() system call.
-// Everything else core dumps.
+// Each user program is a process: a thread with an address space,
+// plus the files it has open and, once it exits, its exit status,
+// kept until another process Joins it.  The first program (nachos -x)
+// becomes a process on its first system call.
+//
+// A page fault on a page still to be zero-filled (see addrspace.h)
+// fills it; any other exception but a system call still core dumps.
 //
 // Copyright (c) 1992-1993 The Regents of the University of California.
 // All rights reserved.  See copyright.h for copyright notice and limitation 
@@ -24,6 +29,390 @@
 #include "copyright.h"
 #include "system.h"
 #include "syscall.h"
+#include "synch.h"
+#include "addrspace.h"
+
+#define MaxProcesses	16	// most processes alive or waiting to be joined
+#define MaxOpenFiles	16	// most open files per process, counting
+				// the console
+#define MaxFileName	128	// longest file name, including the '\0'
+
+// The following class defines a user process, as far as the system
+// calls are concerned.
+
+class Process {
+  public:
+    Process(Thread *t, SpaceId p);
+    ~Process();
+
+    Thread *thread;			// running it; NULL once it has exited
+    SpaceId parent;			// the process that Exec'ed it, and
+					// alone may Join it; -1 if nobody can
+    bool first;				// run by "nachos -x", not by Exec
+    OpenFile *files[MaxOpenFiles];	// indexed by OpenFileId
+    int exitStatus;			// what it passed to Exit
+    Semaphore *exited;			// V'ed when it exits, for Join
+};
+
+static Process *processes[MaxProcesses];	// indexed by SpaceId
+
+//----------------------------------------------------------------------
+// Process::Process, Process::~Process
+// 	Set up a process, with no files open, run by thread "t" and
+//	Exec'ed by process "p" (-1 if by nobody); and close any files it
+//	leaves open.
+//----------------------------------------------------------------------
+
+Process::Process(Thread *t, SpaceId p)
+{
+    int i;
+
+    thread = t;
+    parent = p;
+    first = (p < 0);
+    for (i = 0; i < MaxOpenFiles; i++)
+	files[i] = NULL;
+    exitStatus = 0;
+    exited = new Semaphore("exited", 0);
+}
+
+Process::~Process()
+{
+    int i;
+
+    for (i = 0; i < MaxOpenFiles; i++)
+	delete files[i];
+    delete exited;
+}
+
+//----------------------------------------------------------------------
+// CurrentProcess
+// 	Return the SpaceId of the process the current thread runs,
+//	making it a process if it isn't one yet.
+//----------------------------------------------------------------------
+
+static SpaceId
+CurrentProcess()
+{
+    int i, free = -1;
+
+    for (i = 0; i < MaxProcesses; i++)
+	if (processes[i] == NULL) {
+	    if (free < 0)
+		free = i;
+	} else if (processes[i]->thread == currentThread)
+	    return i;
+    ASSERT(free >= 0);
+    processes[free] = new Process(currentThread, -1);
+    return free;
+}
+
+//----------------------------------------------------------------------
+// TranslateUser, CopyIn, CopyOut
+// 	Copy "size" bytes between user virtual memory and the kernel.
+//	Return FALSE if any of the user's bytes are not mapped.  Pages
+//	that are still to be zero-filled get filled on the way, and
+//	missing TLB entries loaded.
+//----------------------------------------------------------------------
+
+static ExceptionType
+TranslateUser(int virtAddr, int *physAddr, bool writing)
+{
+    ExceptionType exception;
+
+    exception = machine->Translate(virtAddr, physAddr, 1, writing);
+    if ((exception == PageFaultException)
+		&& currentThread->space->PageFault(virtAddr))
+	exception = machine->Translate(virtAddr, physAddr, 1, writing);
+    return exception;
+}
+
+static bool
+CopyIn(int from, char *to, int size)
+{
+    int i, physAddr;
+
+    for (i = 0; i < size; i++) {
+	if (TranslateUser(from + i, &physAddr, FALSE) != NoException)
+	    return FALSE;
+	to[i] = machine->mainMemory[physAddr];
+    }
+    return TRUE;
+}
+
+static bool
+CopyOut(char *from, int to, int size)
+{
+    int i, physAddr;
+
+    for (i = 0; i < size; i++) {
+	if (TranslateUser(to + i, &physAddr, TRUE) != NoException)
+	    return FALSE;
+	machine->mainMemory[physAddr] = from[i];
+    }
+    return TRUE;
+}
+
+//----------------------------------------------------------------------
+// CopyInString
+// 	Copy a null-terminated string from user virtual memory into
+//	"to", which holds MaxFileName bytes.  Return FALSE if the string
+//	is not mapped, or too long.
+//----------------------------------------------------------------------
+
+static bool
+CopyInString(int from, char *to)
+{
+    int i;
+
+    for (i = 0; i < MaxFileName; i++) {
+	if (!CopyIn(from + i, &to[i], 1))
+	    return FALSE;
+	if (to[i] == '\0')
+	    return TRUE;
+    }
+    return FALSE;
+}
+
+//----------------------------------------------------------------------
+// RunProcess
+// 	The first thing a process forked by Exec does: start running
+//	its program.
+//----------------------------------------------------------------------
+
+static void
+RunProcess(int dummy)
+{
+    currentThread->space->InitRegisters();
+    currentThread->space->RestoreState();
+    machine->Run();
+    ASSERT(FALSE);			// the process leaves by calling Exit
+}
+
+//----------------------------------------------------------------------
+// SysExec
+// 	Load the program "name" into a new address space, and start a
+//	process running it.  Return its SpaceId, or -1 if the program
+//	can't be opened, doesn't fit in memory, or there are too many
+//	processes.
+//----------------------------------------------------------------------
+
+static SpaceId
+SysExec(char *name)
+{
+    OpenFile *executable;
+    AddrSpace *space;
+    Thread *thread;
+    char *threadName;
+    int id, self;
+
+    self = CurrentProcess();		// so it doesn't take our slot
+    for (id = 0; (id < MaxProcesses) && (processes[id] != NULL); id++)
+	;
+    if ((id == MaxProcesses) || ((executable = fileSystem->Open(name)) == NULL))
+	return -1;
+    space = new AddrSpace(executable, name);
+    delete executable;
+    if (!space->Loaded()) {
+	DEBUG('a', "Can't load %s\n", name);
+	delete space;
+	return -1;
+    }
+
+    threadName = new char[strlen(name) + 1];	// lives as long as
+    strcpy(threadName, name);			// the thread does
+    thread = new Thread(threadName);
+    thread->space = space;
+    processes[id] = new Process(thread, self);
+    DEBUG('a', "Exec %s as process %d\n", name, id);
+    thread->Fork(RunProcess, 0);
+    return id;
+}
+
+//----------------------------------------------------------------------
+// SysExit
+// 	The current process is done.  Record its exit status for Join,
+//	give back its memory and files, and finish its thread.
+//
+//	A process nobody can Join gives back its slot in the process
+//	table now, and so do the children it leaves behind that have
+//	already exited; the rest of its children give theirs back when
+//	they exit.  The exit status of the first program goes in the
+//	statistics printed at halt, for the batch runner (see batch.cc).
+//----------------------------------------------------------------------
+
+static void
+SysExit(int status)
+{
+    SpaceId self = CurrentProcess();
+    Process *process = processes[self];
+    int i;
+
+    DEBUG('a', "Process %s exits with status %d\n", currentThread->getName(),
+	status);
+    if (process->first) {
+	stats->userExited = TRUE;
+	stats->userExitStatus = status;
+    }
+    for (i = 0; i < MaxProcesses; i++)
+	if ((processes[i] != NULL) && (processes[i]->parent == self)) {
+	    if (processes[i]->thread == NULL) {
+		delete processes[i];
+		processes[i] = NULL;
+	    } else
+		processes[i]->parent = -1;
+	}
+    if (process->parent < 0) {
+	delete process;
+	processes[self] = NULL;
+    } else {
+	for (i = 0; i < MaxOpenFiles; i++) {
+	    delete process->files[i];
+	    process->files[i] = NULL;
+	}
+	process->exitStatus = status;
+	process->thread = NULL;
+	process->exited->V();
+    }
+
+    delete currentThread->space;
+    currentThread->space = NULL;
+    currentThread->Finish();
+}
+
+//----------------------------------------------------------------------
+// SysJoin
+// 	Wait for process "id" to exit, and return its exit status; -1 if
+//	there is no such process, or the current one didn't Exec it.
+//----------------------------------------------------------------------
+
+static int
+SysJoin(SpaceId id)
+{
+    Process *process;
+    int status;
+
+    if ((id < 0) || (id >= MaxProcesses) || (processes[id] == NULL)
+		|| (processes[id]->parent != CurrentProcess()))
+	return -1;
+    process = processes[id];
+    process->exited->P();
+    status = process->exitStatus;
+    delete process;
+    processes[id] = NULL;
+    return status;
+}
+
+//----------------------------------------------------------------------
+// SysOpen
+// 	Open the file "name" for the current process.  Return its
+//	OpenFileId, or -1 if it can't be opened.
+//----------------------------------------------------------------------
+
+static OpenFileId
+SysOpen(char *name)
+{
+    Process *process = processes[CurrentProcess()];
+    OpenFile *file;
+    int fd;
+
+    for (fd = ConsoleOutput + 1; (fd < MaxOpenFiles) && (process->files[fd] != NULL);
+		fd++)
+	;
+    if ((fd == MaxOpenFiles) || ((file = fileSystem->Open(name)) == NULL))
+	return -1;
+    process->files[fd] = file;
+    return fd;
+}
+
+//----------------------------------------------------------------------
+// OpenFileFor
+// 	Return the current process's open file "fd", or NULL if it
+//	doesn't have one.
+//----------------------------------------------------------------------
+
+static OpenFile *
+OpenFileFor(OpenFileId fd)
+{
+    if ((fd <= ConsoleOutput) || (fd >= MaxOpenFiles))
+	return NULL;
+    return processes[CurrentProcess()]->files[fd];
+}
+
+//----------------------------------------------------------------------
+// SysClose
+// 	Close the current process's open file "fd".  Return -1 if it
+//	doesn't have one.
+//----------------------------------------------------------------------
+
+static int
+SysClose(OpenFileId fd)
+{
+    OpenFile *file = OpenFileFor(fd);
+
+    if (file == NULL)
+	return -1;
+    delete file;
+    processes[CurrentProcess()]->files[fd] = NULL;
+    return 0;
+}
+
+//----------------------------------------------------------------------
+// SysReadWrite
+// 	Read from, or write to, an open file (or the console), moving
+//	the bytes between the user's "buffer" and the file through a
+//	kernel buffer.  There is no console device driver yet, so
+//	console output goes straight to our own standard output, and
+//	there is no console input.
+//
+//	"buffer", "size", "fd" -- as passed to Read or Write
+//	"writing" -- TRUE for Write
+//
+// Returns:
+//	The number of bytes read or written, or -1 on error.
+//----------------------------------------------------------------------
+
+static int
+SysReadWrite(int buffer, int size, OpenFileId fd, bool writing)
+{
+    OpenFile *file = OpenFileFor(fd);
+    char *data;
+    int result = -1;
+
+    if ((size < 0) || ((file == NULL) && (fd != (writing ? ConsoleOutput
+							 : ConsoleInput))))
+	return -1;
+    data = new char[size + 1];
+    if (writing) {
+	if (CopyIn(buffer, data, size)) {
+	    if (file == NULL) {
+		fwrite(data, 1, size, stdout);
+		result = size;
+	    } else
+		result = file->Write(data, size);
+	}
+    } else if (file != NULL) {
+	result = file->Read(data, size);
+	if (!CopyOut(data, buffer, result))
+	    result = -1;
+    }
+    delete [] data;
+    return result;
+}
+
+//----------------------------------------------------------------------
+// AdvancePC
+// 	Step the user program past the system call instruction, so that
+//	it doesn't make the same call again when we return.
+//----------------------------------------------------------------------
+
+static void
+AdvancePC()
+{
+    machine->WriteRegister(PrevPCReg, machine->ReadRegister(PCReg));
+    machine->WriteRegister(PCReg, machine->ReadRegister(NextPCReg));
+    machine->WriteRegister(NextPCReg, machine->ReadRegister(NextPCReg) + 4);
+}
 
 //----------------------------------------------------------------------
 // ExceptionHandler
@@ -52,12 +441,55 @@ void
 ExceptionHandler(ExceptionType which)
 {
     int type = machine->ReadRegister(2);
+    int arg1 = machine->ReadRegister(4);
+    int arg2 = machine->ReadRegister(5);
+    int arg3 = machine->ReadRegister(6);
+    char name[MaxFileName];
+    int result = 0;
 
-    if ((which == SyscallException) && (type == SC_Halt)) {
+    if ((which == PageFaultException) && currentThread->space->PageFault(
+		machine->ReadRegister(BadVAddrReg)))
+	return;				// try the instruction again
+    if (which != SyscallException) {
+	printf("Unexpected user mode exception %d %d\n", which, type);
+	ASSERT(FALSE);
+    }
+    switch (type) {
+      case SC_Halt:
 	DEBUG('a', "Shutdown, initiated by user program.\n");
    	interrupt->Halt();
-    } else {
+	break;
+      case SC_Exit:
+	SysExit(arg1);
+	break;
+      case SC_Exec:
+	result = CopyInString(arg1, name) ? SysExec(name) : -1;
+	break;
+      case SC_Join:
+	result = SysJoin(arg1);
+	break;
+      case SC_Create:
+	result = (CopyInString(arg1, name) && fileSystem->Create(name, 0)) ? 0 : -1;
+	break;
+      case SC_Open:
+	result = CopyInString(arg1, name) ? SysOpen(name) : -1;
+	break;
+      case SC_Read:
+	result = SysReadWrite(arg1, arg2, arg3, FALSE);
+	break;
+      case SC_Write:
+	result = SysReadWrite(arg1, arg2, arg3, TRUE);
+	break;
+      case SC_Close:
+	result = SysClose(arg1);
+	break;
+      case SC_Yield:
+	currentThread->Yield();
+	break;
+      default:
 	printf("Unexpected user mode exception %d %d\n", which, type);
 	ASSERT(FALSE);
     }
+    machine->WriteRegister(2, result);
+    AdvancePC();
 }
@@ -30,10 +30,14 @@ StartProcess(char *filename)
 	printf("Unable to open file %s\n", filename);
 	return;
     }
-    space = new AddrSpace(executable);    
-    currentThread->space = space;
-
+    space = new AddrSpace(executable, filename);
     delete executable;			// close file
+    if (!space->Loaded()) {
+	printf("Unable to load %s\n", filename);
+	delete space;
+	return;
+    }
+    currentThread->space = space;
 
     space->InitRegisters();		// set the initial register values
     space->RestoreState();		// load page table register
@@ -60,7 +60,8 @@ typedef int SpaceId;
 SpaceId Exec(char *name);
  
 /* Only return once the the user program "id" has finished.  
- * Return the exit status.
+ * Return the exit status.  Only the program that Exec'ed "id" may
+ * Join it; once that program has exited, nobody can.
  */
 int Join(SpaceId id); 	
  